@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/PoseStamped.h>
+#include <ros/time.h>
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gpp_interface {
+
+/**
+ * @brief Compact 2D path as structure of arrays.
+ *
+ * Unlike std::vector<geometry_msgs::PoseStamped>, the path stores the frame
+ * and the stamp only once. Processing the path does not allocate a string
+ * per pose, and the coordinates are contiguous in memory.
+ *
+ * The arrays x, y and yaw must have the same size.
+ */
+struct CompactPath {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> yaw;  ///< in radians
+
+  std::string frame_id;
+  ros::Time stamp;
+
+  inline size_t
+  size() const noexcept {
+    return x.size();
+  }
+
+  inline bool
+  empty() const noexcept {
+    return x.empty();
+  }
+
+  /// @brief resizes all arrays
+  inline void
+  resize(size_t _size) {
+    x.resize(_size);
+    y.resize(_size);
+    yaw.resize(_size);
+  }
+
+  /// @brief clears all arrays but keeps their memory
+  inline void
+  clear() noexcept {
+    x.clear();
+    y.clear();
+    yaw.clear();
+  }
+};
+
+/**
+ * @brief converts the _path into the compact representation
+ *
+ * The frame and the stamp are taken from the first pose. The z-coordinate
+ * and the roll and pitch angles are dropped.
+ *
+ * The function reuses the memory of _compact.
+ */
+inline void
+toCompact(const std::vector<geometry_msgs::PoseStamped>& _path,
+          CompactPath& _compact) {
+  _compact.resize(_path.size());
+  if (_path.empty())
+    return;
+
+  _compact.frame_id = _path.front().header.frame_id;
+  _compact.stamp = _path.front().header.stamp;
+  for (size_t ii = 0; ii != _path.size(); ++ii) {
+    const auto& p = _path[ii].pose.position;
+    const auto& q = _path[ii].pose.orientation;
+    _compact.x[ii] = p.x;
+    _compact.y[ii] = p.y;
+    _compact.yaw[ii] = std::atan2(2 * (q.w * q.z + q.x * q.y),
+                                  1 - 2 * (q.y * q.y + q.z * q.z));
+  }
+}
+
+/**
+ * @brief converts the _compact path back into poses
+ *
+ * The function reuses the poses (and their frame_id strings) already stored
+ * in _path, so converting a path of similar size does not allocate.
+ */
+inline void
+fromCompact(const CompactPath& _compact,
+            std::vector<geometry_msgs::PoseStamped>& _path) {
+  _path.resize(_compact.size());
+  for (size_t ii = 0; ii != _path.size(); ++ii) {
+    auto& pose = _path[ii];
+    pose.header.frame_id = _compact.frame_id;
+    pose.header.stamp = _compact.stamp;
+    pose.pose.position.x = _compact.x[ii];
+    pose.pose.position.y = _compact.y[ii];
+    pose.pose.position.z = 0;
+    pose.pose.orientation.x = 0;
+    pose.pose.orientation.y = 0;
+    pose.pose.orientation.z = std::sin(_compact.yaw[ii] / 2);
+    pose.pose.orientation.w = std::cos(_compact.yaw[ii] / 2);
+  }
+}
+
+}  // namespace gpp_interface
@@ -0,0 +1,67 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/PoseStamped.h>
+
+namespace gpp_interface {
+
+/**
+ * @brief Mixin for planners, which can estimate the cost without a path.
+ *
+ * If only the cost of a planning problem is requested (see
+ * GlobalPlannerPipeline::makeCost), the pipeline calls estimateCost instead
+ * of makePlan on planners implementing this interface. Use it for planners
+ * which can compute the cost cheaper than the path (e.x. by skipping the
+ * back-tracking of a Dijkstra).
+ *
+ * @code{cpp}
+ * struct MyPlanner : public mbf_costmap_core::CostmapPlanner,
+ *                    public gpp_interface::CostEstimateInterface {
+ *   bool
+ *   estimateCost(const Pose& _start, const Pose& _goal,
+ *                double& _cost) override;
+ *   ...
+ * };
+ * @endcode
+ */
+struct CostEstimateInterface {
+  using Pose = geometry_msgs::PoseStamped;
+
+  // polymorphism required for this class
+  virtual ~CostEstimateInterface() = default;
+
+  /**
+   * @param _start Start pose for the planning problem
+   * @param _goal Goal pose for the planning problem
+   * @param _cost (estimated) cost of the path from _start to _goal
+   *
+   * @return true, if successful
+   */
+  virtual bool
+  estimateCost(const Pose& _start, const Pose& _goal, double& _cost) = 0;
+};
+
+}  // namespace gpp_interface
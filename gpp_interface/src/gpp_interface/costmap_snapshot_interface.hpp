@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <costmap_2d/costmap_2d.h>
+
+namespace gpp_interface {
+
+/**
+ * @brief Mixin for plugins, which can work on a snapshot of the costmap.
+ *
+ * The pipeline copies the costmap once per planning request into a snapshot
+ * (after the pre-planning group, since those plugins may alter the map).
+ * Plugins of the replanning, planning or post-planning groups implementing
+ * this interface receive the snapshot before they run. Reading the snapshot
+ * requires no locking and does not block the update of the live costmap.
+ *
+ * Derive from this class in addition to the plugin's interface:
+ *
+ * @code{cpp}
+ * struct MyPlanner : public mbf_costmap_core::CostmapPlanner,
+ *                    public gpp_interface::CostmapSnapshotInterface {
+ *   void
+ *   setSnapshot(const costmap_2d::Costmap2D& _snapshot) override {
+ *     snapshot_ = &_snapshot;
+ *   }
+ *   ...
+ * };
+ * @endcode
+ */
+struct CostmapSnapshotInterface {
+  // polymorphism required for this class
+  virtual ~CostmapSnapshotInterface() = default;
+
+  /**
+   * @brief Called by the pipeline for every planning request.
+   *
+   * The _snapshot stays valid and unchanged until the current request is
+   * done. Don't alter it.
+   *
+   * @param _snapshot consistent copy of the costmap
+   */
+  virtual void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) = 0;
+};
+
+}  // namespace gpp_interface
@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include <memory>
+#include <vector>
+
+namespace gpp_interface {
+
+/**
+ * @brief Shortest distance from every cell to a goal.
+ *
+ * The distances are in meters and avoid the lethal cells (8-connected grid).
+ * Unreachable cells have an infinite distance. Since every path is at least
+ * as long as the distance, the field is an admissible heuristic for A*.
+ *
+ * The geometry is the one of the costmap, from which the field was computed.
+ */
+struct DistanceField {
+  unsigned int size_x = 0;
+  unsigned int size_y = 0;
+  double resolution = 0;
+  double origin_x = 0;
+  double origin_y = 0;
+  std::vector<float> distances;  ///< row-major, as the costmap
+
+  inline float
+  getDistance(unsigned int _mx, unsigned int _my) const noexcept {
+    return distances[static_cast<size_t>(_my) * size_x + _mx];
+  }
+};
+
+/**
+ * @brief Source of the DistanceField (implemented by the pipeline).
+ *
+ * The field is computed once per goal and costmap revision, and shared by
+ * all plugins. The provider is thread-safe.
+ */
+struct DistanceFieldProvider {
+  // polymorphism required for this class
+  virtual ~DistanceFieldProvider() = default;
+
+  /**
+   * @brief returns the field for the _goal on the current costmap
+   *
+   * The returned field is immutable: it stays valid and unchanged as long as
+   * the caller holds the pointer - even if the provider computes a new field
+   * for another request meanwhile.
+   */
+  virtual std::shared_ptr<const DistanceField>
+  getDistanceField(const geometry_msgs::PoseStamped& _goal) = 0;
+};
+
+/**
+ * @brief Mixin for plugins, which use the shared DistanceField.
+ *
+ * Plugins of any group may implement this interface, e.x. planners using the
+ * field as heuristic or pre-planning plugins checking if the goal is
+ * reachable. The field is only computed, if a plugin requests it.
+ *
+ * @code{cpp}
+ * struct MyPlanner : public mbf_costmap_core::CostmapPlanner,
+ *                    public gpp_interface::DistanceFieldInterface {
+ *   void
+ *   setDistanceFieldProvider(DistanceFieldProvider& _provider) override {
+ *     provider_ = &_provider;
+ *   }
+ *
+ *   uint32_t
+ *   makePlan(...) override {
+ *     const auto field = provider_->getDistanceField(goal);
+ *     ...
+ *   }
+ * };
+ * @endcode
+ */
+struct DistanceFieldInterface {
+  // polymorphism required for this class
+  virtual ~DistanceFieldInterface() = default;
+
+  /**
+   * @brief Called by the pipeline once the plugin is loaded.
+   *
+   * The _provider outlives the plugin.
+   */
+  virtual void
+  setDistanceFieldProvider(DistanceFieldProvider& _provider) = 0;
+};
+
+}  // namespace gpp_interface
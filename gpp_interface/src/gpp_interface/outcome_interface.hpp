@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace gpp_interface {
+
+/**
+ * @brief Mixin for pre-planning plugins, which can name the reason of their
+ * failure.
+ *
+ * By default the pipeline reports a failed pre-planning as
+ * mbf_msgs::GetPath::Result::FAILURE. If a failing plugin implements this
+ * interface, the pipeline calls getOutcome and reports its code instead. Use
+ * it for plugins rejecting a request early (e.x. since the goal is
+ * unreachable), so the caller can tell these requests apart.
+ *
+ * @code{cpp}
+ * struct MyPrePlanning : public gpp_interface::PrePlanningInterface,
+ *                        public gpp_interface::OutcomeInterface {
+ *   uint32_t
+ *   getOutcome(std::string& _message) override;
+ *   ...
+ * };
+ * @endcode
+ */
+struct OutcomeInterface {
+  // polymorphism required for this class
+  virtual ~OutcomeInterface() = default;
+
+  /**
+   * @brief called after the preProcess call of the plugin failed
+   *
+   * @param _message a description of the failure
+   * @return an outcome code as defined in mbf_msgs::GetPath::Result
+   */
+  virtual uint32_t
+  getOutcome(std::string& _message) = 0;
+};
+
+}  // namespace gpp_interface
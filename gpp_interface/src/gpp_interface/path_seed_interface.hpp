@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include <vector>
+
+namespace gpp_interface {
+
+/**
+ * @brief Mixin for planners, which refine the path of their predecessor.
+ *
+ * Planners of the planning group implementing this interface receive the
+ * output of the preceding planner before they run. The seed may be used e.x.
+ * as corridor or as initial guess for the search.
+ *
+ * Derive from this class in addition to the planner's interface:
+ *
+ * @code{cpp}
+ * struct MyRefiner : public mbf_costmap_core::CostmapPlanner,
+ *                    public gpp_interface::PathSeedInterface {
+ *   void
+ *   setSeed(const Path& _seed, double _cost) override {
+ *     seed_ = &_seed;
+ *   }
+ *   ...
+ * };
+ * @endcode
+ */
+struct PathSeedInterface {
+  // define the interface types
+  using Pose = geometry_msgs::PoseStamped;
+  using Path = std::vector<Pose>;
+
+  // polymorphism required for this class
+  virtual ~PathSeedInterface() = default;
+
+  /**
+   * @brief Called by the pipeline before every makePlan call.
+   *
+   * The _seed stays valid and unchanged until the makePlan call returns.
+   *
+   * @param _seed path of the preceding planner. empty, if the planner is the
+   * first one or if the preceding planner failed
+   * @param _cost cost of the _seed
+   */
+  virtual void
+  setSeed(const Path& _seed, double _cost) = 0;
+};
+
+}  // namespace gpp_interface
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include <vector>
+
+namespace gpp_interface {
+
+/**
+ * @brief Receives the prefix of a path, while the path is still computed.
+ *
+ * The pipeline implements this interface and forwards the prefix (e.x. to
+ * the controller), so the robot can start moving early.
+ */
+struct PathPrefixSink {
+  // define the interface types
+  using Pose = geometry_msgs::PoseStamped;
+  using Path = std::vector<Pose>;
+
+  // polymorphism required for this class
+  virtual ~PathPrefixSink() = default;
+
+  /**
+   * @brief Called with the final first poses of the output path.
+   *
+   * The _prefix starts at the start pose. Every call must extend the prefix
+   * of the previous call (within one request).
+   *
+   * @param _prefix the poses, which the plugin won't alter anymore
+   */
+  virtual void
+  onPrefix(const Path& _prefix) = 0;
+};
+
+/**
+ * @brief Mixin for planners and post-planning plugins, which produce their
+ * path from the start towards the goal.
+ *
+ * Before every call the pipeline passes a sink to the plugin. The plugin may
+ * then report the growing prefix of its output through the sink. The sink is
+ * nullptr, if the pipeline cannot forward the prefix (e.x. since a later
+ * plugin alters the path).
+ *
+ * Derive from this class in addition to the plugin's interface:
+ *
+ * @code{cpp}
+ * struct MySmoother : public gpp_interface::PostPlanningInterface,
+ *                     public gpp_interface::PathStreamInterface {
+ *   void
+ *   setPrefixSink(PathPrefixSink* _sink) override {
+ *     sink_ = _sink;
+ *   }
+ *   ...
+ * };
+ * @endcode
+ */
+struct PathStreamInterface {
+  // polymorphism required for this class
+  virtual ~PathStreamInterface() = default;
+
+  /**
+   * @brief Called by the pipeline before every call of the plugin.
+   *
+   * @param _sink the receiver of the prefix (may be nullptr). The sink stays
+   * valid until the call of the plugin returns
+   */
+  virtual void
+  setPrefixSink(PathPrefixSink* _sink) = 0;
+};
+
+}  // namespace gpp_interface
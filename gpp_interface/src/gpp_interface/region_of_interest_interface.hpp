@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include <cstddef>
+
+namespace gpp_interface {
+
+/**
+ * @brief Mixin for pre-planning plugins, which restrict the planning to a
+ * region of interest.
+ *
+ * If a plugin of the pre-planning group implements this interface, the
+ * pipeline crops the costmap snapshot (see CostmapSnapshotInterface) to the
+ * returned window. The consumers of the snapshot then work on the smaller
+ * map. If the planning group fails, the pipeline asks for the window of the
+ * next attempt and retries. Once the plugin returns false, the pipeline runs
+ * a last attempt on the full map.
+ *
+ * Derive from this class in addition to the PrePlanningInterface:
+ *
+ * @code{cpp}
+ * struct MyCrop : public gpp_interface::PrePlanningInterface,
+ *                 public gpp_interface::RegionOfInterestInterface {
+ *   bool
+ *   getRegionOfInterest(const Pose& _start, const Pose& _goal,
+ *                       double _tolerance, size_t _attempt,
+ *                       Window& _window) override {
+ *     ...
+ *   }
+ *   ...
+ * };
+ * @endcode
+ */
+struct RegionOfInterestInterface {
+  // define the interface types
+  using Pose = geometry_msgs::PoseStamped;
+
+  /// @brief axis-aligned box in the global frame of the costmap (in meters)
+  struct Window {
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+  };
+
+  // polymorphism required for this class
+  virtual ~RegionOfInterestInterface() = default;
+
+  /**
+   * @brief Called by the pipeline after the pre-planning group.
+   *
+   * In the pipelined async mode the call may overlap with the preProcess of
+   * the next request: the plugin must not keep any state of the request
+   * between the two calls.
+   *
+   * @param _start start pose (after the pre-planning)
+   * @param _goal goal pose (after the pre-planning)
+   * @param _tolerance goal tolerance of the request
+   * @param _attempt zero for the first one and incremented after every
+   * failure of the planning group
+   * @param _window the region of interest. may exceed the costmap
+   *
+   * @return false, if the _attempt should use the full map
+   */
+  virtual bool
+  getRegionOfInterest(const Pose& _start, const Pose& _goal, double _tolerance,
+                      size_t _attempt, Window& _window) = 0;
+};
+
+}  // namespace gpp_interface
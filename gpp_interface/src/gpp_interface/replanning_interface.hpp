@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/PoseStamped.h>
+
+#include <string>
+#include <vector>
+
+namespace gpp_interface {
+
+/**
+ * @brief A Replanning class decides if the previous path can be reused.
+ *
+ * The replanning plugins run after the pre-planning and before the planning
+ * plugins - but only if the goal did not change since the last successful
+ * plan. The plugins receive the last successful path. If the group succeeds,
+ * the planning and post-planning groups are skipped and the (possibly
+ * altered) path is returned.
+ *
+ * Use this class to avoid expensive re-planning. You can implement
+ * - collision checks of the previous path
+ * - pruning of the already traveled part of the path
+ * - etc.
+ */
+struct ReplanningInterface {
+  // define the interface types
+  using Pose = geometry_msgs::PoseStamped;
+  using Path = std::vector<Pose>;
+  using Map = costmap_2d::Costmap2DROS;
+
+  // polymorphism required for this class
+  virtual ~ReplanningInterface() = default;
+
+  /**
+   * @param _start Start pose of the current planning problem
+   * @param _goal Goal pose of the current planning problem
+   * @param _path The last successful path - may be altered
+   * @param _cost The cost of the last successful path - may be altered
+   *
+   * @return true, if the path can be reused
+   */
+  virtual bool
+  reuse(const Pose& _start, const Pose& _goal, Path& _path, double& _cost) = 0;
+
+  /**
+   * @param _name name of the resource
+   * @param _map costmap containing the data
+   */
+  virtual void
+  initialize(const std::string& _name, Map* _map) = 0;
+};
+
+}  // namespace gpp_interface
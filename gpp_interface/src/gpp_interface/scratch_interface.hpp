@@ -0,0 +1,241 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace gpp_interface {
+
+/**
+ * @brief Monotonic scratch memory, which is reset between the requests.
+ *
+ * The arena hands out memory from large blocks and never frees single
+ * allocations. Once the request is done, the pipeline resets the arena: the
+ * memory is reused by the next request. If a request needed more than one
+ * block, the blocks are merged into one at the reset - so in the steady state
+ * the arena does not allocate at all.
+ *
+ * The arena is thread-safe.
+ */
+class ScratchArena {
+public:
+  /// @param _block size of the first block in bytes
+  explicit ScratchArena(size_t _block = 64 * 1024) : block_(_block) {}
+
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena&
+  operator=(const ScratchArena&) = delete;
+
+  /**
+   * @brief returns _bytes of uninitialized memory
+   *
+   * The memory stays valid until the next reset.
+   *
+   * @param _alignment must be a power of two
+   * @throw std::bad_alloc if the arena cannot grow
+   */
+  void*
+  allocate(size_t _bytes, size_t _alignment = alignof(std::max_align_t)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    used_ += _bytes;
+    if (!blocks_.empty()) {
+      auto ptr = align(blocks_.back(), _bytes, _alignment);
+      if (ptr)
+        return ptr;
+    }
+
+    // the blocks grow geometrically, so we need few of them
+    const auto last = blocks_.empty() ? block_ : blocks_.back().size * 2;
+    blocks_.emplace_back(std::max(last, _bytes + _alignment));
+    return align(blocks_.back(), _bytes, _alignment);
+  }
+
+  /// @brief as above, but for _n objects of type _T
+  template <typename _T>
+  _T*
+  allocate(size_t _n) {
+    return static_cast<_T*>(allocate(_n * sizeof(_T), alignof(_T)));
+  }
+
+  /**
+   * @brief releases all allocations
+   *
+   * The memory is kept up to _keep bytes. Don't call it while someone uses
+   * the memory.
+   */
+  void
+  reset(size_t _keep) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t size = 0;
+    for (const auto& block : blocks_)
+      size += block.size;
+
+    // one block, which would have served the entire request
+    if (blocks_.size() > 1 || size > _keep) {
+      blocks_.clear();
+      if (size && size <= _keep)
+        blocks_.emplace_back(size);
+    }
+    if (!blocks_.empty())
+      blocks_.back().offset = 0;
+    used_ = 0;
+  }
+
+  /// @brief bytes allocated since the last reset
+  size_t
+  used() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+  /// @brief bytes held by the arena
+  size_t
+  capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t size = 0;
+    for (const auto& block : blocks_)
+      size += block.size;
+    return size;
+  }
+
+private:
+  struct Block {
+    explicit Block(size_t _size) : data(new char[_size]), size(_size) {}
+
+    std::unique_ptr<char[]> data;
+    size_t size;
+    size_t offset = 0;
+  };
+
+  /// @brief returns the aligned memory from the _block (or nullptr)
+  static void*
+  align(Block& _block, size_t _bytes, size_t _alignment) noexcept {
+    const auto base = reinterpret_cast<uintptr_t>(_block.data.get());
+    const auto begin = (base + _block.offset + _alignment - 1) &
+                       ~static_cast<uintptr_t>(_alignment - 1);
+    if (begin + _bytes > base + _block.size)
+      return nullptr;
+    _block.offset = begin + _bytes - base;
+    return reinterpret_cast<void*>(begin);
+  }
+
+  size_t block_;
+  size_t used_ = 0;
+  std::vector<Block> blocks_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief Allocator for the standard containers, drawing from a ScratchArena.
+ *
+ * The deallocation is a no-op: a growing container leaves its old buffers in
+ * the arena. Reserve the capacity upfront, if you can.
+ *
+ * @code{cpp}
+ * ScratchAllocator<double> alloc(_arena);
+ * std::vector<double, ScratchAllocator<double>> costs(alloc);
+ * costs.reserve(_path.size());
+ * @endcode
+ */
+template <typename _T>
+struct ScratchAllocator {
+  using value_type = _T;
+
+  explicit ScratchAllocator(ScratchArena& _arena) noexcept : arena(&_arena) {}
+
+  template <typename _U>
+  ScratchAllocator(const ScratchAllocator<_U>& _other) noexcept :
+      arena(_other.arena) {}
+
+  _T*
+  allocate(size_t _n) {
+    return arena->allocate<_T>(_n);
+  }
+
+  void
+  deallocate(_T*, size_t) noexcept {}
+
+  ScratchArena* arena;
+};
+
+template <typename _T, typename _U>
+bool
+operator==(const ScratchAllocator<_T>& _a,
+           const ScratchAllocator<_U>& _b) noexcept {
+  return _a.arena == _b.arena;
+}
+
+template <typename _T, typename _U>
+bool
+operator!=(const ScratchAllocator<_T>& _a,
+           const ScratchAllocator<_U>& _b) noexcept {
+  return !(_a == _b);
+}
+
+/**
+ * @brief Mixin for plugins, which need temporary memory per request.
+ *
+ * Plugins of any group may implement this interface. The pipeline resets the
+ * arena before the plugin's group runs for the next request: memory drawn
+ * within a call may be used until the call returns, but not across requests.
+ * Every stage of the pipeline has its own arena, so the pipelined mode does
+ * not reset the memory of a running stage.
+ *
+ * @code{cpp}
+ * struct MySmoother : public gpp_interface::PostPlanningInterface,
+ *                     public gpp_interface::ScratchInterface {
+ *   void
+ *   setScratchArena(ScratchArena& _arena) override {
+ *     arena_ = &_arena;
+ *   }
+ *
+ *   bool
+ *   postProcess(Path& _path, double& _cost) override {
+ *     auto weights = arena_->allocate<double>(_path.size());
+ *     ...
+ *   }
+ * };
+ * @endcode
+ */
+struct ScratchInterface {
+  // polymorphism required for this class
+  virtual ~ScratchInterface() = default;
+
+  /**
+   * @brief Called by the pipeline once the plugin is loaded.
+   *
+   * The _arena outlives the plugin.
+   */
+  virtual void
+  setScratchArena(ScratchArena& _arena) = 0;
+};
+
+}  // namespace gpp_interface
@@ -0,0 +1,296 @@
+// replays recorded planning queries against the GlobalPlannerPipeline. run it
+// with roslaunch gpp_plugin pipeline.launch config:=<yaml> map:=<pgm>
+
+#include "../test/allocation_counter.hpp"
+
+#include <gpp_plugin/gpp_plugin.hpp>
+
+#include <benchmark/benchmark.h>
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <ros/ros.h>
+#include <tf2_ros/buffer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using gpp_plugin::GlobalPlannerPipeline;
+using Pose = geometry_msgs::PoseStamped;
+using Path = std::vector<Pose>;
+
+struct Query {
+  Pose start;
+  Pose goal;
+};
+
+/// @brief gray-scale image (row-major, the first row is the top)
+struct Image {
+  unsigned int width = 0;
+  unsigned int height = 0;
+  std::vector<unsigned char> data;
+};
+
+/// @brief reads the next token of a pgm header (skips the comments)
+std::string
+_readToken(std::istream& _is) {
+  std::string token;
+  while (_is >> token) {
+    if (token.front() != '#')
+      return token;
+    std::getline(_is, token);
+  }
+  throw std::runtime_error("unexpected end of the pgm header");
+}
+
+/// @brief reads a binary (P5) or ascii (P2) pgm image with 8 bit
+Image
+_readPgm(const std::string& _file) {
+  std::ifstream is(_file, std::ios::binary);
+  if (!is)
+    throw std::runtime_error("cannot open " + _file);
+
+  const auto magic = _readToken(is);
+  if (magic != "P5" && magic != "P2")
+    throw std::runtime_error(_file + " is not a pgm image");
+
+  Image image;
+  image.width = std::stoul(_readToken(is));
+  image.height = std::stoul(_readToken(is));
+  if (std::stoul(_readToken(is)) > 255)
+    throw std::runtime_error(_file + " has more than 8 bit");
+
+  image.data.resize(static_cast<size_t>(image.width) * image.height);
+  if (magic == "P5") {
+    // a single whitespace separates the header from the data
+    is.get();
+    is.read(reinterpret_cast<char*>(image.data.data()), image.data.size());
+  }
+  else {
+    for (auto& pixel : image.data) {
+      unsigned int value;
+      is >> value;
+      pixel = static_cast<unsigned char>(value);
+    }
+  }
+
+  if (!is)
+    throw std::runtime_error(_file + " is truncated");
+  return image;
+}
+
+/// @brief converts the _image into costs, following the map_server semantics
+void
+_fillCostmap(const Image& _image, bool _negate, double _occupied_thresh,
+             double _free_thresh, costmap_2d::Costmap2D& _map) {
+  for (unsigned int row = 0; row != _image.height; ++row) {
+    for (unsigned int col = 0; col != _image.width; ++col) {
+      const double value = _image.data[row * _image.width + col] / 255.;
+      const double occupancy = _negate ? value : 1. - value;
+      unsigned char cost = costmap_2d::NO_INFORMATION;
+      if (occupancy > _occupied_thresh)
+        cost = costmap_2d::LETHAL_OBSTACLE;
+      else if (occupancy < _free_thresh)
+        cost = costmap_2d::FREE_SPACE;
+      // the image starts at the top, the map at the bottom
+      _map.setCost(col, _image.height - 1 - row, cost);
+    }
+  }
+}
+
+/// @brief XmlRpc does not convert between int and double
+double
+_toDouble(XmlRpc::XmlRpcValue& _value) {
+  if (_value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+    return static_cast<int>(_value);
+  return static_cast<double>(_value);
+}
+
+Pose
+_makePose(double _x, double _y, double _yaw, const std::string& _frame) {
+  Pose pose;
+  pose.header.frame_id = _frame;
+  pose.pose.position.x = _x;
+  pose.pose.position.y = _y;
+  pose.pose.orientation.z = std::sin(_yaw / 2);
+  pose.pose.orientation.w = std::cos(_yaw / 2);
+  return pose;
+}
+
+/// @brief reads the queries as list of [start_x, start_y, start_yaw, goal_x,
+/// goal_y, goal_yaw]
+std::vector<Query>
+_readQueries(ros::NodeHandle& _nh, const std::string& _frame) {
+  XmlRpc::XmlRpcValue raw;
+  if (!_nh.getParam("queries", raw) ||
+      raw.getType() != XmlRpc::XmlRpcValue::TypeArray)
+    throw std::runtime_error("no queries defined");
+
+  std::vector<Query> queries;
+  for (int ii = 0; ii != raw.size(); ++ii) {
+    auto& q = raw[ii];
+    if (q.getType() != XmlRpc::XmlRpcValue::TypeArray || q.size() != 6)
+      throw std::runtime_error("a query must have six elements");
+
+    Query query;
+    query.start = _makePose(_toDouble(q[0]), _toDouble(q[1]), _toDouble(q[2]),
+                            _frame);
+    query.goal = _makePose(_toDouble(q[3]), _toDouble(q[4]), _toDouble(q[5]),
+                           _frame);
+    queries.emplace_back(std::move(query));
+  }
+  return queries;
+}
+
+size_t
+_countAllocations() {
+  return gpp_plugin::test::allocations();
+}
+
+void
+BM_Replay(benchmark::State& _state, GlobalPlannerPipeline& _pipeline,
+          const std::vector<Query>& _queries) {
+  Path plan;
+  double cost;
+  std::string message;
+  size_t successes = 0;
+  size_t ii = 0;
+  gpp_plugin::LatencyHistogram latency;
+
+  const size_t before = gpp_plugin::test::allocations();
+  for (auto _ : _state) {
+    // round-robin over the recorded queries
+    const auto& query = _queries[ii++ % _queries.size()];
+    const auto begin = std::chrono::steady_clock::now();
+    const auto outcome = _pipeline.makePlan(query.start, query.goal, 0., plan,
+                                            cost, message);
+    latency.record(std::chrono::steady_clock::now() - begin);
+    successes += outcome == 0;
+  }
+  const size_t allocs = gpp_plugin::test::allocations() - before;
+
+  using benchmark::Counter;
+  _state.SetItemsProcessed(_state.iterations());
+  _state.counters["allocations"] =
+      Counter(allocs, Counter::kAvgIterations);
+  _state.counters["success_rate"] =
+      Counter(successes, Counter::kAvgIterations);
+  _state.counters["p50_ms"] = latency.percentile(0.5) * 1e3;
+  _state.counters["p95_ms"] = latency.percentile(0.95) * 1e3;
+  _state.counters["p99_ms"] = latency.percentile(0.99) * 1e3;
+}
+
+/// @brief prints the statistics of every plugin and a summary per group
+void
+_printStats(const GlobalPlannerPipeline::StatsMap& _stats) {
+  const char* format = "%-40s %8s %8s %10s %10s %10s %10s %12s\n";
+  std::printf(format, "plugin", "calls", "failures", "mean [ms]", "p50 [ms]",
+              "p95 [ms]", "p99 [ms]", "allocs/call");
+
+  std::map<std::string, gpp_plugin::PluginStats> groups;
+  for (const auto& entry : _stats) {
+    const auto& stats = entry.second;
+    const auto calls = std::max<size_t>(stats.calls, 1);
+    std::printf("%-40s %8zu %8zu %10.3f %10.3f %10.3f %10.3f %12.1f\n",
+                entry.first.c_str(), stats.calls, stats.failures,
+                stats.mean() * 1e3, stats.latency.percentile(0.5) * 1e3,
+                stats.latency.percentile(0.95) * 1e3,
+                stats.latency.percentile(0.99) * 1e3,
+                static_cast<double>(stats.allocations) / calls);
+
+    // the keys are "<group>/<plugin>"
+    auto& group = groups[entry.first.substr(0, entry.first.find('/'))];
+    group.calls += stats.calls;
+    group.failures += stats.failures;
+    group.total += stats.total;
+    group.allocations += stats.allocations;
+  }
+
+  std::printf("\n%-40s %8s %8s %10s %12s\n", "group", "calls", "failures",
+              "total [s]", "allocs/call");
+  for (const auto& entry : groups) {
+    const auto& group = entry.second;
+    const auto calls = std::max<size_t>(group.calls, 1);
+    std::printf("%-40s %8zu %8zu %10.3f %12.1f\n", entry.first.c_str(),
+                group.calls, group.failures, group.total,
+                static_cast<double>(group.allocations) / calls);
+  }
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv) {
+  ros::init(argc, argv, "gpp_plugin_benchmark");
+  benchmark::Initialize(&argc, argv);
+  ros::NodeHandle nh("~");
+
+  try {
+    // load the map (same parameters as the map_server)
+    const auto image = _readPgm(nh.param("map/image", std::string()));
+    const auto resolution = nh.param("map/resolution", 0.05);
+    std::vector<double> origin = nh.param("map/origin", std::vector<double>{});
+    origin.resize(2, 0.);
+
+    // the costmap without any layers: we fill it ourselves
+    const std::string frame = "map";
+    nh.setParam("costmap/global_frame", frame);
+    nh.setParam("costmap/robot_base_frame", "base_link");
+    XmlRpc::XmlRpcValue no_plugins;
+    no_plugins.setSize(0);
+    nh.setParam("costmap/plugins", no_plugins);
+    nh.setParam("costmap/rolling_window", false);
+    nh.setParam("costmap/width", static_cast<int>(image.width * resolution));
+    nh.setParam("costmap/height", static_cast<int>(image.height * resolution));
+    nh.setParam("costmap/resolution", resolution);
+    nh.setParam("costmap/origin_x", origin[0]);
+    nh.setParam("costmap/origin_y", origin[1]);
+
+    // fake localization: the costmap waits for the robot's pose
+    tf2_ros::Buffer tf;
+    geometry_msgs::TransformStamped identity;
+    identity.header.frame_id = frame;
+    identity.child_frame_id = "base_link";
+    identity.transform.rotation.w = 1;
+    tf.setTransform(identity, "gpp_plugin_benchmark", true);
+
+    costmap_2d::Costmap2DROS costmap("costmap", tf);
+    costmap.pause();
+    auto map = costmap.getCostmap();
+    map->resizeMap(image.width, image.height, resolution, origin[0],
+                   origin[1]);
+    _fillCostmap(image, nh.param("map/negate", 0) != 0,
+                 nh.param("map/occupied_thresh", 0.65),
+                 nh.param("map/free_thresh", 0.196), *map);
+
+    const auto queries = _readQueries(nh, frame);
+
+    GlobalPlannerPipeline pipeline;
+    pipeline.initialize("pipeline", &costmap);
+
+    // count the allocations of every plugin
+    gpp_plugin::setAllocationCounter(&_countAllocations);
+    benchmark::RegisterBenchmark("replay", BM_Replay, std::ref(pipeline),
+                                 std::cref(queries))
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RunSpecifiedBenchmarks();
+    gpp_plugin::setAllocationCounter(nullptr);
+
+    std::printf("\n");
+    _printStats(pipeline.getStats());
+  }
+  catch (std::exception& _ex) {
+    ROS_ERROR_STREAM("[gpp_plugin_benchmark]: " << _ex.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+// microbenchmark for the execution of the plugin groups. requires a running
+// master and the plugins of test/test_plugins.xml. run it with
+// rosrun gpp_plugin run_plugins_benchmark
+
+#include "../test/allocation_counter.hpp"
+#include "../test/test_pipeline.hpp"
+
+#include <gpp_plugin/gpp_plugin.hpp>
+
+#include <benchmark/benchmark.h>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+static void
+BM_NoOpMakePlan(benchmark::State& _state) {
+  // every group gets the same number of no-op plugins
+  const auto size = static_cast<size_t>(_state.range(0));
+  const auto name = "noop_" + std::to_string(size);
+  setPlugins(name, "pre_planning",
+             makePlugins("pre_", "gpp_plugin::test::NoOpPrePlanning", size));
+  setPlugins(name, "planning",
+             makePlugins("planning_", "gpp_plugin::test::NoOpPlanning", size));
+  setPlugins(name, "post_planning",
+             makePlugins("post_", "gpp_plugin::test::NoOpPostPlanning", size));
+
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize(name, map.costmap.get());
+  const auto start = makePose(1, 1);
+  const auto goal = makePose(8, 8);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  double cost;
+  std::string message;
+
+  // warm-up: the statistics are allocated with the first call
+  pipeline.makePlan(start, goal, 0.1, plan, cost, message);
+
+  const size_t before = allocations();
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(
+        pipeline.makePlan(start, goal, 0.1, plan, cost, message));
+  const size_t allocs = allocations() - before;
+
+  _state.counters["allocations"] = benchmark::Counter(
+      allocs, benchmark::Counter::kAvgIterations);
+  if (allocs)
+    _state.SkipWithError("makePlan allocates memory");
+}
+
+BENCHMARK(BM_NoOpMakePlan)->Arg(1)->Arg(4)->Arg(8);
+
+int
+main(int argc, char** argv) {
+  ros::init(argc, argv, "run_plugins_benchmark");
+  ros::NodeHandle nh;
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/costmap_snapshot.hpp>
+#include <gpp_plugin/trace.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gpp_plugin {
+
+void
+CostmapSnapshot::update(costmap_2d::Costmap2D& _map) {
+  using mutex_t = costmap_2d::Costmap2D::mutex_t;
+  TraceSpan wait("lock", "costmap");
+  boost::unique_lock<mutex_t> lock(*_map.getMutex());
+  wait.finish();
+  copy(_map, 0, 0, _map.getSizeInCellsX(), _map.getSizeInCellsY());
+}
+
+/// @brief returns the cell of the coordinate _v clipped to [0, _size)
+inline unsigned int
+_toCell(double _v, double _origin, double _resolution, unsigned int _size) {
+  const auto cell = std::floor((_v - _origin) / _resolution);
+  return static_cast<unsigned int>(std::min(std::max(cell, 0.), _size - 1.));
+}
+
+bool
+CostmapSnapshot::update(costmap_2d::Costmap2D& _map, double _min_x,
+                        double _min_y, double _max_x, double _max_y) {
+  using mutex_t = costmap_2d::Costmap2D::mutex_t;
+  TraceSpan wait("lock", "costmap");
+  boost::unique_lock<mutex_t> lock(*_map.getMutex());
+  wait.finish();
+
+  const auto size_x = _map.getSizeInCellsX();
+  const auto size_y = _map.getSizeInCellsY();
+  if (!size_x || !size_y) {
+    copy(_map, 0, 0, size_x, size_y);
+    return false;
+  }
+
+  // the max cells are inclusive
+  const auto res = _map.getResolution();
+  const auto x0 = _toCell(_min_x, _map.getOriginX(), res, size_x);
+  const auto y0 = _toCell(_min_y, _map.getOriginY(), res, size_y);
+  const auto x1 = std::max(x0, _toCell(_max_x, _map.getOriginX(), res, size_x));
+  const auto y1 = std::max(y0, _toCell(_max_y, _map.getOriginY(), res, size_y));
+  copy(_map, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+  return size_x_ != size_x || size_y_ != size_y;
+}
+
+void
+CostmapSnapshot::copy(costmap_2d::Costmap2D& _map, unsigned int _x,
+                      unsigned int _y, unsigned int _size_x,
+                      unsigned int _size_y) {
+  default_value_ = _map.getDefaultValue();
+  const auto res = _map.getResolution();
+  const auto origin_x = _map.getOriginX() + _x * res;
+  const auto origin_y = _map.getOriginY() + _y * res;
+
+  // reallocate only if the size changes
+  if (_size_x != size_x_ || _size_y != size_y_ || !costmap_)
+    resizeMap(_size_x, _size_y, res, origin_x, origin_y);
+  else {
+    resolution_ = res;
+    origin_x_ = origin_x;
+    origin_y_ = origin_y;
+  }
+
+  const auto source = _map.getCharMap();
+  if (!costmap_ || !source)
+    return;
+
+  // copy the full map at once and the windows row by row
+  const auto stride = _map.getSizeInCellsX();
+  if (_size_x == stride) {
+    std::memcpy(costmap_, source + static_cast<size_t>(_y) * stride,
+                static_cast<size_t>(_size_x) * _size_y);
+    return;
+  }
+  for (unsigned int row = 0; row != _size_y; ++row)
+    std::memcpy(costmap_ + static_cast<size_t>(row) * _size_x,
+                source + static_cast<size_t>(_y + row) * stride + _x,
+                _size_x);
+}
+
+void
+CostmapSnapshot::downsample(const costmap_2d::Costmap2D& _source,
+                            unsigned int _factor) {
+  _factor = std::max(_factor, 1u);
+  const auto src_x = _source.getSizeInCellsX();
+  const auto src_y = _source.getSizeInCellsY();
+  // round up, so the coarse map covers the entire _source
+  const auto size_x = (src_x + _factor - 1) / _factor;
+  const auto size_y = (src_y + _factor - 1) / _factor;
+  const auto res = _source.getResolution() * _factor;
+
+  if (size_x != size_x_ || size_y != size_y_ || !costmap_)
+    resizeMap(size_x, size_y, res, _source.getOriginX(), _source.getOriginY());
+  else {
+    resolution_ = res;
+    origin_x_ = _source.getOriginX();
+    origin_y_ = _source.getOriginY();
+  }
+
+  const auto source = _source.getCharMap();
+  if (!costmap_ || !source)
+    return;
+
+  // row-wise max-pooling: we read the _source in its memory order
+  std::fill_n(costmap_, static_cast<size_t>(size_x) * size_y, 0);
+  for (unsigned int yy = 0; yy != src_y; ++yy) {
+    const auto src_row = source + static_cast<size_t>(yy) * src_x;
+    const auto dst_row = costmap_ + static_cast<size_t>(yy / _factor) * size_x;
+    for (unsigned int xx = 0; xx != src_x; ++xx) {
+      auto& cell = dst_row[xx / _factor];
+      cell = std::max(cell, src_row[xx]);
+    }
+  }
+}
+
+}  // namespace gpp_plugin
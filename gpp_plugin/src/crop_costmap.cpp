@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/crop_costmap.hpp>
+#include <gpp_plugin/logging.hpp>
+
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gpp_plugin {
+
+CropCostmap::Window
+CropCostmap::makeWindow(const Pose& _start, const Pose& _goal,
+                        double _margin) noexcept {
+  const auto& s = _start.pose.position;
+  const auto& g = _goal.pose.position;
+  Window window;
+  window.min_x = std::min(s.x, g.x) - _margin;
+  window.min_y = std::min(s.y, g.y) - _margin;
+  window.max_x = std::max(s.x, g.x) + _margin;
+  window.max_y = std::max(s.y, g.y) + _margin;
+  return window;
+}
+
+bool
+CropCostmap::preProcess(Pose&, Pose&, Map&, double) {
+  return true;
+}
+
+bool
+CropCostmap::getRegionOfInterest(const Pose& _start, const Pose& _goal,
+                                 double _tolerance, size_t _attempt,
+                                 Window& _window) {
+  // use the full map
+  if (_attempt >= max_attempts_)
+    return false;
+
+  const auto margin =
+      margin_ * std::pow(growth_, _attempt) + std::max(_tolerance, 0.);
+  _window = makeWindow(_start, _goal, margin);
+  GPP_HOT_DEBUG("[crop_costmap]: attempt " << _attempt << " with margin "
+                                           << margin);
+  return true;
+}
+
+void
+CropCostmap::initialize(const std::string& _name) {
+  ros::NodeHandle nh("~" + _name);
+  margin_ = std::max(nh.param("margin", 2.), 0.);
+  growth_ = std::max(nh.param("growth", 2.), 1.);
+  max_attempts_ = static_cast<size_t>(std::max(nh.param("max_attempts", 3), 0));
+}
+
+}  // namespace gpp_plugin
+
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::CropCostmap,
+                       gpp_interface::PrePlanningInterface);
@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/distance_field.hpp>
+#include <gpp_plugin/plan_cache.hpp>
+#include <gpp_plugin/trace.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace gpp_plugin {
+
+DistanceFieldCache::DistanceFieldCache(unsigned char _lethal) :
+    lethal_(_lethal) {}
+
+DistanceFieldCache::View::View(DistanceFieldCache& _cache) noexcept :
+    cache_(_cache) {}
+
+void
+DistanceFieldCache::View::setMap(costmap_2d::Costmap2D& _map) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  map_ = &_map;
+  map_mutex_ = _map.getMutex();
+  // the content may have changed: compute the revision on demand
+  has_revision_ = false;
+}
+
+void
+DistanceFieldCache::View::setSnapshot(const costmap_2d::Costmap2D& _snapshot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  map_ = &_snapshot;
+  map_mutex_ = nullptr;
+  has_revision_ = false;
+}
+
+std::shared_ptr<const DistanceFieldCache::DistanceField>
+DistanceFieldCache::View::getDistanceField(
+    const geometry_msgs::PoseStamped& _goal) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // without a map the field stays empty
+  if (!map_)
+    return cache_.find(nullptr, 0, 0);
+
+  using mutex_t = costmap_2d::Costmap2D::mutex_t;
+  boost::unique_lock<mutex_t> map_lock;
+  if (map_mutex_) {
+    TraceSpan wait("lock", "costmap");
+    map_lock = boost::unique_lock<mutex_t>(*map_mutex_);
+  }
+
+  if (!has_revision_) {
+    revision_ = costmapRevision(*map_);
+    has_revision_ = true;
+  }
+
+  // a goal outside of the map has no cell: every cell is unreachable
+  unsigned int mx, my;
+  const auto& p = _goal.pose.position;
+  const auto inside = map_->worldToMap(p.x, p.y, mx, my);
+  const auto goal = inside ? map_->getIndex(mx, my)
+                           : std::numeric_limits<unsigned int>::max();
+  return cache_.find(map_, revision_, goal);
+}
+
+std::shared_ptr<const DistanceFieldCache::DistanceField>
+DistanceFieldCache::find(const costmap_2d::Costmap2D* _map,
+                         const uint64_t _revision, const unsigned int _goal) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the callers may still read the last field: we can only reuse its buffer,
+  // if no one else holds it
+  auto writable = [this]() -> DistanceField& {
+    if (!field_ || field_.use_count() != 1)
+      field_ = std::make_shared<DistanceField>();
+    return *field_;
+  };
+
+  if (!_map) {
+    writable() = DistanceField{};
+    valid_ = false;
+    return field_;
+  }
+
+  if (valid_ && field_revision_ == _revision && field_goal_ == _goal) {
+    ++stats_.hits;
+    return field_;
+  }
+
+  ++stats_.misses;
+  compute(*_map, _goal, lethal_, writable(), heap_);
+  valid_ = true;
+  field_revision_ = _revision;
+  field_goal_ = _goal;
+  return field_;
+}
+
+DistanceFieldCache::Stats
+DistanceFieldCache::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void
+DistanceFieldCache::compute(const costmap_2d::Costmap2D& _map,
+                            unsigned int _goal, unsigned char _lethal,
+                            DistanceField& _field, Heap& _heap) {
+  constexpr auto inf = std::numeric_limits<float>::infinity();
+  const auto size_x = _map.getSizeInCellsX();
+  const auto size_y = _map.getSizeInCellsY();
+  const auto size = static_cast<size_t>(size_x) * size_y;
+
+  _field.size_x = size_x;
+  _field.size_y = size_y;
+  _field.resolution = _map.getResolution();
+  _field.origin_x = _map.getOriginX();
+  _field.origin_y = _map.getOriginY();
+  _field.distances.assign(size, inf);
+
+  const auto costs = _map.getCharMap();
+  if (_goal >= size || !costs)
+    return;
+
+  // 8-connected grid: the straight and the diagonal steps
+  const float straight = static_cast<float>(_field.resolution);
+  const float diagonal = straight * static_cast<float>(std::sqrt(2.));
+
+  // the heap reuses the memory of the last run
+  auto& distances = _field.distances;
+  const auto greater = std::greater<std::pair<float, unsigned int>>{};
+  _heap.clear();
+  distances[_goal] = 0;
+  _heap.emplace_back(0.f, _goal);
+
+  while (!_heap.empty()) {
+    std::pop_heap(_heap.begin(), _heap.end(), greater);
+    const auto top = _heap.back();
+    _heap.pop_back();
+
+    // skip the outdated entries
+    if (top.first > distances[top.second])
+      continue;
+
+    const auto x = top.second % size_x;
+    const auto y = top.second / size_x;
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        if ((!dx && !dy) || (!x && dx < 0) || (!y && dy < 0) ||
+            (x + dx >= size_x) || (y + dy >= size_y))
+          continue;
+
+        const auto index = static_cast<unsigned int>(
+            static_cast<int>(top.second) + dy * static_cast<int>(size_x) + dx);
+        if (costs[index] >= _lethal)
+          continue;
+
+        const auto dist = top.first + (dx && dy ? diagonal : straight);
+        if (dist < distances[index]) {
+          distances[index] = dist;
+          _heap.emplace_back(dist, index);
+          std::push_heap(_heap.begin(), _heap.end(), greater);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace gpp_plugin
@@ -23,11 +23,15 @@
  */
 
 #include <gpp_plugin/gpp_plugin.hpp>
+#include <gpp_plugin/reuse_path.hpp>
 
 #include <pluginlib/class_list_macros.h>
 #include <xmlrpcpp/XmlRpcException.h>
 #include <xmlrpcpp/XmlRpcValue.h>
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <stdexcept>
 #include <utility>
 
@@ -46,46 +50,28 @@ constexpr char gpp_name__[] = "[gpp]: ";
 // outcome definition for mbf_costmap_core based plugins
 constexpr uint32_t MBF_SUCCESS = 0;
 constexpr uint32_t MBF_FAILURE = 50;
+constexpr uint32_t MBF_CANCELED = 51;
 
-/// @brief helper to get a string element with the tag _tag from _v
-/// @throw XmlRpc::XmlRpcException if the tag is missing
-inline std::string
-_getStringElement(const XmlRpc::XmlRpcValue& _v, const std::string& _tag) {
-  // we have to check manually, since XmlRpc would just return _tag if its
-  // missing...
-  if (!_v.hasMember(_tag))
-    throw XmlRpc::XmlRpcException(_tag + " not found");
-
-  return static_cast<std::string>(_v[_tag]);
-}
-
-/// @brief helper to get any value from _v under _tag.
-/// If anything goes wrong, the function will fall-back to the _default value.
-template <typename _T>
-_T
-_getElement(const XmlRpc::XmlRpcValue& _v, const std::string& _tag,
-            const _T& _default) noexcept {
-  // check if the tag is defined (see above for explanation)
-  if (!_v.hasMember(_tag))
-    return _default;
-
-  // try to get the desired value
-  try {
-    return static_cast<_T>(_v[_tag]);
-  }
-  catch (XmlRpc::XmlRpcException& _ex) {
-    return _default;
-  }
+/// @brief warns about the _message - or throws it, if _strict is set
+inline void
+_fail(const std::string& _message, bool _strict) {
+  if (_strict)
+    throw std::runtime_error(_message);
+  GPP_WARN(_message);
 }
 
 template <typename _Plugin>
 void
 ArrayPluginManager<_Plugin>::load(const std::string& _resource,
-                                  ros::NodeHandle& _nh) {
-  // load the group parameters
-  PluginGroup<_Plugin>::name_ = _resource;
-  PluginGroup<_Plugin>::default_value_ =
-      _nh.param(_resource + "_default_value", true);
+                                  ros::NodeHandle& _nh, bool _default_value) {
+  commit(_resource, _nh, prepare(_resource, _nh), _default_value);
+}
+
+template <typename _Plugin>
+typename ArrayPluginManager<_Plugin>::PluginMap
+ArrayPluginManager<_Plugin>::prepare(const std::string& _resource,
+                                     ros::NodeHandle& _nh, bool _strict) {
+  PluginMap pending;
 
   // we expect that _resource defines an array
   using namespace XmlRpc;
@@ -94,20 +80,21 @@ ArrayPluginManager<_Plugin>::load(const std::string& _resource,
   // load the data from the param server
   if (!_nh.getParam(_resource, raw)) {
     GPP_DEBUG("no parameter " << _nh.getNamespace() << "/" << _resource);
-    return;
+    return pending;
   }
 
   if (raw.getType() != XmlRpcValue::TypeArray) {
     GPP_WARN("invalid type for " << _resource);
-    return;
+    return pending;
   }
 
   // will throw if not XmlRpcValue::TypeArray
   const auto size = raw.size();
+  pending.reserve(size);
 
-  // clear the old data and allocate space
-  PluginGroup<_Plugin>::plugins_.clear();
-  PluginGroup<_Plugin>::plugins_.reserve(size);
+  // the loaded plugins, which we may reuse
+  const auto& loaded = PluginGroup<_Plugin>::plugins_;
+  std::vector<bool> reused(loaded.size(), false);
 
   // note: size raw.size() returns int
   for (int ii = 0; ii != size; ++ii) {
@@ -116,33 +103,81 @@ ArrayPluginManager<_Plugin>::load(const std::string& _resource,
     try {
       // will throw if the tags are missing or not convertable to std::string
       const auto type = _getStringElement(element, "type");
-      const auto name = _getStringElement(element, "name");
+      const auto param = readPluginParameter(element);
+      const auto& name = param.name;
+
+      // check if we can reuse a loaded instance
+      bool reuse = false;
+      for (size_t jj = 0; jj != loaded.size() && !reuse; ++jj) {
+        reuse = !reused[jj] &&
+                PluginGroup<_Plugin>::isReusable(loaded[jj].first, param);
+        reused[jj] = reuse;
+      }
 
       // will throw if the loading fails
-      // mind the "this"
-      auto plugin = this->createCustomInstance(type);
-
-      // assemble the parameter struct
-      PluginParameter param;
-      param.name = name;
-      param.on_failure_break = _getElement(element, "on_failure_break", true);
-      param.on_success_break = _getElement(element, "on_success_break", false);
+      PluginPtr plugin;
+      if (!reuse && !param.lazy)
+        plugin = create(type);
+
       // this should not throw anymore
-      PluginGroup<_Plugin>::plugins_.emplace_back(param, std::move(plugin));
+      pending.emplace_back(param, std::move(plugin));
 
       // notify the user
-      GPP_INFO("Successfully loaded " << type << " under the name " << name);
+      if (reuse)
+        GPP_INFO("Reusing " << type << " under the name " << name);
+      else if (param.lazy)
+        GPP_INFO("Deferred loading " << type << " under the name " << name);
+      else
+        GPP_INFO("Successfully loaded " << type << " under the name " << name);
     }
     catch (XmlRpcException& ex) {
-      GPP_WARN("failed to read the tag: " << ex.getMessage());
+      _fail("failed to read the tag: " + ex.getMessage(), _strict);
     }
     catch (pluginlib::LibraryLoadException& ex) {
-      GPP_WARN("failed to load the library: " << ex.what());
+      _fail("failed to load the library: " + std::string(ex.what()), _strict);
     }
     catch (pluginlib::CreateClassException& ex) {
-      GPP_WARN("failed to create the class: " << ex.what());
+      _fail("failed to create the class: " + std::string(ex.what()), _strict);
     }
   }
+  return pending;
+}
+
+template <typename _Plugin>
+typename ArrayPluginManager<_Plugin>::PluginMap
+ArrayPluginManager<_Plugin>::commit(const std::string& _resource,
+                                    ros::NodeHandle& _nh, PluginMap&& _pending,
+                                    bool _default_value) {
+  // load the group parameters
+  PluginGroup<_Plugin>::name_ = _resource;
+  // build the prefix once here, so we don't have to do it in _runPlugins
+  PluginGroup<_Plugin>::prefix_ = "[" + _resource + "]: ";
+  PluginGroup<_Plugin>::default_value_ =
+      _nh.param(_resource + "_default_value", _default_value);
+  PluginGroup<_Plugin>::max_duration_ =
+      _nh.param(_resource + "_max_duration", 0.);
+
+  // the context of the adaptive ordering is the distance to the goal
+  typename PluginGroup<_Plugin>::Ordering ordering;
+  ordering.adaptive =
+      _nh.param(_resource + "_ordering", std::string("static")) == "adaptive";
+  ordering.bounds =
+      _nh.param(_resource + "_ordering_distances", std::vector<double>{});
+  std::sort(ordering.bounds.begin(), ordering.bounds.end());
+  ordering.exploration = static_cast<size_t>(std::max(
+      _nh.param(_resource + "_ordering_exploration", 10), 0));
+  PluginGroup<_Plugin>::setOrdering(std::move(ordering));
+
+  return PluginGroup<_Plugin>::replace(std::move(_pending));
+}
+
+template <typename _Plugin>
+typename ArrayPluginManager<_Plugin>::PluginPtr
+ArrayPluginManager<_Plugin>::create(const std::string& _type) {
+  // the class loader is not thread-safe
+  std::lock_guard<std::mutex> lock(create_mutex_);
+  // mind the "this"
+  return this->createCustomInstance(_type);
 }
 
 BaseGlobalPlannerWrapper::BaseGlobalPlannerWrapper(ImplPlanner&& _impl) :
@@ -171,7 +206,64 @@ BaseGlobalPlannerWrapper::initialize(std::string _name, Map* _map) {
   impl_->initialize(_name, _map);
 }
 
-CostmapPlannerManager::~CostmapPlannerManager() { plugins_.clear(); }
+bool
+BaseGlobalPlannerWrapper::cancel() {
+  return impl_->cancel();
+}
+
+bool
+_cancelPlugin(BaseGlobalPlanner& _plugin) {
+  // only the CostmapPlanner interface can be cancelled
+  auto wrapper = dynamic_cast<BaseGlobalPlannerWrapper*>(&_plugin);
+  return wrapper && wrapper->cancel();
+}
+
+PostPlanningWrapper::PostPlanningWrapper(ImplPlugin&& _impl) :
+    impl_(std::move(_impl)) {
+  if (!impl_)
+    throw std::invalid_argument("nullptr is not supported");
+}
+
+bool
+PostPlanningWrapper::postProcess(Path& _path, double& _cost) {
+  gpp_interface::toCompact(_path, compact_);
+  if (!impl_->postProcess(compact_, _cost))
+    return false;
+  gpp_interface::fromCompact(compact_, _path);
+  return true;
+}
+
+void
+PostPlanningWrapper::initialize(const std::string& _name, Map* _map) {
+  impl_->initialize(_name, _map);
+}
+
+CompactPostPlanningManager::~CompactPostPlanningManager() {
+  plugins_.clear();
+  resetLazy();
+}
+
+inline void
+_post_planning_deleter(PostPlanningInterface* _impl) {
+  delete _impl;
+}
+
+pluginlib::UniquePtr<PostPlanningInterface>
+CompactPostPlanningManager::createCustomInstance(const std::string& _type) {
+  // check if this type is know to us
+  if (isClassAvailable(_type))
+    return createUniqueInstance(_type);
+
+  // delegate the construction to the helper manager
+  auto impl = manager_.createCustomInstance(_type);
+  return pluginlib::UniquePtr<PostPlanningInterface>{
+      new PostPlanningWrapper(std::move(impl)), _post_planning_deleter};
+}
+
+CostmapPlannerManager::~CostmapPlannerManager() {
+  plugins_.clear();
+  resetLazy();
+}
 
 inline void
 _default_deleter(BaseGlobalPlanner* impl) {
@@ -193,44 +285,456 @@ CostmapPlannerManager::createCustomInstance(const std::string& _type) {
       new BaseGlobalPlannerWrapper(std::move(impl_planner)), _default_deleter};
 }
 
-/// @brief helper to initialize the pre-planning plugins
+using InitJobs = std::vector<std::function<void()>>;
+
+/**
+ * @brief helper adding the initialization of the new plugins to the _jobs
+ *
+ * @param _pending the output of ArrayPluginManager::prepare. Only the entries
+ * with an instance are new.
+ * @param _init functor taking the plugin and its name and initializing it.
+ */
+template <typename _Map, typename _Init>
+void
+_addInitJobs(const _Map& _pending, const _Init& _init, InitJobs& _jobs) {
+  for (const auto& plugin : _pending) {
+    if (!plugin.second)
+      continue;
+
+    // the instance outlives the moves of the _pending map
+    auto instance = plugin.second.get();
+    const auto& name = plugin.first.name;
+    _jobs.emplace_back([instance, name, _init]() { _init(*instance, name); });
+  }
+}
+
+/**
+ * @brief helper setting up the loading of the lazy plugins within _grp
+ *
+ * The lazy plugins are created, initialized and passed to _on_load on their
+ * first use.
+ *
+ * @param _init functor taking the plugin and its name and initializing it.
+ * @param _on_load functor taking a lazy plugin after its initialization and
+ * its parameter.
+ */
+template <typename _Plugin, typename _Init, typename _OnLoad>
 void
-_initPrePlanning(ros::NodeHandle& _nh, PrePlanningManager& _pre) {
-  // load the plugins
-  _pre.load("pre_planning", _nh);
+_setLoader(ArrayPluginManager<_Plugin>& _grp, const _Init& _init,
+           const _OnLoad& _on_load) {
+  _grp.setLoader([&_grp, _init, _on_load](const PluginParameter& _param) {
+    typename PluginGroup<_Plugin>::PluginPtr plugin;
+    try {
+      plugin = _grp.create(_param.type);
+      _init(*plugin, _param.name);
+      _on_load(*plugin, _param);
+      GPP_INFO("Lazily loaded " << _param.type << " under the name "
+                                << _param.name);
+    }
+    catch (pluginlib::PluginlibException& _ex) {
+      GPP_WARN("failed to load " << _param.name << ": " << _ex.what());
+      plugin.reset();
+    }
+    catch (std::exception& _ex) {
+      GPP_WARN("failed to initialize " << _param.name << ": " << _ex.what());
+      plugin.reset();
+    }
+    return plugin;
+  });
+}
 
-  // init the plugins
-  const auto& plugins = _pre.getPlugins();
-  for (const auto& plugin : plugins)
-    plugin.second->initialize(plugin.first.name);
+/// @brief helper returning a functor, which initializes pre-planning plugins
+inline auto
+_initWithName() {
+  return [](PrePlanningInterface& _plugin, const std::string& _name) {
+    _plugin.initialize(_name);
+  };
 }
 
 using costmap_2d::Costmap2DROS;
 
-/// @brief helper to initialize the post-planning plugins
+/// @brief helper returning a functor, which initializes plugins with _costmap
+inline auto
+_initWith(Costmap2DROS* _costmap) {
+  return [_costmap](auto& _plugin, const std::string& _name) {
+    _plugin.initialize(_name, _costmap);
+  };
+}
+
+/**
+ * @brief helper returning a functor, which initializes the plugins under _ns
+ *
+ * The batch workers run their own instances of the plugins: under the same
+ * names they would advertise the same topics and services. The instances of
+ * a worker are initialized under its namespace, which receives a copy of
+ * the plugin's parameters.
+ *
+ * @param _init functor taking the plugin and its name and initializing it.
+ * @param _ns the namespace (relative to the private one). empty for none.
+ */
+template <typename _Init>
+auto
+_inNamespace(const _Init& _init, const std::string& _ns) {
+  return [_init, _ns](auto& _plugin, const std::string& _name) {
+    if (_ns.empty())
+      return _init(_plugin, _name);
+
+    ros::NodeHandle nh("~");
+    XmlRpc::XmlRpcValue params;
+    if (nh.getParam(_name, params))
+      nh.setParam(_ns + "/" + _name, params);
+    _init(_plugin, _ns + "/" + _name);
+  };
+}
+
+/**
+ * @brief runs the _jobs on up to _threads threads
+ *
+ * Returns after all jobs are done.
+ *
+ * @throw the first exception thrown by a job
+ */
 void
-_initPostPlanning(ros::NodeHandle& _nh, Costmap2DROS* _costmap,
-                  PostPlanningManager& _post) {
-  // load the plugins
-  _post.load("post_planning", _nh);
+_runInitJobs(InitJobs& _jobs, size_t _threads) {
+  if (_threads <= 1 || _jobs.size() <= 1) {
+    for (auto& job : _jobs)
+      job();
+    return;
+  }
+
+  std::vector<std::future<void>> results;
+  results.reserve(_jobs.size());
+  {
+    // the d'tor joins the pool
+    ThreadPool pool(std::min(_threads, _jobs.size()));
+    for (auto& job : _jobs)
+      results.emplace_back(pool.submit(job));
+  }
+  for (auto& result : results)
+    result.get();
+}
+
+using gpp_interface::CostEstimateInterface;
+using gpp_interface::CostmapSnapshotInterface;
+using gpp_interface::DistanceFieldInterface;
+using gpp_interface::PathSeedInterface;
+using gpp_interface::PathStreamInterface;
+using gpp_interface::OutcomeInterface;
+using gpp_interface::RegionOfInterestInterface;
+using gpp_interface::ScratchInterface;
+
+/// @brief returns the _plugin as _Mixin (or nullptr)
+template <typename _Mixin, typename _Plugin>
+_Mixin*
+_asMixin(_Plugin& _plugin) {
+  return dynamic_cast<_Mixin*>(&_plugin);
+}
+
+/// @brief overload looking also into the wrapped CompactPostPlanningInterface
+template <typename _Mixin>
+_Mixin*
+_asMixin(PostPlanningInterface& _plugin) {
+  auto wrapper = dynamic_cast<PostPlanningWrapper*>(&_plugin);
+  if (wrapper)
+    return dynamic_cast<_Mixin*>(&wrapper->getImpl());
+  return dynamic_cast<_Mixin*>(&_plugin);
+}
+
+/// @brief overload looking also into the wrapped CostmapPlanner
+template <typename _Mixin>
+_Mixin*
+_asMixin(BaseGlobalPlanner& _plugin) {
+  auto wrapper = dynamic_cast<BaseGlobalPlannerWrapper*>(&_plugin);
+  if (wrapper)
+    return dynamic_cast<_Mixin*>(&wrapper->getImpl());
+  return dynamic_cast<_Mixin*>(&_plugin);
+}
 
-  // init the plugins
-  const auto& plugins = _post.getPlugins();
-  for (const auto& plugin : plugins)
-    plugin.second->initialize(plugin.first.name, _costmap);
+/// @brief collects the plugins of the _grp consuming the costmap snapshot
+template <typename _Plugin>
+void
+_addSnapshotConsumers(const PluginGroup<_Plugin>& _grp,
+                      std::vector<CostmapSnapshotInterface*>& _consumers) {
+  for (const auto& plugin : _grp.getPlugins()) {
+    // the lazy plugins are added once they are loaded
+    if (!plugin.second)
+      continue;
+    auto consumer = _asMixin<CostmapSnapshotInterface>(*plugin.second);
+    if (consumer)
+      _consumers.push_back(consumer);
+  }
 }
 
-/// @brief helper to initialize the planning plugins
+/// @brief passes the _provider to the _plugin, if it uses the distance field
+template <typename _Plugin>
 void
-_initPlanning(ros::NodeHandle& _nh, Costmap2DROS* _costmap,
-              CostmapPlannerManager& _planner) {
-  // load the plugins
-  _planner.load("planning", _nh);
+_setDistanceFieldProvider(_Plugin& _plugin,
+                          gpp_interface::DistanceFieldProvider& _provider) {
+  auto consumer = _asMixin<DistanceFieldInterface>(_plugin);
+  if (consumer)
+    consumer->setDistanceFieldProvider(_provider);
+}
+
+/// @brief passes the _sink to the _plugin, if it streams its path
+template <typename _Plugin>
+void
+_setPrefixSink(_Plugin& _plugin, gpp_interface::PathPrefixSink* _sink) {
+  auto stream = _asMixin<PathStreamInterface>(_plugin);
+  if (stream)
+    stream->setPrefixSink(_sink);
+}
+
+/// @brief passes the _arena to the _plugin, if it needs scratch memory
+template <typename _Plugin>
+void
+_setScratchArena(_Plugin& _plugin, gpp_interface::ScratchArena& _arena) {
+  auto consumer = _asMixin<ScratchInterface>(_plugin);
+  if (consumer)
+    consumer->setScratchArena(_arena);
+}
+
+/// @brief passes the _arena to the plugins of the _grp
+template <typename _Plugin>
+void
+_setScratchArenas(const PluginGroup<_Plugin>& _grp,
+                  gpp_interface::ScratchArena& _arena) {
+  for (const auto& plugin : _grp.getPlugins()) {
+    // the lazy plugins receive it once they are loaded
+    if (plugin.second)
+      _setScratchArena(*plugin.second, _arena);
+  }
+}
+
+/// @brief passes the _provider to the plugins of the _grp
+template <typename _Plugin>
+void
+_setDistanceFieldProviders(const PluginGroup<_Plugin>& _grp,
+                           gpp_interface::DistanceFieldProvider& _provider) {
+  for (const auto& plugin : _grp.getPlugins()) {
+    // the lazy plugins receive it once they are loaded
+    if (plugin.second)
+      _setDistanceFieldProvider(*plugin.second, _provider);
+  }
+}
+
+/// @brief returns the number of lazy plugins in _grp, which aren't loaded
+template <typename _Plugin>
+size_t
+_countLazy(const PluginGroup<_Plugin>& _grp) {
+  const auto& plugins = _grp.getPlugins();
+  return std::count_if(plugins.begin(), plugins.end(), [](const auto& _plugin) {
+    return _plugin.first.lazy && !_plugin.second;
+  });
+}
+
+void
+GlobalPlannerPipeline::setupLoaders() {
+  // the lazy plugins may read the snapshot or define the region of interest
+  auto roi = [this](PrePlanningInterface& _plugin,
+                    const PluginParameter& _param) {
+    resolveMixins(_param, _plugin);
+    if (!roi_)
+      roi_ = dynamic_cast<RegionOfInterestInterface*>(&_plugin);
+    _setDistanceFieldProvider(_plugin, distance_views_[0]);
+    _setScratchArena(_plugin, scratch_[0]);
+  };
+  auto consumer = [this](auto& _plugin, const PluginParameter&) {
+    if (lazy_readers_)
+      --lazy_readers_;
+    addSnapshotConsumer(_asMixin<CostmapSnapshotInterface>(_plugin));
+    _setDistanceFieldProvider(_plugin, distance_views_[1]);
+    _setScratchArena(_plugin, scratch_[1]);
+  };
+  auto planner = [this, consumer](BaseGlobalPlanner& _plugin,
+                                  const PluginParameter& _param) {
+    resolveMixins(_param, _plugin);
+    consumer(_plugin, _param);
+  };
+  auto post_consumer = [this](PostPlanningInterface& _plugin,
+                              const PluginParameter&) {
+    if (lazy_readers_)
+      --lazy_readers_;
+    addPostSnapshotConsumer(_asMixin<CostmapSnapshotInterface>(_plugin));
+    _setDistanceFieldProvider(_plugin, distance_views_[2]);
+    _setScratchArena(_plugin, scratch_[2]);
+  };
+
+  const auto init = _inNamespace(_initWith(costmap_), plugin_ns_);
+  _setLoader(pre_planning_, _inNamespace(_initWithName(), plugin_ns_), roi);
+  _setLoader(post_planning_, init, post_consumer);
+  _setLoader(replanning_, init, consumer);
+  _setLoader(global_planning_, init, planner);
+}
+
+GlobalPlannerPipeline::PendingGroups
+GlobalPlannerPipeline::prepareGroups(ros::NodeHandle& _nh, InitJobs& _jobs,
+                                     bool _strict) {
+  // load the plugins from the param-server
+  PendingGroups pending;
+  pending.pre_planning = pre_planning_.prepare("pre_planning", _nh, _strict);
+  pending.post_planning = post_planning_.prepare("post_planning", _nh, _strict);
+  pending.replanning = replanning_.prepare("replanning", _nh, _strict);
+  pending.planning = global_planning_.prepare("planning", _nh, _strict);
+
+  // init only the new plugins
+  const auto init = _inNamespace(_initWith(costmap_), plugin_ns_);
+  _addInitJobs(pending.pre_planning, _inNamespace(_initWithName(), plugin_ns_),
+               _jobs);
+  _addInitJobs(pending.post_planning, init, _jobs);
+  _addInitJobs(pending.replanning, init, _jobs);
+  _addInitJobs(pending.planning, init, _jobs);
+  return pending;
+}
+
+GlobalPlannerPipeline::PendingGroups
+GlobalPlannerPipeline::commitGroups(ros::NodeHandle& _nh,
+                                    PendingGroups&& _pending) {
+  tolerance_ = _nh.param("tolerance", 0.1);
+
+  // swap the plugins. by default a reused path skips the planning
+  PendingGroups dropped;
+  dropped.pre_planning = pre_planning_.commit(
+      "pre_planning", _nh, std::move(_pending.pre_planning));
+  dropped.post_planning = post_planning_.commit(
+      "post_planning", _nh, std::move(_pending.post_planning));
+  dropped.replanning = replanning_.commit(
+      "replanning", _nh, std::move(_pending.replanning), true);
+  dropped.planning = global_planning_.commit("planning", _nh,
+                                             std::move(_pending.planning));
+  last_plan_.clear();
+  {
+    // the legs were planned with the old plugins
+    std::lock_guard<std::mutex> lock(speculation_mutex_);
+    speculations_.clear();
+  }
+
+  // the snapshot is only taken, if someone reads it. the post-planning
+  // group receives it separately, since it may lag behind (see runStage)
+  snapshot_consumers_.clear();
+  post_snapshot_consumers_.clear();
+  current_snapshot_ = nullptr;
+  current_post_snapshot_ = nullptr;
+  _addSnapshotConsumers(replanning_, snapshot_consumers_);
+  _addSnapshotConsumers(global_planning_, snapshot_consumers_);
+  _addSnapshotConsumers(post_planning_, post_snapshot_consumers_);
+  post_consumed_ = !post_snapshot_consumers_.empty();
+  lazy_readers_ = _countLazy(replanning_) + _countLazy(global_planning_) +
+                  _countLazy(post_planning_);
+  const auto consumers =
+      snapshot_consumers_.size() + post_snapshot_consumers_.size();
+  if (consumers)
+    GPP_INFO("sharing a costmap snapshot with " << consumers << " plugins");
+
+  // the distance field is computed on demand
+  _setDistanceFieldProviders(pre_planning_, distance_views_[0]);
+  _setDistanceFieldProviders(replanning_, distance_views_[1]);
+  _setDistanceFieldProviders(global_planning_, distance_views_[1]);
+  _setDistanceFieldProviders(post_planning_, distance_views_[2]);
+
+  // every stage has its own scratch memory (the replanning and the planning
+  // share the stage)
+  scratch_memory_ = std::max(_nh.param("scratch_memory", 1.), 0.) * 1e6;
+  _setScratchArenas(pre_planning_, scratch_[0]);
+  _setScratchArenas(replanning_, scratch_[1]);
+  _setScratchArenas(global_planning_, scratch_[1]);
+  _setScratchArenas(post_planning_, scratch_[2]);
+
+  // the mixins are resolved once: the lazy plugins do so once they are loaded
+  mixins_.clear();
+  for (const auto& plugin : pre_planning_.getPlugins()) {
+    mixins_[&plugin.first];
+    if (plugin.second)
+      resolveMixins(plugin.first, *plugin.second);
+  }
+  for (const auto& plugin : global_planning_.getPlugins()) {
+    mixins_[&plugin.first];
+    if (plugin.second)
+      resolveMixins(plugin.first, *plugin.second);
+  }
+
+  // the first pre-planning plugin defining a region of interest crops the
+  // snapshot
+  roi_ = nullptr;
+  for (const auto& plugin : pre_planning_.getPlugins()) {
+    if (plugin.second)
+      roi_ = dynamic_cast<RegionOfInterestInterface*>(plugin.second.get());
+    if (roi_) {
+      GPP_INFO("cropping the snapshot to the region of " << plugin.first.name);
+      break;
+    }
+  }
+  if (roi_ && !consumers)
+    GPP_WARN("no plugin reads the snapshot: the region of interest is ignored");
+
+  // the concurrent post-planning plugins: the calling thread runs one of them
+  size_t run = 0;
+  size_t longest = 0;
+  for (const auto& plugin : post_planning_.getPlugins()) {
+    // the plugins writing the cost must run sequentially
+    if (plugin.first.read_only && plugin.first.affects_cost)
+      GPP_INFO(plugin.first.name << " affects the cost: it runs sequentially");
+    run = _isConcurrent(plugin.first) ? run + 1 : 0;
+    longest = std::max(longest, run);
+  }
+  post_pool_.reset();
+  if (longest > 1)
+    post_pool_.reset(new ThreadPool(longest - 1));
+
+  // setup the execution mode of the planning group
+  const auto mode = _nh.param("planning_mode", std::string("sequential"));
+  race_pool_.reset();
+  coarse_factor_ = 0;
+  if (mode == "race") {
+    const auto size = global_planning_.getPlugins().size();
+    race_pool_.reset(new ThreadPool(size));
+    race_plans_.resize(size);
+    race_costs_.resize(size);
+    race_messages_.resize(size);
+    race_state_.resize(size);
+  }
+  else if (mode == "coarse_to_fine") {
+    coarse_factor_ = std::max(_nh.param("coarse_factor", 4), 1);
+    // lazy planners are checked once they run
+    const auto& plugins = global_planning_.getPlugins();
+    if (!plugins.empty() && plugins.front().second &&
+        !_asMixin<CostmapSnapshotInterface>(*plugins.front().second))
+      GPP_WARN("the first planner does not read the snapshot: "
+               "it will plan on the full resolution");
+  }
+  else if (mode != "sequential")
+    GPP_WARN("unknown planning_mode " << mode << ", using sequential");
+
+  // streaming: only the last plugin altering the path may forward its prefix.
+  // the racing planners don't stream
+  planning_stream_ = nullptr;
+  post_stream_ = nullptr;
+  const auto& post = post_planning_.getPlugins();
+  const auto alters = std::find_if(
+      post.rbegin(), post.rend(),
+      [](const PostPlanningManager::NamedPlugin& _plugin) {
+        return !_plugin.first.read_only;
+      });
+  if (alters != post.rend())
+    post_stream_ = &alters->first;
+  else if (!race_pool_ && !global_planning_.getPlugins().empty())
+    planning_stream_ = &global_planning_.getPlugins().back().first;
+
+  // the read-only plugins after the streaming one validate the path first
+  prefix_sinks_[0].hold = !post.empty();
+  prefix_sinks_[1].hold = alters != post.rend() && alters != post.rbegin();
+  return dropped;
+}
 
-  // init the plugins
-  const auto& plugins = _planner.getPlugins();
-  for (const auto& plugin : plugins)
-    plugin.second->initialize(plugin.first.name, _costmap);
+/// @brief helper to run the _jobs and to report the time
+void
+_initPlugins(InitJobs& _jobs, size_t _threads) {
+  const auto start = std::chrono::steady_clock::now();
+  _runInitJobs(_jobs, _threads ? _threads : std::thread::hardware_concurrency());
+  GPP_INFO("initialized " << _jobs.size() << " plugins in "
+                          << std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count()
+                          << " seconds");
 }
 
 void
@@ -238,91 +742,1779 @@ GlobalPlannerPipeline::initialize(std::string _name, Map* _costmap) {
   name_ = _name;
   costmap_ = _costmap;
 
-  // init the plugins
+  // load the plugins
   ros::NodeHandle nh("~" + name_);
-  tolerance_ = nh.param("tolerance", 0.1);
+  pipelined_ = nh.param("pipelined", false);
+  InitJobs jobs;
+  setupLoaders();
+  auto pending = prepareGroups(nh, jobs);
 
-  // load the plugins from the param-server
-  _initPrePlanning(nh, pre_planning_);
-  _initPostPlanning(nh, costmap_, post_planning_);
-  _initPlanning(nh, costmap_, global_planning_);
+  // setup the batch workers: they share everything but the groups
+  batch_pool_.reset();
+  batch_workers_.clear();
+  std::vector<PendingGroups> worker_pending;
+  const auto workers = std::max(nh.param("batch_workers", 0), 0);
+  if (workers) {
+    batch_pool_.reset(new ThreadPool(workers));
+    for (int ii = 0; ii != workers; ++ii) {
+      std::unique_ptr<GlobalPlannerPipeline> worker(new GlobalPlannerPipeline);
+      worker->name_ = name_;
+      worker->plugin_ns_ = name_ + "/batch_worker_" + std::to_string(ii);
+      worker->costmap_ = costmap_;
+      worker->setupLoaders();
+      worker_pending.emplace_back(worker->prepareGroups(nh, jobs));
+      batch_workers_.emplace_back(std::move(worker));
+    }
+    GPP_INFO("started " << workers << " batch workers");
+  }
+  idle_workers_.clear();
+  for (const auto& worker : batch_workers_)
+    idle_workers_.emplace_back(worker.get());
+  concurrent_ = nh.param("concurrent", false);
+  if (concurrent_ && batch_workers_.empty())
+    GPP_WARN("no batch workers: the concurrent mode is disabled");
+
+  // init the plugins of all groups and workers concurrently
+  // not every plugin tolerates a concurrent initialization: opt-in
+  init_threads_ = std::max(nh.param("init_threads", 1), 0);
+  _initPlugins(jobs, init_threads_);
+  commitGroups(nh, std::move(pending));
+  for (size_t ii = 0; ii != batch_workers_.size(); ++ii)
+    batch_workers_[ii]->commitGroups(nh, std::move(worker_pending[ii]));
+  if (!batch_workers_.empty() && !readsOnlySnapshot())
+    GPP_WARN("not all planners read the snapshot: the batches and the "
+             "concurrent requests run on the pipeline");
+
+  // setup the cache
+  PlanCache::Parameter cache_param;
+  cache_param.capacity = std::max(nh.param("cache/capacity", 0), 0);
+  cache_param.memory = std::max(nh.param("cache/memory", 16.), 0.) * 1e6;
+  cache_param.position_resolution = nh.param("cache/position_resolution", 0.05);
+  cache_param.angle_resolution = nh.param("cache/angle_resolution", 0.1);
+  cache_.reset();
+  if (cache_param.capacity) {
+    try {
+      cache_.reset(new PlanCache(cache_param));
+    }
+    catch (std::invalid_argument& _ex) {
+      GPP_WARN("failed to setup the cache: " << _ex.what());
+    }
+  }
+  revision_layer_ = findRevisionLayer(*costmap_);
+  if (cache_ && !revision_layer_)
+    GPP_WARN("the costmap has no gpp_plugin::RevisionLayer: "
+             "the cache hashes the entire map on every request");
+
+  // setup the publishing of the statistics
+  diagnostics_timer_.stop();
+  const auto rate = nh.param("diagnostics_rate", 0.);
+  if (rate > 0) {
+    diagnostics_pub_ =
+        nh.advertise<diagnostic_msgs::DiagnosticArray>("diagnostics", 1);
+    diagnostics_timer_ = nh.createWallTimer(
+        ros::WallDuration(1. / rate),
+        &GlobalPlannerPipeline::publishDiagnostics, this);
+  }
+
+  // validity check of the legs planned ahead
+  speculation_distance_ = nh.param("speculation/max_distance", 0.5);
+  const int lethal = nh.param("speculation/lethal_cost",
+                              int(costmap_2d::INSCRIBED_INFLATED_OBSTACLE));
+  speculation_lethal_ =
+      static_cast<unsigned char>(std::min(std::max(lethal, 1), 255));
+
+  // tracing of the requests
+  stopTraceDumps();
+  const auto trace_capacity = std::max(nh.param("trace/capacity", 0), 0);
+  trace_slow_ = nh.param("trace/slow_request", 0.);
+  trace_file_ = nh.param("trace/file", std::string("/tmp/gpp_trace.json"));
+  trace_files_ = std::max(nh.param("trace/files", 10), 1);
+  if (trace_capacity) {
+    trace_.reset(new TraceRing(trace_capacity));
+    setTraceRing(trace_.get());
+    trace_srv_ = nh.advertiseService(
+        "dump_trace", &GlobalPlannerPipeline::onDumpTrace, this);
+    GPP_INFO("tracing the last " << trace_->capacity() << " spans");
+    if (trace_slow_ > 0)
+      trace_thread_ =
+          std::thread(&GlobalPlannerPipeline::runTraceDumps, this);
+  }
+
+  // publishing of the streamed prefix
+  publish_prefix_ = nh.param("publish_prefix", false);
+  if (publish_prefix_)
+    prefix_pub_ = nh.advertise<nav_msgs::Path>("prefix", 1);
+
+  for (const auto& worker : batch_workers_)
+    configureWorker(*worker);
+
+  reload_srv_ =
+      nh.advertiseService("reload", &GlobalPlannerPipeline::onReload, this);
 }
 
 bool
-GlobalPlannerPipeline::prePlanning(Pose& _start, Pose& _goal,
-                                   double _tolerance) {
-  auto pre_planning = [&](PrePlanningInterface& _plugin) {
-    return _plugin.preProcess(_start, _goal, *costmap_, _tolerance);
-  };
-  return runPlugins(pre_planning_, pre_planning, cancel_);
+GlobalPlannerPipeline::reload() {
+  // one reload at a time
+  std::lock_guard<std::mutex> reload_lock(reload_mutex_);
+  ros::NodeHandle nh("~" + name_);
+
+  // create and init the new plugins, while the old ones may still plan. a
+  // plugin, which cannot be created, aborts the reload
+  InitJobs jobs;
+  PendingGroups pending;
+  std::vector<PendingGroups> worker_pending;
+  try {
+    pending = prepareGroups(nh, jobs, true);
+    for (const auto& worker : batch_workers_)
+      worker_pending.emplace_back(worker->prepareGroups(nh, jobs, true));
+    _initPlugins(jobs, init_threads_);
+  }
+  catch (std::exception& _ex) {
+    // the loaded plugins remain untouched
+    GPP_WARN("failed to reload: " << _ex.what());
+    return false;
+  }
+
+  // swap the groups between two requests. the dropped plugins are destroyed
+  // after the locks are released
+  std::vector<PendingGroups> dropped;
+  {
+    const auto plan_lock = lockPipeline();
+    // wait for the workers serving concurrent requests
+    const auto workers = borrowWorkers(true);
+    std::lock_guard<std::mutex> groups_lock(groups_mutex_);
+    dropped.emplace_back(commitGroups(nh, std::move(pending)));
+    for (size_t ii = 0; ii != batch_workers_.size(); ++ii)
+      dropped.emplace_back(
+          batch_workers_[ii]->commitGroups(nh, std::move(worker_pending[ii])));
+
+    // the cached paths might be invalid for the new pipeline
+    if (cache_)
+      cache_->clear();
+    returnWorkers(workers);
+  }
+  GPP_INFO("reloaded the pipeline");
+  return true;
 }
 
 bool
-GlobalPlannerPipeline::postPlanning(Path& _path, double& _cost) {
-  auto post_planning = [&](PostPlanningInterface& _plugin) {
-    return _plugin.postProcess(_path, _cost);
-  };
-  return runPlugins(post_planning_, post_planning, cancel_);
+GlobalPlannerPipeline::onReload(std_srvs::Trigger::Request&,
+                                std_srvs::Trigger::Response& _res) {
+  _res.success = reload();
+  _res.message = _res.success ? "reloaded" : "failed to reload";
+  return true;
 }
 
 bool
-GlobalPlannerPipeline::globalPlanning(const Pose& _start, const Pose& _goal,
-                                      Path& _plan, double& _cost) {
-  // run all global planners... typically only one should be loaded.
-  auto planning = [&](BaseGlobalPlanner& _plugin) {
-    return _plugin.makePlan(_start, _goal, _plan, _cost);
-  };
-  return runPlugins(global_planning_, planning, cancel_);
+GlobalPlannerPipeline::onDumpTrace(std_srvs::Trigger::Request&,
+                                   std_srvs::Trigger::Response& _res) {
+  _res.success = dumpTrace(trace_file_);
+  _res.message = _res.success ? "dumped to " + trace_file_ : "failed to dump";
+  return true;
 }
 
 bool
-GlobalPlannerPipeline::makePlan(const Pose& _start, const Pose& _goal,
-                                Path& _plan) {
-  double cost;
-  return makePlan(_start, _goal, _plan, cost);
+GlobalPlannerPipeline::dumpTrace(const std::string& _file) const {
+  if (!trace_)
+    return false;
+
+  std::ofstream file(_file);
+  trace_->dump(file);
+  return static_cast<bool>(file);
 }
 
-bool
-GlobalPlannerPipeline::makePlan(const Pose& _start, const Pose& _goal,
-                                Path& _plan, double& _cost) {
-  std::string message;
-  // clang-format off
-  return makePlan(_start, _goal, tolerance_, _plan, _cost, message) == MBF_SUCCESS;
-  // clang-format on
+void
+GlobalPlannerPipeline::finishTrace(TraceSpan& _span) {
+  _span.finish();
+  if (trace_slow_ <= 0 || _span.getSeconds() <= trace_slow_)
+    return;
+
+  GPP_HOT_WARN("[gpp]: slow request (" << _span.getSeconds() << " s)");
+  // the file is written by the trace_thread_. a running dump covers the
+  // spans of this request as well
+  {
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    if (!trace_thread_.joinable() || trace_pending_)
+      return;
+    trace_pending_ = true;
+  }
+  trace_cv_.notify_one();
 }
 
-uint32_t
-GlobalPlannerPipeline::makePlan(const Pose& _start, const Pose& _goal,
-                                const double _tolerance, Path& _plan,
-                                double& _cost, std::string& _message) {
-  // reset cancel flag
-  cancel_ = false;
+/// @brief returns the _file with the _index before its extension
+std::string
+_rotatedFile(const std::string& _file, const size_t _index) {
+  const auto slash = _file.find_last_of('/');
+  auto dot = _file.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    dot = _file.size();
+  return _file.substr(0, dot) + "_" + std::to_string(_index) +
+         _file.substr(dot);
+}
 
-  // local copies since we might alter the poses
-  Pose start = _start;
-  Pose goal = _goal;
-  _plan.clear();
+void
+GlobalPlannerPipeline::runTraceDumps() {
+  std::unique_lock<std::mutex> lock(trace_mutex_);
+  while (true) {
+    trace_cv_.wait(lock, [this]() { return trace_pending_ || trace_stop_; });
+    if (trace_stop_)
+      return;
 
-  // pre-planning
-  if (!prePlanning(start, goal, _tolerance))
-    return MBF_FAILURE;
+    // the oldest file is overwritten
+    const auto file = _rotatedFile(trace_file_, trace_dumps_++ % trace_files_);
+    lock.unlock();
+    if (dumpTrace(file))
+      GPP_INFO("dumped the trace to " << file);
+    else
+      GPP_WARN("failed to dump the trace to " << file);
+    lock.lock();
+    trace_pending_ = false;
+  }
+}
 
-  // planning
-  if (!globalPlanning(start, goal, _plan, _cost))
-    return MBF_FAILURE;
+void
+GlobalPlannerPipeline::stopTraceDumps() {
+  if (!trace_thread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    trace_stop_ = true;
+  }
+  trace_cv_.notify_one();
+  trace_thread_.join();
+  trace_stop_ = false;
+  trace_pending_ = false;
+}
 
-  // post-planning
-  if (!postPlanning(_plan, _cost))
-    return MBF_FAILURE;
+/// @brief helper to add the statistics of the _grp to the _map
+template <typename _Plugin>
+void
+_addStats(const PluginGroup<_Plugin>& _grp,
+          GlobalPlannerPipeline::StatsMap& _map) {
+  const auto& plugins = _grp.getPlugins();
+  auto stats = _grp.getStats();
+  for (size_t ii = 0; ii != plugins.size(); ++ii)
+    _map[_grp.getName() + "/" + plugins[ii].first.name].merge(stats[ii]);
+}
 
-  return MBF_SUCCESS;
+PlanCache::Stats
+GlobalPlannerPipeline::getCacheStats() const {
+  return cache_ ? cache_->getStats() : PlanCache::Stats{};
 }
 
-bool
-GlobalPlannerPipeline::cancel() {
-  GPP_INFO("cancelling");
-  cancel_ = true;
-  return true;
+GlobalPlannerPipeline::StatsMap
+GlobalPlannerPipeline::getStats() const {
+  // the names of the plugins may change on reload
+  std::lock_guard<std::mutex> groups_lock(groups_mutex_);
+  StatsMap stats;
+  _addStats(pre_planning_, stats);
+  _addStats(replanning_, stats);
+  _addStats(global_planning_, stats);
+  _addStats(post_planning_, stats);
+
+  // the batch workers run the same plugins
+  for (const auto& worker : batch_workers_) {
+    _addStats(worker->pre_planning_, stats);
+    _addStats(worker->replanning_, stats);
+    _addStats(worker->global_planning_, stats);
+    _addStats(worker->post_planning_, stats);
+  }
+  return stats;
+}
+
+/// @brief helper to append a key-value pair to the _status
+template <typename _T>
+void
+_addValue(diagnostic_msgs::DiagnosticStatus& _status, const std::string& _key,
+          const _T& _value) {
+  diagnostic_msgs::KeyValue pair;
+  pair.key = _key;
+  pair.value = std::to_string(_value);
+  _status.values.emplace_back(std::move(pair));
+}
+
+void
+GlobalPlannerPipeline::publishDiagnostics(const ros::WallTimerEvent&) {
+  diagnostic_msgs::DiagnosticArray msg;
+  msg.header.stamp = ros::Time::now();
+
+  for (const auto& entry : getStats()) {
+    const auto& stats = entry.second;
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = name_ + "/" + entry.first;
+    status.message = std::to_string(stats.calls) + " calls";
+
+    _addValue(status, "calls", stats.calls);
+    _addValue(status, "successes", stats.successes);
+    _addValue(status, "failures", stats.failures);
+    _addValue(status, "mean [s]", stats.mean());
+    _addValue(status, "p50 [s]", stats.latency.percentile(0.5));
+    _addValue(status, "p95 [s]", stats.latency.percentile(0.95));
+    _addValue(status, "p99 [s]", stats.latency.percentile(0.99));
+    if (getAllocationCounter())
+      _addValue(status, "allocations", stats.allocations);
+    if (stats.load_time > 0)
+      _addValue(status, "load time [s]", stats.load_time);
+    msg.status.emplace_back(std::move(status));
+  }
+
+  if (cache_) {
+    const auto stats = cache_->getStats();
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = name_ + "/cache";
+    status.message = std::to_string(stats.size) + " entries";
+
+    _addValue(status, "hits", stats.hits);
+    _addValue(status, "misses", stats.misses);
+    _addValue(status, "size", stats.size);
+    _addValue(status, "memory [bytes]", stats.memory);
+    msg.status.emplace_back(std::move(status));
+  }
+
+  diagnostics_pub_.publish(msg);
+}
+
+/**
+ * @brief returns the current revision of the _map
+ *
+ * With the _layer the revision costs O(1) - otherwise we hash the entire map.
+ */
+uint64_t
+_getRevision(Costmap2DROS& _map, const RevisionLayer* _layer) {
+  const auto costmap = _map.getCostmap();
+  using mutex_t = costmap_2d::Costmap2D::mutex_t;
+  TraceSpan wait("lock", "costmap");
+  boost::unique_lock<mutex_t> lock(*costmap->getMutex());
+  wait.finish();
+  // a rolling window moves without changing the cells: add the geometry
+  if (_layer)
+    return costmapRevision(*costmap, _layer->getRevision());
+  return costmapRevision(*costmap);
+}
+
+/// @brief returns the planar distance between the poses (the context of the
+/// adaptive ordering)
+inline double
+_distance(const geometry_msgs::PoseStamped& _a,
+          const geometry_msgs::PoseStamped& _b) noexcept {
+  const auto& pa = _a.pose.position;
+  const auto& pb = _b.pose.position;
+  return std::hypot(pa.x - pb.x, pa.y - pb.y);
+}
+
+bool
+GlobalPlannerPipeline::prePlanning(Pose& _start, Pose& _goal,
+                                   double _tolerance, uint32_t& _outcome,
+                                   std::string& _message) {
+  // the pre-planning of the workers may run concurrently: it may alter the
+  // live map
+  std::lock_guard<std::mutex> live_lock(*pre_planning_mutex_);
+  _outcome = MBF_FAILURE;
+  auto pre_planning = [&](PrePlanningInterface& _plugin,
+                          const PluginParameter& _param) {
+    if (_plugin.preProcess(_start, _goal, *costmap_, _tolerance))
+      return true;
+
+    // the plugin may tell us why it failed
+    auto reason = getMixins(_param).outcome;
+    if (reason)
+      _outcome = reason->getOutcome(_message);
+    return false;
+  };
+  pre_planning_.setContext(_distance(_start, _goal));
+  return runPlugins(pre_planning_, pre_planning, cancel_, &watchdogs_[0]);
+}
+
+bool
+GlobalPlannerPipeline::postPlanning(Path& _path, double& _cost,
+                                    const bool _cost_only) {
+  // an estimated cost comes without a path we could process
+  if (_cost_only && _path.empty())
+    return true;
+
+  // we convert the path only if the representation has to change. the
+  // read-only plugins (which may run concurrently) keep both valid
+  constexpr int vector = 1;
+  constexpr int compact = 2;
+  int valid = vector;
+  std::mutex valid_mutex;
+  const auto streaming = !_cost_only && isStreaming();
+  prefix_sinks_[1].held.clear();
+  auto post_planning = [&](PostPlanningInterface& _plugin,
+                           const PluginParameter& _param) {
+    if (streaming)
+      _setPrefixSink(_plugin,
+                     &_param == post_stream_ ? &prefix_sinks_[1] : nullptr);
+
+    auto wrapper = dynamic_cast<PostPlanningWrapper*>(&_plugin);
+    {
+      std::lock_guard<std::mutex> lock(valid_mutex);
+      if (wrapper && !(valid & compact))
+        gpp_interface::toCompact(_path, compact_plan_);
+      else if (!wrapper && !(valid & vector))
+        gpp_interface::fromCompact(compact_plan_, _path);
+      valid |= wrapper ? compact : vector;
+      // the other representation becomes stale
+      if (!_param.read_only)
+        valid = wrapper ? compact : vector;
+    }
+
+    if (wrapper)
+      return wrapper->getImpl().postProcess(compact_plan_, _cost);
+    return _plugin.postProcess(_path, _cost);
+  };
+
+  // only the plugins affecting the cost matter, if we just want the cost
+  auto skip = [_cost_only](const PluginParameter& _param) {
+    return _cost_only && !_param.affects_cost;
+  };
+
+  post_planning_.setContext(
+      _path.empty() ? 0. : _distance(_path.front(), _path.back()));
+  const auto result = runPlugins(post_planning_, post_planning, cancel_,
+                                 &watchdogs_[2], skip, post_pool_.get());
+  if (!(valid & vector))
+    gpp_interface::fromCompact(compact_plan_, _path);
+  return result;
+}
+
+/// @brief returns true, if both poses are equal
+inline bool
+_isEqual(const geometry_msgs::PoseStamped& _a,
+         const geometry_msgs::PoseStamped& _b) noexcept {
+  constexpr double eps = 1e-6;
+  const auto& pa = _a.pose.position;
+  const auto& pb = _b.pose.position;
+  const auto& qa = _a.pose.orientation;
+  const auto& qb = _b.pose.orientation;
+  return _a.header.frame_id == _b.header.frame_id &&
+         std::abs(pa.x - pb.x) < eps && std::abs(pa.y - pb.y) < eps &&
+         std::abs(pa.z - pb.z) < eps && std::abs(qa.x - qb.x) < eps &&
+         std::abs(qa.y - qb.y) < eps && std::abs(qa.z - qb.z) < eps &&
+         std::abs(qa.w - qb.w) < eps;
+}
+
+bool
+GlobalPlannerPipeline::canReplan(const Pose& _goal) {
+  // we can only reuse a path to the same goal
+  std::lock_guard<std::mutex> lock(last_plan_mutex_);
+  return !replanning_.getPlugins().empty() && !last_plan_.empty() &&
+         _isEqual(_goal, last_goal_);
+}
+
+bool
+GlobalPlannerPipeline::replanning(const Pose& _start, const Pose& _goal,
+                                  Path& _plan, double& _cost) {
+  {
+    // we can only reuse a path to the same goal
+    std::lock_guard<std::mutex> lock(last_plan_mutex_);
+    if (replanning_.getPlugins().empty() || last_plan_.empty() ||
+        !_isEqual(_goal, last_goal_))
+      return false;
+
+    _plan = last_plan_;
+    _cost = last_cost_;
+  }
+  auto reuse = [&](ReplanningInterface& _plugin) {
+    return _plugin.reuse(_start, _goal, _plan, _cost);
+  };
+
+  // a failure is not an error here: we just have to plan again
+  replanning_.setContext(_distance(_start, _goal));
+  if (_runPlugins(replanning_, reuse, cancel_, &watchdogs_[1]))
+    return true;
+
+  // the last path is invalid now
+  {
+    std::lock_guard<std::mutex> lock(last_plan_mutex_);
+    last_plan_.clear();
+  }
+  _plan.clear();
+  return false;
+}
+
+void
+GlobalPlannerPipeline::resolveMixins(const PluginParameter& _param,
+                                     PrePlanningInterface& _plugin) {
+  mixins_.at(&_param).outcome = _asMixin<OutcomeInterface>(_plugin);
+}
+
+void
+GlobalPlannerPipeline::resolveMixins(const PluginParameter& _param,
+                                     BaseGlobalPlanner& _plugin) {
+  auto& mixins = mixins_.at(&_param);
+  auto wrapper = dynamic_cast<BaseGlobalPlannerWrapper*>(&_plugin);
+  mixins.planner = wrapper ? &wrapper->getImpl() : nullptr;
+  mixins.estimator = _asMixin<CostEstimateInterface>(_plugin);
+  mixins.seed = _asMixin<PathSeedInterface>(_plugin);
+  mixins.snapshot = _asMixin<CostmapSnapshotInterface>(_plugin);
+}
+
+const GlobalPlannerPipeline::PluginMixins&
+GlobalPlannerPipeline::getMixins(const PluginParameter& _param) const {
+  return mixins_.at(&_param);
+}
+
+/**
+ * @brief calls _plugin.makePlan - or its estimateCost, if _cost_only is set
+ *
+ * A CostmapPlanner is called directly (not through the
+ * BaseGlobalPlannerWrapper): it receives the _tolerance and reports its own
+ * outcome and _message.
+ *
+ * @param _planner the CostmapPlanner behind the _plugin (or nullptr)
+ * @param _estimator the _plugin as cost estimator (or nullptr)
+ * @return the outcome as defined by mbf_msgs/GetPath
+ */
+inline uint32_t
+_makePlan(BaseGlobalPlanner& _plugin, CostmapPlanner* _planner,
+          CostEstimateInterface* _estimator,
+          const geometry_msgs::PoseStamped& _start,
+          const geometry_msgs::PoseStamped& _goal, const double _tolerance,
+          std::vector<geometry_msgs::PoseStamped>& _plan, double& _cost,
+          std::string& _message, bool _cost_only) {
+  if (_cost_only) {
+    if (_estimator) {
+      _plan.clear();
+      return _estimator->estimateCost(_start, _goal, _cost) ? MBF_SUCCESS
+                                                           : MBF_FAILURE;
+    }
+  }
+
+  if (_planner)
+    return _planner->makePlan(_start, _goal, _tolerance, _plan, _cost,
+                              _message);
+  return _plugin.makePlan(_start, _goal, _plan, _cost) ? MBF_SUCCESS
+                                                       : MBF_FAILURE;
+}
+
+bool
+GlobalPlannerPipeline::globalPlanning(const Pose& _start, const Pose& _goal,
+                                      const double _tolerance, Path& _plan,
+                                      double& _cost, uint32_t& _outcome,
+                                      std::string& _message,
+                                      const bool _cost_only,
+                                      const bool _consumers_only) {
+  _outcome = MBF_FAILURE;
+  const auto streaming = !_cost_only && isStreaming();
+  prefix_sinks_[0].held.clear();
+  auto other = [&](const PluginParameter& _param) {
+    return _consumers_only && !readsSnapshot(_param);
+  };
+
+  if (race_pool_) {
+    // every planner writes into its own buffer
+    auto planning = [&](BaseGlobalPlanner& _plugin, size_t _ii) {
+      if (streaming)
+        _setPrefixSink(_plugin, nullptr);
+      race_plans_[_ii].clear();
+      race_messages_[_ii].clear();
+      const auto& mixins = getMixins(global_planning_.getPlugins()[_ii].first);
+      return _makePlan(_plugin, mixins.planner, mixins.estimator, _start,
+                       _goal, _tolerance, race_plans_[_ii], race_costs_[_ii],
+                       race_messages_[_ii], _cost_only) == MBF_SUCCESS;
+    };
+
+    size_t winner;
+    const auto result = racePlugins(global_planning_, planning, cancel_,
+                                    *race_pool_, race_state_, winner, other);
+
+    // swap, so we keep the allocated memory for the next run
+    if (winner < race_plans_.size()) {
+      _plan.swap(race_plans_[winner]);
+      _cost = race_costs_[winner];
+      _message.swap(race_messages_[winner]);
+    }
+    if (result)
+      _outcome = MBF_SUCCESS;
+    return result;
+  }
+
+  // coarse_to_fine: the first planner searches the downsampled snapshot. it
+  // is rebuilt only if the snapshot's content or window changed
+  bool first = true;
+  if (coarse_factor_ > 1 && current_snapshot_) {
+    const auto revision =
+        revision_layer_ ? costmapRevision(*current_snapshot_, snapshot_stamp_)
+                        : costmapRevision(*current_snapshot_);
+    if (!coarse_valid_ || revision != coarse_revision_) {
+      coarse_.downsample(*current_snapshot_, coarse_factor_);
+      coarse_revision_ = revision;
+      coarse_valid_ = true;
+    }
+  }
+
+  // run all global planners... typically only one should be loaded.
+  bool seeded = false;
+  auto planning = [&](BaseGlobalPlanner& _plugin,
+                      const PluginParameter& _param) {
+    if (streaming)
+      _setPrefixSink(_plugin, &_param == planning_stream_ ? &prefix_sinks_[0]
+                                                          : nullptr);
+
+    // pass the output of the preceding planner
+    const auto& mixins = getMixins(_param);
+    auto seed = mixins.seed;
+    if (seed) {
+      seed_plan_.clear();
+      if (seeded)
+        seed_plan_.swap(_plan);
+      seed->setSeed(seed_plan_, _cost);
+    }
+
+    CostmapSnapshotInterface* coarse = nullptr;
+    if (first && coarse_factor_ > 1 && current_snapshot_) {
+      coarse = mixins.snapshot;
+      if (coarse)
+        coarse->setSnapshot(coarse_);
+    }
+    first = false;
+
+    // expose the planner, so cancel() can reach it
+    {
+      std::lock_guard<std::mutex> lock(active_mutex_);
+      active_planner_ = &_plugin;
+    }
+    _outcome = _makePlan(_plugin, mixins.planner, mixins.estimator, _start,
+                         _goal, _tolerance, _plan, _cost, _message, _cost_only);
+    {
+      std::lock_guard<std::mutex> lock(active_mutex_);
+      active_planner_ = nullptr;
+    }
+
+    // the other plugins keep working on the full snapshot
+    if (coarse)
+      coarse->setSnapshot(*current_snapshot_);
+    seeded = _outcome == MBF_SUCCESS;
+    return seeded;
+  };
+  global_planning_.setContext(_distance(_start, _goal));
+  const auto result = runPlugins(global_planning_, planning, cancel_,
+                                 &watchdogs_[1], other);
+
+  // keep the outcome of the last failing planner. the group may also fail
+  // without one (e.x. due to its default value or its time budget)
+  if (result)
+    _outcome = MBF_SUCCESS;
+  else if (_outcome == MBF_SUCCESS)
+    _outcome = MBF_FAILURE;
+  return result;
+}
+
+bool
+GlobalPlannerPipeline::readsSnapshot(const PluginParameter& _param) const {
+  // the lazy planners are checked once they are loaded
+  for (const auto& plugin : global_planning_.getPlugins())
+    if (&plugin.first == &_param)
+      return !plugin.second ||
+             _asMixin<CostmapSnapshotInterface>(*plugin.second);
+  return false;
+}
+
+bool
+GlobalPlannerPipeline::readsOnlySnapshot() const {
+  // the lazy plugins are checked once they are loaded
+  auto reads = [](const auto& _grp) {
+    for (const auto& plugin : _grp.getPlugins())
+      if (plugin.second &&
+          !_asMixin<CostmapSnapshotInterface>(*plugin.second))
+        return false;
+    return true;
+  };
+  return reads(global_planning_) && reads(post_planning_);
+}
+
+bool
+GlobalPlannerPipeline::makePlan(const Pose& _start, const Pose& _goal,
+                                Path& _plan) {
+  double cost;
+  return makePlan(_start, _goal, _plan, cost);
+}
+
+bool
+GlobalPlannerPipeline::makePlan(const Pose& _start, const Pose& _goal,
+                                Path& _plan, double& _cost) {
+  std::string message;
+  // clang-format off
+  return makePlan(_start, _goal, tolerance_, _plan, _cost, message) == MBF_SUCCESS;
+  // clang-format on
+}
+
+uint32_t
+GlobalPlannerPipeline::makePlan(const Pose& _start, const Pose& _goal,
+                                const double _tolerance, Path& _plan,
+                                double& _cost, std::string& _message) {
+  // the span includes the waiting for the pipeline
+  TraceSpan span("pipeline", "makePlan");
+
+  // concurrent mode: an idle worker serves the request, if we are busy. it
+  // must not read the live map, which another pre-planning may alter
+  auto plan_lock = lockPipeline(concurrent_);
+  if (!plan_lock.front().owns_lock()) {
+    auto worker = borrowWorker();
+    if (worker && !worker->readsOnlySnapshot()) {
+      returnWorkers({worker});
+      worker = nullptr;
+    }
+    if (worker) {
+      uint32_t outcome;
+      try {
+        outcome =
+            worker->makePlan(_start, _goal, _tolerance, _plan, _cost, _message);
+      }
+      catch (...) {
+        returnWorkers({worker});
+        throw;
+      }
+      returnWorkers({worker});
+      finishTrace(span);
+      return outcome;
+    }
+    plan_lock = lockPipeline();
+  }
+
+  {
+    // reset cancel flag
+    std::lock_guard<std::mutex> async_lock(async_mutex_);
+    cancel_ = false;
+    busy_ = true;
+  }
+
+  const auto outcome =
+      runPipeline(_start, _goal, _tolerance, _plan, _cost, _message);
+  finishTrace(span);
+
+  std::lock_guard<std::mutex> async_lock(async_mutex_);
+  busy_ = false;
+  return outcome;
+}
+
+uint32_t
+GlobalPlannerPipeline::runPipeline(const Pose& _start, const Pose& _goal,
+                                   const double _tolerance, Path& _plan,
+                                   double& _cost, std::string& _message) {
+  // local copies since we might alter the poses
+  PlanJob job;
+  job.start = _start;
+  job.goal = _goal;
+  job.tolerance = _tolerance;
+  job.trace = newTraceRequest();
+  // plan into the pooled buffer: the caller's path may be a new one
+  job.result.plan.swap(plan_buffer_);
+
+  if (runPreStage(job) && runPlanningStage(job, snapshot_, full_snapshot_))
+    runPostStage(job);
+
+  // hand the result over without a copy and pool the caller's old buffer:
+  // a caller, which reuses its path, swaps the same two buffers back and forth
+  _plan.swap(job.result.plan);
+  plan_buffer_.swap(job.result.plan);
+  trimBuffers();
+  _cost = job.result.cost;
+  _message.swap(job.result.message);
+  return job.result.outcome;
+}
+
+/// @brief frees the _path, if its buffer exceeds _memory bytes
+inline void
+_trim(std::vector<geometry_msgs::PoseStamped>& _path, const size_t _memory) {
+  if (_path.capacity() * sizeof(geometry_msgs::PoseStamped) > _memory)
+    std::vector<geometry_msgs::PoseStamped>().swap(_path);
+}
+
+void
+GlobalPlannerPipeline::trimBuffers() {
+  // a single large request must not inflate the footprint for good
+  _trim(plan_buffer_, scratch_memory_);
+  _trim(seed_plan_, scratch_memory_);
+  for (auto& plan : race_plans_)
+    _trim(plan, scratch_memory_);
+}
+
+bool
+GlobalPlannerPipeline::runPreStage(PlanJob& _job) {
+  setTraceRequest(_job.trace);
+  TraceSpan span("stage", "pre_planning");
+  scratch_[0].reset(scratch_memory_);
+  // the cache is our first stage: on a hit we don't run any plugin
+  auto& result = _job.result;
+  if (cache_) {
+    _job.key = cache_->makeKey(_job.start, _job.goal, _job.tolerance,
+                               _getRevision(*costmap_, revision_layer_));
+    if (cache_->find(_job.key, result.plan, result.cost)) {
+      if (isStreaming())
+        forwardPrefix(result.plan);
+      result.outcome = MBF_SUCCESS;
+      return false;
+    }
+  }
+
+  // a leg planned ahead: no plugin is called as well
+  if (useSpeculation(_job.start, _job.goal, result.plan, result.cost)) {
+    if (isStreaming())
+      forwardPrefix(result.plan);
+    result.outcome = MBF_SUCCESS;
+    return false;
+  }
+  result.plan.clear();
+
+  // a leg planned ahead skips the pre-planning: it may alter the live map,
+  // on which the robot plans meanwhile
+  if (speculating_)
+    return true;
+
+  // the pre-planning works on the live map (see takeSnapshot)
+  distance_views_[0].setMap(*costmap_->getCostmap());
+
+  uint32_t outcome;
+  if (!prePlanning(_job.start, _job.goal, _job.tolerance, outcome,
+                   result.message)) {
+    // a failure due to cancelling is reported as such
+    result.outcome = cancel_ ? MBF_CANCELED : outcome;
+    return false;
+  }
+  return true;
+}
+
+bool
+GlobalPlannerPipeline::runPlanningStage(
+    PlanJob& _job, CostmapSnapshot& _snapshot,
+    std::unique_ptr<CostmapSnapshot>& _full) {
+  // the pre-planning may alter the map: take the snapshot afterwards
+  setTraceRequest(_job.trace);
+  TraceSpan span("stage", "planning");
+  scratch_[1].reset(scratch_memory_);
+  auto& result = _job.result;
+  size_t attempt = 0;
+
+  // the last path may leave the region of interest: the replanning checks it
+  // on the full map
+  const auto replan = canReplan(_job.goal);
+  bool cropped = takeSnapshot(_job, attempt, !replan, _snapshot);
+  _job.snapshot = current_snapshot_;
+
+  // replanning: skip the planning if the last path is still good
+  if (replan) {
+    if (replanning(_job.start, _job.goal, result.plan, result.cost)) {
+      _job.replanned = true;
+      return true;
+    }
+    if (roi_) {
+      cropped = takeSnapshot(_job, attempt, true, _snapshot);
+      _job.snapshot = current_snapshot_;
+    }
+  }
+
+  // planning: forward the outcome of the planner. on a cropped snapshot we
+  // retry with a larger region of interest - but only the planners reading
+  // the snapshot, since the others would just repeat their result
+  uint32_t outcome;
+  while (!globalPlanning(_job.start, _job.goal, _job.tolerance, result.plan,
+                         result.cost, outcome, result.message, false,
+                         attempt != 0)) {
+    const auto& planners = global_planning_.getPlugins();
+    const auto consumed = std::any_of(
+        planners.begin(), planners.end(),
+        [this](const GlobalPlannerManager::NamedPlugin& _plugin) {
+          return readsSnapshot(_plugin.first);
+        });
+    if (cancel_ || !cropped || !consumed) {
+      result.outcome = cancel_ ? MBF_CANCELED : outcome;
+      return false;
+    }
+    GPP_HOT_DEBUG("[gpp]: growing the region of interest");
+    result.plan.clear();
+    cropped = takeSnapshot(_job, ++attempt, true, _snapshot);
+    _job.snapshot = current_snapshot_;
+  }
+
+  // the post-planning sees the full map
+  if (cropped && (post_consumed_ || lazy_readers_)) {
+    if (!_full)
+      _full.reset(new CostmapSnapshot);
+    _full->update(*costmap_->getCostmap());
+    _job.snapshot = _full.get();
+  }
+
+  // the held prefix waits for the post-planning of the job
+  _job.prefix.swap(prefix_sinks_[0].held);
+  return true;
+}
+
+void
+GlobalPlannerPipeline::runPostStage(PlanJob& _job) {
+  setTraceRequest(_job.trace);
+  TraceSpan span("stage", "post_planning");
+  scratch_[2].reset(scratch_memory_);
+  auto& result = _job.result;
+  if (!_job.replanned) {
+    sharePostSnapshot(_job.snapshot);
+    if (!postPlanning(result.plan, result.cost)) {
+      result.outcome = cancel_ ? MBF_CANCELED : MBF_FAILURE;
+      return;
+    }
+
+    // the validators accepted the path: release the held prefix
+    if (!prefix_sinks_[1].held.empty())
+      _job.prefix.swap(prefix_sinks_[1].held);
+    if (!_job.prefix.empty())
+      forwardPrefix(_job.prefix);
+
+    if (cache_)
+      cache_->insert(_job.key, result.plan, result.cost);
+  }
+
+  // remember the output, if someone can reuse it. a reused path is still
+  // stored - we don't have to copy it again. the copy-assignment keeps the
+  // capacity of the last path
+  if (!_job.replanned && !replanning_.getPlugins().empty()) {
+    std::lock_guard<std::mutex> lock(last_plan_mutex_);
+    last_plan_ = result.plan;
+    last_cost_ = result.cost;
+    last_goal_ = _job.goal;
+  }
+
+  result.outcome = MBF_SUCCESS;
+}
+
+bool
+GlobalPlannerPipeline::takeSnapshot(const PlanJob& _job,
+                                    const size_t _attempt, const bool _crop,
+                                    CostmapSnapshot& _snapshot) {
+  current_snapshot_ = nullptr;
+  if (snapshot_consumers_.empty() && !post_consumed_ && !lazy_readers_) {
+    distance_views_[1].setMap(*costmap_->getCostmap());
+    return false;
+  }
+
+  // one lock and one copy for all consumers. the stamp is read before the
+  // copy: a change meanwhile gives the next snapshot a new stamp
+  const auto stamp = revision_layer_ ? revision_layer_->getRevision() : 0;
+  bool cropped = false;
+  gpp_interface::RegionOfInterestInterface::Window window;
+  // the region of interest is defined by the pre-planning: a leg planned
+  // ahead sees the full map
+  const auto roi = _crop && !speculating_ ? roi_.load() : nullptr;
+  if (roi && roi->getRegionOfInterest(_job.start, _job.goal, _job.tolerance,
+                                      _attempt, window))
+    cropped = _snapshot.update(*costmap_->getCostmap(), window.min_x,
+                               window.min_y, window.max_x, window.max_y);
+  else
+    _snapshot.update(*costmap_->getCostmap());
+
+  // the view of the planning stage: the pre-planning of the next request
+  // keeps its own view on the live map
+  distance_views_[1].setSnapshot(_snapshot);
+  shareSnapshot(_snapshot, stamp);
+  return cropped;
+}
+
+void
+GlobalPlannerPipeline::shareSnapshot(const costmap_2d::Costmap2D& _snapshot,
+                                     const uint64_t _stamp) {
+  current_snapshot_ = &_snapshot;
+  snapshot_stamp_ = _stamp;
+  for (auto consumer : snapshot_consumers_)
+    consumer->setSnapshot(_snapshot);
+}
+
+void
+GlobalPlannerPipeline::sharePostSnapshot(
+    const costmap_2d::Costmap2D* _snapshot) {
+  current_post_snapshot_ = _snapshot;
+  // the view of the post-planning stage follows its job's map
+  if (!_snapshot) {
+    distance_views_[2].setMap(*costmap_->getCostmap());
+    return;
+  }
+
+  distance_views_[2].setSnapshot(*_snapshot);
+  for (auto consumer : post_snapshot_consumers_)
+    consumer->setSnapshot(*_snapshot);
+}
+
+void
+GlobalPlannerPipeline::addSnapshotConsumer(
+    gpp_interface::CostmapSnapshotInterface* _consumer) {
+  if (!_consumer)
+    return;
+
+  snapshot_consumers_.push_back(_consumer);
+  // the stage of a lazy plugin took the snapshot already (see takeSnapshot):
+  // we don't copy the map in the middle of a request
+  if (current_snapshot_)
+    _consumer->setSnapshot(*current_snapshot_);
+}
+
+void
+GlobalPlannerPipeline::addPostSnapshotConsumer(
+    gpp_interface::CostmapSnapshotInterface* _consumer) {
+  if (!_consumer)
+    return;
+
+  post_snapshot_consumers_.push_back(_consumer);
+  post_consumed_ = true;
+  // the job carries the snapshot already (see takeSnapshot)
+  if (current_post_snapshot_)
+    _consumer->setSnapshot(*current_post_snapshot_);
+}
+
+bool
+GlobalPlannerPipeline::cancel() {
+  GPP_INFO("cancelling");
+  // the generation first: the pipelined stages compare it (see runStage)
+  ++cancel_generation_;
+  cancelRun();
+
+  // the legs planned ahead have their own cancellation (see speculate)
+  for (const auto& worker : batch_workers_)
+    if (!worker->speculating_)
+      worker->cancel();
+  return true;
+}
+
+void
+GlobalPlannerPipeline::cancelRun() {
+  cancel_ = true;
+  // wake up a waiting race
+  race_state_.notify();
+  // forward the request to the running planner
+  std::lock_guard<std::mutex> lock(active_mutex_);
+  if (active_planner_)
+    _cancelPlugin(*active_planner_);
+}
+
+uint32_t
+GlobalPlannerPipeline::runQuery(const PlanQuery& _query, const uint64_t _trace,
+                                const double _tolerance, const bool _cost_only,
+                                Path& _plan, double& _cost,
+                                std::string& _message) {
+  // local copies since we might alter the poses
+  Pose start = _query.start;
+  Pose goal = _query.goal;
+  _plan.clear();
+  setTraceRequest(_trace);
+  TraceSpan span("pipeline", "query");
+  for (auto& scratch : scratch_)
+    scratch.reset(scratch_memory_);
+
+  const auto failure = [this](uint32_t _outcome) {
+    return cancel_ ? MBF_CANCELED : _outcome;
+  };
+
+  uint32_t outcome;
+  if (!globalPlanning(start, goal, _tolerance, _plan, _cost, outcome, _message,
+                      _cost_only))
+    return failure(outcome);
+
+  if (!postPlanning(_plan, _cost, _cost_only))
+    return failure(MBF_FAILURE);
+
+  // the validators accepted the path: release the held prefix
+  const auto& held = prefix_sinks_[1].held.empty() ? prefix_sinks_[0].held
+                                                   : prefix_sinks_[1].held;
+  if (!_cost_only && !held.empty())
+    forwardPrefix(held);
+
+  // the caller does not want the path
+  if (_cost_only)
+    _plan.clear();
+  return MBF_SUCCESS;
+}
+
+uint32_t
+GlobalPlannerPipeline::makeCost(const Pose& _start, const Pose& _goal,
+                                const double _tolerance, double& _cost,
+                                std::string& _message) {
+  auto results = runBatch({PlanQuery{_start, _goal}}, _tolerance, true);
+  _cost = results.front().cost;
+  _message = std::move(results.front().message);
+  return results.front().outcome;
+}
+
+std::vector<GlobalPlannerPipeline::PlanResult>
+GlobalPlannerPipeline::makeCosts(const std::vector<PlanQuery>& _queries,
+                                 const double _tolerance) {
+  return runBatch(_queries, _tolerance, true);
+}
+
+std::vector<GlobalPlannerPipeline::PlanResult>
+GlobalPlannerPipeline::makePlans(const std::vector<PlanQuery>& _queries) {
+  return runBatch(_queries, tolerance_, false);
+}
+
+std::vector<GlobalPlannerPipeline::PlanResult>
+GlobalPlannerPipeline::makePlans(const std::vector<PlanQuery>& _queries,
+                                 const double _tolerance) {
+  return runBatch(_queries, _tolerance, false);
+}
+
+std::vector<GlobalPlannerPipeline::PlanResult>
+GlobalPlannerPipeline::runBatch(const std::vector<PlanQuery>& _queries,
+                                const double _tolerance,
+                                const bool _cost_only) {
+  std::vector<PlanResult> results(_queries.size());
+  const auto plan_lock = lockPipeline();
+  {
+    // reset cancel flag
+    std::lock_guard<std::mutex> async_lock(async_mutex_);
+    cancel_ = false;
+    busy_ = true;
+  }
+  // the workers serving concurrent requests don't join the batch
+  const auto workers = borrowWorkers(false);
+  for (const auto worker : workers)
+    worker->cancel_ = false;
+
+  // the cache: one revision for all queries
+  std::vector<PlanCacheKey> keys;
+  std::vector<size_t> todo;
+  todo.reserve(_queries.size());
+  if (cache_) {
+    const auto revision = _getRevision(*costmap_, revision_layer_);
+    keys.reserve(_queries.size());
+    for (size_t ii = 0; ii != _queries.size(); ++ii) {
+      const auto& query = _queries[ii];
+      auto& result = results[ii];
+      keys.emplace_back(
+          cache_->makeKey(query.start, query.goal, _tolerance, revision));
+      // in the cost-only mode we don't copy the path
+      const auto hit =
+          _cost_only ? cache_->findCost(keys.back(), result.cost)
+                     : cache_->find(keys.back(), result.plan, result.cost);
+      if (hit)
+        result.outcome = MBF_SUCCESS;
+      else
+        todo.emplace_back(ii);
+    }
+  }
+  else {
+    for (size_t ii = 0; ii != _queries.size(); ++ii)
+      todo.emplace_back(ii);
+  }
+
+  // the pre-planning may alter the live map: it runs on the calling thread,
+  // before the snapshot is taken
+  std::vector<PlanQuery> queries;
+  std::vector<uint64_t> traces;
+  queries.reserve(todo.size());
+  traces.reserve(todo.size());
+  distance_views_[0].setMap(*costmap_->getCostmap());
+  size_t kept = 0;
+  for (const auto ii : todo) {
+    auto query = _queries[ii];
+    auto& result = results[ii];
+    traces.emplace_back(newTraceRequest());
+    setTraceRequest(traces.back());
+    TraceSpan span("stage", "pre_planning");
+    scratch_[0].reset(scratch_memory_);
+    uint32_t outcome;
+    if (!prePlanning(query.start, query.goal, _tolerance, outcome,
+                     result.message)) {
+      result.outcome = cancel_ ? MBF_CANCELED : outcome;
+      traces.pop_back();
+      continue;
+    }
+    todo[kept++] = ii;
+    queries.emplace_back(std::move(query));
+  }
+  todo.resize(kept);
+
+  // the workers must not touch the live map: only the ones reading nothing
+  // but the snapshot join
+  std::vector<GlobalPlannerPipeline*> helpers;
+  for (const auto worker : workers)
+    if (worker->readsOnlySnapshot())
+      helpers.emplace_back(worker);
+
+  // the snapshot: one copy for all queries and workers
+  if (!todo.empty()) {
+    const bool consumed = !helpers.empty() || lazy_readers_ ||
+                          !snapshot_consumers_.empty() ||
+                          !post_snapshot_consumers_.empty();
+    const auto stamp = revision_layer_ ? revision_layer_->getRevision() : 0;
+    if (consumed)
+      snapshot_.update(*costmap_->getCostmap());
+
+    auto share = [&](GlobalPlannerPipeline& _pipeline) {
+      for (auto& view : _pipeline.distance_views_) {
+        if (consumed)
+          view.setSnapshot(snapshot_);
+        else
+          view.setMap(*costmap_->getCostmap());
+      }
+      if (consumed) {
+        _pipeline.shareSnapshot(snapshot_, stamp);
+        _pipeline.sharePostSnapshot(&snapshot_);
+      }
+      else {
+        _pipeline.current_snapshot_ = nullptr;
+        _pipeline.current_post_snapshot_ = nullptr;
+      }
+    };
+    share(*this);
+    for (const auto worker : helpers)
+      share(*worker);
+  }
+
+  // every worker pulls the next query, until all are done
+  std::atomic_size_t next{0};
+  auto work = [&](GlobalPlannerPipeline& _worker) {
+    for (size_t ii = next++; ii < todo.size(); ii = next++) {
+      auto& result = results[todo[ii]];
+      // an exception must not escape, since we have to join all workers
+      try {
+        result.outcome =
+            _worker.runQuery(queries[ii], traces[ii], _tolerance, _cost_only,
+                             result.plan, result.cost, result.message);
+      }
+      catch (std::exception& _ex) {
+        result.outcome = MBF_FAILURE;
+        result.message = _ex.what();
+      }
+    }
+  };
+
+  std::vector<std::future<void>> jobs;
+  jobs.reserve(helpers.size());
+  for (const auto worker : helpers) {
+    auto& impl = *worker;
+    jobs.emplace_back(batch_pool_->submit([&work, &impl]() { work(impl); }));
+  }
+  work(*this);
+  for (auto& job : jobs)
+    job.wait();
+  returnWorkers(workers);
+
+  // the cost-only results have no path and some costs may be estimates
+  if (cache_ && !_cost_only) {
+    for (const auto ii : todo)
+      if (results[ii].outcome == MBF_SUCCESS)
+        cache_->insert(keys[ii], results[ii].plan, results[ii].cost);
+  }
+
+  std::lock_guard<std::mutex> async_lock(async_mutex_);
+  busy_ = false;
+  return results;
+}
+
+GlobalPlannerPipeline::~GlobalPlannerPipeline() {
+  // the timer and the services read the groups and the trace, which are
+  // destroyed before them
+  diagnostics_timer_.stop();
+  reload_srv_.shutdown();
+  trace_srv_.shutdown();
+
+  // the speculation uses the workers: stop it first
+  if (speculation_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(speculation_mutex_);
+      speculation_stop_ = true;
+      if (speculation_worker_)
+        speculation_worker_->cancel();
+    }
+    {
+      // don't miss the thread waiting for a worker
+      std::lock_guard<std::mutex> lock(workers_mutex_);
+    }
+    speculation_cv_.notify_all();
+    workers_cv_.notify_all();
+    cancel();
+    speculation_thread_.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    stop_ = true;
+    if (busy_ || stages_.front().thread.joinable())
+      cancel();
+  }
+  async_cv_.notify_all();
+  if (async_worker_.joinable())
+    async_worker_.join();
+  for (auto& stage : stages_)
+    if (stage.thread.joinable())
+      stage.thread.join();
+
+  // the plugins don't record into the ring anymore
+  stopTraceDumps();
+  if (trace_ && getTraceRing() == trace_.get())
+    setTraceRing(nullptr);
+}
+
+GlobalPlannerPipeline::PipelineLock
+GlobalPlannerPipeline::lockPipeline(const bool _try) {
+  // in the pipelined mode the stages run without the plan_mutex_
+  PipelineLock lock{{{plan_mutex_, std::defer_lock},
+                     {stages_[0].mutex, std::defer_lock},
+                     {stages_[1].mutex, std::defer_lock},
+                     {stages_[2].mutex, std::defer_lock}}};
+  if (_try)
+    std::try_lock(lock[0], lock[1], lock[2], lock[3]);
+  else
+    std::lock(lock[0], lock[1], lock[2], lock[3]);
+  return lock;
+}
+
+GlobalPlannerPipeline*
+GlobalPlannerPipeline::borrowWorker() {
+  std::lock_guard<std::mutex> lock(workers_mutex_);
+  if (idle_workers_.empty())
+    return nullptr;
+
+  const auto worker = idle_workers_.back();
+  idle_workers_.pop_back();
+  return worker;
+}
+
+std::vector<GlobalPlannerPipeline*>
+GlobalPlannerPipeline::borrowWorkers(const bool _all) {
+  std::unique_lock<std::mutex> lock(workers_mutex_);
+  if (_all) {
+    workers_cv_.wait(lock, [this]() {
+      return idle_workers_.size() == batch_workers_.size();
+    });
+  }
+  std::vector<GlobalPlannerPipeline*> workers;
+  workers.swap(idle_workers_);
+  return workers;
+}
+
+void
+GlobalPlannerPipeline::returnWorkers(
+    const std::vector<GlobalPlannerPipeline*>& _workers) {
+  {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    idle_workers_.insert(idle_workers_.end(), _workers.begin(),
+                         _workers.end());
+  }
+  workers_cv_.notify_all();
+}
+
+/// @brief marks the _request as cancelled
+inline void
+_cancelRequest(std::promise<GlobalPlannerPipeline::PlanResult>& _promise) {
+  GlobalPlannerPipeline::PlanResult result;
+  result.outcome = MBF_CANCELED;
+  result.message = "preempted";
+  _promise.set_value(std::move(result));
+}
+
+void
+GlobalPlannerPipeline::configureWorker(GlobalPlannerPipeline& _worker) const {
+  // the workers serving concurrent requests use the same cache and stream to
+  // the same receivers
+  _worker.cache_ = cache_;
+  _worker.revision_layer_ = revision_layer_;
+  _worker.pre_planning_mutex_ = pre_planning_mutex_;
+  _worker.prefix_callback_ = prefix_callback_;
+  _worker.publish_prefix_ = publish_prefix_;
+  _worker.prefix_pub_ = prefix_pub_;
+  _worker.speculation_distance_ = speculation_distance_;
+  _worker.speculation_lethal_ = speculation_lethal_;
+}
+
+void
+GlobalPlannerPipeline::setPrefixCallback(PrefixCallback _callback) {
+  prefix_callback_ = std::move(_callback);
+  for (const auto& worker : batch_workers_)
+    worker->prefix_callback_ = prefix_callback_;
+}
+
+void
+GlobalPlannerPipeline::forwardPrefix(const Path& _prefix) {
+  if (prefix_callback_)
+    prefix_callback_(_prefix);
+
+  if (publish_prefix_ && !_prefix.empty()) {
+    nav_msgs::Path msg;
+    msg.header = _prefix.front().header;
+    msg.poses = _prefix;
+    prefix_pub_.publish(msg);
+  }
+}
+
+void
+GlobalPlannerPipeline::PrefixForwarder::onPrefix(const Path& _prefix) {
+  // the assignment keeps the capacity of the last prefix
+  if (hold)
+    held = _prefix;
+  else
+    pipeline_.forwardPrefix(_prefix);
+}
+
+std::future<GlobalPlannerPipeline::PlanResult>
+GlobalPlannerPipeline::makePlanAsync(const Pose& _start, const Pose& _goal) {
+  return makePlanAsync(_start, _goal, tolerance_);
+}
+
+std::future<GlobalPlannerPipeline::PlanResult>
+GlobalPlannerPipeline::makePlanAsync(const Pose& _start, const Pose& _goal,
+                                     double _tolerance) {
+  if (pipelined_) {
+    std::unique_ptr<PlanJob> job(new PlanJob);
+    job->start = _start;
+    job->goal = _goal;
+    job->tolerance = _tolerance;
+    job->trace = newTraceRequest();
+    job->promise.reset(new std::promise<PlanResult>);
+    auto future = job->promise->get_future();
+
+    {
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      // start the stages with the first request
+      for (size_t ii = 0; ii != stages_.size(); ++ii)
+        if (!stages_[ii].thread.joinable())
+          stages_[ii].thread =
+              std::thread(&GlobalPlannerPipeline::runStage, this, ii);
+
+      // the running stages continue. we just drop the queued request
+      auto& queued = stages_.front().queued;
+      if (queued)
+        _cancelRequest(*queued->promise);
+      job->generation = cancel_generation_;
+      queued = std::move(job);
+    }
+    async_cv_.notify_all();
+    return future;
+  }
+
+  std::unique_ptr<AsyncRequest> request(new AsyncRequest);
+  request->start = _start;
+  request->goal = _goal;
+  request->tolerance = _tolerance;
+  auto future = request->promise.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    // start the worker with the first request
+    if (!async_worker_.joinable())
+      async_worker_ = std::thread(&GlobalPlannerPipeline::runAsync, this);
+
+    // preempt the older async requests - a blocking makePlan keeps running
+    if (pending_)
+      _cancelRequest(pending_->promise);
+    if (async_busy_)
+      cancelRun();
+
+    pending_ = std::move(request);
+  }
+  async_cv_.notify_one();
+  return future;
+}
+
+void
+GlobalPlannerPipeline::runAsync() {
+  while (true) {
+    std::unique_ptr<AsyncRequest> request;
+    {
+      std::unique_lock<std::mutex> lock(async_mutex_);
+      async_cv_.wait(lock, [this]() { return stop_ || pending_; });
+      if (stop_) {
+        if (pending_)
+          _cancelRequest(pending_->promise);
+        return;
+      }
+      request = std::move(pending_);
+    }
+
+    const auto plan_lock = lockPipeline();
+    {
+      // a newer request might have arrived while we were waiting
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      if (pending_ || stop_) {
+        _cancelRequest(request->promise);
+        continue;
+      }
+      cancel_ = false;
+      busy_ = true;
+      async_busy_ = true;
+    }
+
+    PlanResult result;
+    result.outcome =
+        runPipeline(request->start, request->goal, request->tolerance,
+                    result.plan, result.cost, result.message);
+    {
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      busy_ = false;
+      async_busy_ = false;
+    }
+    request->promise.set_value(std::move(result));
+  }
+}
+
+void
+GlobalPlannerPipeline::finishJob(PlanJob& _job) {
+  if (_job.buffer)
+    snapshot_pool_.emplace_back(std::move(_job.buffer));
+  if (_job.full_buffer)
+    snapshot_pool_.emplace_back(std::move(_job.full_buffer));
+  _job.promise->set_value(std::move(_job.result));
+}
+
+void
+GlobalPlannerPipeline::runStage(const size_t _stage) {
+  auto& stage = stages_[_stage];
+  auto drop = [this](PlanJob& _job) {
+    _job.result.outcome = MBF_CANCELED;
+    _job.result.message = "preempted";
+    finishJob(_job);
+  };
+
+  while (true) {
+    std::unique_ptr<PlanJob> job;
+    {
+      std::unique_lock<std::mutex> lock(async_mutex_);
+      async_cv_.wait(lock, [&]() { return stop_ || stage.queued; });
+      if (stop_) {
+        if (stage.queued)
+          drop(*stage.queued);
+        return;
+      }
+      job = std::move(stage.queued);
+    }
+
+    // a synchronous call blocks all stages (see lockPipeline)
+    std::unique_lock<std::mutex> stage_lock(stage.mutex);
+    {
+      std::unique_lock<std::mutex> lock(async_mutex_);
+      // a cancel drains the pipeline: the first stage waits for the others
+      // to finish their (cancelled) jobs, before it resets the flag
+      if (_stage == 0 && cancel_ && job->generation == cancel_generation_) {
+        async_cv_.wait(lock, [this]() {
+          return stop_ || (!stages_[1].busy && !stages_[2].busy);
+        });
+        cancel_ = false;
+      }
+
+      // the job was submitted before the last cancel
+      if (stop_ || job->generation != cancel_generation_) {
+        drop(*job);
+        continue;
+      }
+
+      if (_stage == 1 && !job->buffer) {
+        if (snapshot_pool_.empty())
+          job->buffer.reset(new CostmapSnapshot);
+        else {
+          job->buffer = std::move(snapshot_pool_.back());
+          snapshot_pool_.pop_back();
+        }
+        // the buffer for the full map is allocated on demand
+        if (roi_ && !snapshot_pool_.empty()) {
+          job->full_buffer = std::move(snapshot_pool_.back());
+          snapshot_pool_.pop_back();
+        }
+      }
+      stage.busy = true;
+    }
+
+    bool next = false;
+    try {
+      if (_stage == 0)
+        next = runPreStage(*job);
+      else if (_stage == 1)
+        next = runPlanningStage(*job, *job->buffer, job->full_buffer);
+      else
+        runPostStage(*job);
+    }
+    catch (std::exception& _ex) {
+      job->result.outcome = MBF_FAILURE;
+      job->result.message = _ex.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      stage.busy = false;
+      if (!next)
+        finishJob(*job);
+      else if (stop_)
+        drop(*job);
+      else {
+        // the newer job makes the queued one stale
+        auto& queued = stages_[_stage + 1].queued;
+        if (queued)
+          drop(*queued);
+        queued = std::move(job);
+      }
+    }
+    async_cv_.notify_all();
+  }
+}
+
+/// @brief returns true, if _start and _goal are consecutive _goals
+inline bool
+_isLeg(const std::vector<geometry_msgs::PoseStamped>& _goals,
+       const geometry_msgs::PoseStamped& _start,
+       const geometry_msgs::PoseStamped& _goal) noexcept {
+  for (size_t ii = 1; ii < _goals.size(); ++ii)
+    if (_isEqual(_start, _goals[ii - 1]) && _isEqual(_goal, _goals[ii]))
+      return true;
+  return false;
+}
+
+void
+GlobalPlannerPipeline::speculate(const std::vector<Pose>& _goals) {
+  if (batch_workers_.empty()) {
+    GPP_WARN("no batch workers: cannot plan ahead");
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(speculation_mutex_);
+    ++speculation_generation_;
+    speculation_goals_ = _goals;
+    speculation_pending_ = true;
+
+    // keep only the legs, which are still ahead
+    auto stale = [&](const Speculation& _leg) {
+      return !_isLeg(_goals, _leg.start, _leg.goal);
+    };
+    speculations_.erase(
+        std::remove_if(speculations_.begin(), speculations_.end(), stale),
+        speculations_.end());
+    // the running leg as well
+    if (speculation_worker_ &&
+        !_isLeg(_goals, speculation_start_, speculation_goal_))
+      speculation_worker_->cancel();
+
+    if (!speculation_thread_.joinable())
+      speculation_thread_ =
+          std::thread(&GlobalPlannerPipeline::runSpeculation, this);
+  }
+  speculation_cv_.notify_all();
+}
+
+void
+GlobalPlannerPipeline::runSpeculation() {
+  std::unique_lock<std::mutex> lock(speculation_mutex_);
+  while (true) {
+    speculation_cv_.wait(
+        lock, [this]() { return speculation_stop_ || speculation_pending_; });
+    if (speculation_stop_)
+      return;
+
+    speculation_pending_ = false;
+    const auto goals = speculation_goals_;
+    const auto generation = speculation_generation_;
+    for (size_t ii = 1; ii < goals.size(); ++ii) {
+      // the leg may be known from an older call
+      auto known = [&](const Speculation& _leg) {
+        return _isEqual(_leg.start, goals[ii - 1]) &&
+               _isEqual(_leg.goal, goals[ii]);
+      };
+      if (std::any_of(speculations_.begin(), speculations_.end(), known))
+        continue;
+      lock.unlock();
+
+      // wait for an idle worker - the real requests have the priority
+      GlobalPlannerPipeline* worker = nullptr;
+      {
+        std::unique_lock<std::mutex> workers_lock(workers_mutex_);
+        workers_cv_.wait(workers_lock, [this]() {
+          return speculation_stop_ || !idle_workers_.empty();
+        });
+        if (!speculation_stop_) {
+          worker = idle_workers_.back();
+          idle_workers_.pop_back();
+        }
+      }
+
+      // the worker must not read the live map, which the pre-planning of
+      // the robot's request may alter
+      if (worker && !worker->readsOnlySnapshot()) {
+        GPP_WARN("not all planners read the snapshot: nothing is planned "
+                 "ahead");
+        returnWorkers({worker});
+        worker = nullptr;
+      }
+
+      Speculation leg;
+      leg.start = goals[ii - 1];
+      leg.goal = goals[ii];
+      uint32_t outcome = MBF_FAILURE;
+      if (worker) {
+        std::string message;
+        // the leg is no path of the robot (yet): don't stream it
+        worker->speculating_ = true;
+        {
+          std::lock_guard<std::mutex> running_lock(speculation_mutex_);
+          speculation_worker_ = worker;
+          speculation_start_ = leg.start;
+          speculation_goal_ = leg.goal;
+        }
+        try {
+          outcome = worker->makePlan(leg.start, leg.goal, tolerance_, leg.plan,
+                                     leg.cost, message);
+        }
+        catch (std::exception& _ex) {
+          GPP_WARN("failed to plan ahead: " << _ex.what());
+        }
+        {
+          std::lock_guard<std::mutex> running_lock(speculation_mutex_);
+          speculation_worker_ = nullptr;
+        }
+        worker->speculating_ = false;
+        returnWorkers({worker});
+      }
+
+      lock.lock();
+      if (speculation_stop_)
+        return;
+      // a newer call of speculate may still need the leg
+      if (outcome != MBF_SUCCESS)
+        GPP_WARN("failed to plan the leg " << ii << " ahead");
+      else if (_isLeg(speculation_goals_, leg.start, leg.goal))
+        speculations_.emplace_back(std::move(leg));
+      // the newer call defines the remaining legs
+      if (generation != speculation_generation_)
+        break;
+    }
+  }
+}
+
+bool
+GlobalPlannerPipeline::useSpeculation(const Pose& _start, const Pose& _goal,
+                                      Path& _plan, double& _cost) {
+  std::lock_guard<std::mutex> lock(speculation_mutex_);
+  for (auto leg = speculations_.begin(); leg != speculations_.end(); ++leg) {
+    if (!_isEqual(_goal, leg->goal) || leg->plan.empty())
+      continue;
+
+    // the robot must be close to the leg - it may not have arrived yet
+    const auto closest = ReusePath::findClosest(_start, leg->plan);
+    const auto& p = leg->plan[closest].pose.position;
+    const auto& s = _start.pose.position;
+    if (std::hypot(p.x - s.x, p.y - s.y) > speculation_distance_)
+      continue;
+
+    // the map has changed since the leg was planned
+    bool free;
+    {
+      const auto costmap = costmap_->getCostmap();
+      using mutex_t = costmap_2d::Costmap2D::mutex_t;
+      TraceSpan wait("lock", "costmap");
+      boost::unique_lock<mutex_t> map_lock(*costmap->getMutex());
+      wait.finish();
+      free = ReusePath::isFree(*costmap, leg->plan.cbegin() + closest,
+                               leg->plan.cend(), speculation_lethal_);
+    }
+
+    // a leg serves one request: the replanning takes over afterwards
+    if (free) {
+      GPP_HOT_DEBUG("[gpp]: serving the leg planned ahead");
+      _cost = ReusePath::remainingCost(leg->plan, closest, leg->cost);
+      _plan.assign(leg->plan.begin() + closest, leg->plan.end());
+    }
+    else
+      GPP_HOT_DEBUG("[gpp]: the leg planned ahead is blocked");
+    speculations_.erase(leg);
+    return free;
+  }
+  return false;
 }
 
 }  // namespace gpp_plugin
@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <costmap_2d/costmap_2d.h>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Reusable copy of a costmap.
+ *
+ * The buffer is only reallocated if the size of the source changes, so
+ * taking the snapshot of a map with constant size does not allocate.
+ *
+ * @code{cpp}
+ * CostmapSnapshot snapshot;
+ * // locks the source once and copies it
+ * snapshot.update(*costmap_ros->getCostmap());
+ * // read the snapshot without any locking
+ * snapshot.getCost(0, 0);
+ * @endcode
+ */
+struct CostmapSnapshot : public costmap_2d::Costmap2D {
+  /**
+   * @brief copies the content and the geometry of the _map
+   *
+   * The function locks the _map during the copy.
+   */
+  void
+  update(costmap_2d::Costmap2D& _map);
+
+  /**
+   * @brief copies the cells of the _map within the window
+   *
+   * The window is given in meters and clipped to the _map. The origin of the
+   * snapshot is moved to the lower left corner of the window. The buffer is
+   * reallocated, if the size of the clipped window changes.
+   *
+   * The function locks the _map during the copy.
+   *
+   * @return true, if the clipped window is smaller than the _map
+   */
+  bool
+  update(costmap_2d::Costmap2D& _map, double _min_x, double _min_y,
+         double _max_x, double _max_y);
+
+  /**
+   * @brief builds a map with a _factor times coarser resolution
+   *
+   * Every cell holds the maximum cost of the covered cells of the _source, so
+   * a free coarse cell is free in the _source as well. The buffer is reused as
+   * in update.
+   *
+   * The function does not lock the _source (e.x. another snapshot).
+   */
+  void
+  downsample(const costmap_2d::Costmap2D& _source, unsigned int _factor);
+
+private:
+  /// @brief copies the cells [_x, _x + _size_x) x [_y, _y + _size_y)
+  void
+  copy(costmap_2d::Costmap2D& _map, unsigned int _x, unsigned int _y,
+       unsigned int _size_x, unsigned int _size_y);
+};
+
+}  // namespace gpp_plugin
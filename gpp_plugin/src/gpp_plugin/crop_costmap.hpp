@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <gpp_interface/pre_planning_interface.hpp>
+#include <gpp_interface/region_of_interest_interface.hpp>
+
+#include <string>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Restricts the planning to a box around the start and the goal.
+ *
+ * The plugin implements the gpp_interface::RegionOfInterestInterface: the
+ * pipeline crops the costmap snapshot to the bounding box of the start and
+ * the goal, enlarged by a margin (and the goal tolerance). If the planning
+ * fails, the margin grows and the pipeline retries. After the last attempt
+ * the pipeline plans on the full map.
+ *
+ * Only the plugins consuming the snapshot (see
+ * gpp_interface::CostmapSnapshotInterface) work on the cropped map.
+ *
+ * @section Parameters
+ *
+ * The parameters are defined under the name of the plugin.
+ *
+ * @code{yaml}
+ * # margin in meters around the start and the goal
+ * margin: 2.0
+ * # factor by which the margin grows after every failed attempt
+ * growth: 2.0
+ * # number of attempts on the cropped map
+ * max_attempts: 3
+ * @endcode
+ */
+struct CropCostmap : public gpp_interface::PrePlanningInterface,
+                     public gpp_interface::RegionOfInterestInterface {
+  using Pose = gpp_interface::PrePlanningInterface::Pose;
+
+  /// @brief returns true: the plugin just defines the region of interest
+  bool
+  preProcess(Pose& _start, Pose& _goal, Map& _map, double _tolerance) override;
+
+  void
+  initialize(const std::string& _name) override;
+
+  bool
+  getRegionOfInterest(const Pose& _start, const Pose& _goal, double _tolerance,
+                      size_t _attempt, Window& _window) override;
+
+  /// @brief returns the bounding box of _start and _goal enlarged by _margin
+  static Window
+  makeWindow(const Pose& _start, const Pose& _goal, double _margin) noexcept;
+
+private:
+  double margin_ = 2;
+  double growth_ = 2;
+  size_t max_attempts_ = 3;
+};
+
+}  // namespace gpp_plugin
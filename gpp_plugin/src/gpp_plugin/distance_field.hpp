@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <gpp_interface/distance_field_interface.hpp>
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/PoseStamped.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Computes and caches the DistanceField of the last goal.
+ *
+ * The field is keyed by the goal cell and the revision of the map (see
+ * costmapRevision). The plugins access the cache through a View, which
+ * defines the map: every stage of the pipeline has its own View, so the
+ * stages can work on different maps (e.x. the live map of the next request
+ * and the snapshot of the current one), while they still share the field.
+ *
+ * The revision is computed once per set map, so a request, which does not
+ * need the field, does not pay for it. Every computation publishes a new
+ * immutable field; the buffer of the last field is reused, if no one holds
+ * it anymore.
+ *
+ * The class is thread-safe.
+ */
+struct DistanceFieldCache {
+  using DistanceField = gpp_interface::DistanceField;
+
+  /// @brief counters of the cache
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+  };
+
+  /// @brief the provider for the plugins of one stage (thread-safe)
+  struct View : public gpp_interface::DistanceFieldProvider {
+    /// @param _cache the shared cache (must outlive the view)
+    View(DistanceFieldCache& _cache) noexcept;
+
+    /// @brief sets the live map of the current job (locked on every use)
+    void
+    setMap(costmap_2d::Costmap2D& _map);
+
+    /// @brief sets an immutable map (e.x. a snapshot), which needs no locking
+    void
+    setSnapshot(const costmap_2d::Costmap2D& _snapshot);
+
+    std::shared_ptr<const DistanceField>
+    getDistanceField(const geometry_msgs::PoseStamped& _goal) override;
+
+  private:
+    DistanceFieldCache& cache_;
+    const costmap_2d::Costmap2D* map_ = nullptr;
+    // the mutex of the live map (nullptr for a snapshot)
+    costmap_2d::Costmap2D::mutex_t* map_mutex_ = nullptr;
+    bool has_revision_ = false;
+    uint64_t revision_ = 0;
+    std::mutex mutex_;
+  };
+
+  /// @param _lethal cells with a cost equal or above are not traversable
+  explicit DistanceFieldCache(
+      unsigned char _lethal = costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+
+  Stats
+  getStats() const;
+
+  /// @brief the buffer of the open cells (distance and index)
+  using Heap = std::vector<std::pair<float, unsigned int>>;
+
+  /**
+   * @brief runs Dijkstra from the goal cell
+   *
+   * @param _map the map (must be locked)
+   * @param _goal index of the goal cell in the _map
+   * @param _lethal cells with a cost equal or above are not traversable
+   * @param _field the output
+   * @param _heap reused buffer
+   */
+  static void
+  compute(const costmap_2d::Costmap2D& _map, unsigned int _goal,
+          unsigned char _lethal, DistanceField& _field, Heap& _heap);
+
+private:
+  /**
+   * @brief returns the field of the _goal cell on the _map
+   *
+   * @param _map the map (must be locked), or nullptr for an empty field
+   * @param _revision the revision of the _map
+   */
+  std::shared_ptr<const DistanceField>
+  find(const costmap_2d::Costmap2D* _map, uint64_t _revision,
+       unsigned int _goal);
+
+  unsigned char lethal_;
+
+  // the key of the field_
+  bool valid_ = false;
+  uint64_t field_revision_ = 0;
+  unsigned int field_goal_ = 0;
+
+  // the published field (written only while no one else holds it)
+  std::shared_ptr<DistanceField> field_;
+  Heap heap_;
+  Stats stats_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace gpp_plugin
@@ -24,17 +24,52 @@
 
 #pragma once
 
+#include <gpp_interface/compact_path.hpp>
+#include <gpp_interface/compact_post_planning_interface.hpp>
+#include <gpp_interface/cost_estimate_interface.hpp>
+#include <gpp_interface/costmap_snapshot_interface.hpp>
+#include <gpp_interface/distance_field_interface.hpp>
+#include <gpp_interface/outcome_interface.hpp>
+#include <gpp_interface/path_seed_interface.hpp>
+#include <gpp_interface/path_stream_interface.hpp>
 #include <gpp_interface/post_planning_interface.hpp>
 #include <gpp_interface/pre_planning_interface.hpp>
+#include <gpp_interface/region_of_interest_interface.hpp>
+#include <gpp_interface/replanning_interface.hpp>
+#include <gpp_interface/scratch_interface.hpp>
+#include <gpp_plugin/costmap_snapshot.hpp>
+#include <gpp_plugin/distance_field.hpp>
+#include <gpp_plugin/logging.hpp>
+#include <gpp_plugin/plan_cache.hpp>
+#include <gpp_plugin/plugin_parameter.hpp>
+#include <gpp_plugin/plugin_stats.hpp>
+#include <gpp_plugin/revision_layer.hpp>
+#include <gpp_plugin/thread_pool.hpp>
+#include <gpp_plugin/trace.hpp>
+#include <gpp_plugin/watchdog.hpp>
 #include <costmap_2d/costmap_2d_ros.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <mbf_costmap_core/costmap_planner.h>
 #include <nav_core/base_global_planner.h>
+#include <nav_msgs/Path.h>
 #include <pluginlib/class_loader.h>
 #include <ros/ros.h>
+#include <std_srvs/Trigger.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -53,8 +88,10 @@ struct PluginDefinition {
 };
 
 // define shortcuts to the resource types
+using gpp_interface::CompactPostPlanningInterface;
 using gpp_interface::PostPlanningInterface;
 using gpp_interface::PrePlanningInterface;
+using gpp_interface::ReplanningInterface;
 using mbf_costmap_core::CostmapPlanner;
 using nav_core::BaseGlobalPlanner;
 
@@ -71,13 +108,27 @@ const std::string PluginDefinition<PrePlanningInterface>::package = "gpp_interfa
 template <>
 const std::string PluginDefinition<PrePlanningInterface>::base_class = "gpp_interface::PrePlanningInterface";
 
-// Preplanning specialization
+// Postplanning specialization
 template <>
 const std::string PluginDefinition<PostPlanningInterface>::package = "gpp_interface";
 
 template <>
 const std::string PluginDefinition<PostPlanningInterface>::base_class = "gpp_interface::PostPlanningInterface";
 
+// Compact postplanning specialization
+template <>
+const std::string PluginDefinition<CompactPostPlanningInterface>::package = "gpp_interface";
+
+template <>
+const std::string PluginDefinition<CompactPostPlanningInterface>::base_class = "gpp_interface::CompactPostPlanningInterface";
+
+// Replanning specialization
+template <>
+const std::string PluginDefinition<ReplanningInterface>::package = "gpp_interface";
+
+template <>
+const std::string PluginDefinition<ReplanningInterface>::base_class = "gpp_interface::ReplanningInterface";
+
 // nav-core specialization
 template <>
 const std::string PluginDefinition<BaseGlobalPlanner>::package = "nav_core";
@@ -123,26 +174,22 @@ struct PluginManager : public pluginlib::ClassLoader<_Plugin> {
   }
 };
 
-/**
- * @brief Parameters defining how to execute a plugin.
- *
- * If on_success_break is set to true, and the plugin is executed successfully,
- * the entire plugin-group (pre-, post-planning or planning) succeeds.
- *
- * If on_failure_continue is set to true, and the plugin fails, its plugin-group
- * continues the execution.
- */
-struct PluginParameter {
-  std::string name;
-  bool on_success_break = false;
-  bool on_failure_break = true;
-};
-
 /**
  * @brief Common interface to a plugin group
  *
  * The class defines the ownership and storage of plugins.
  * Typically we own the plugin and store all of them in a vector.
+ *
+ * Additionally the group accumulates the PluginStats for every plugin. The
+ * statistics are thread-safe and may be read while the group is running.
+ *
+ * Lazy plugins (see PluginParameter) are stored without an instance in
+ * getPlugins(). Their instance is created by the Loader on the first call to
+ * getPlugin().
+ *
+ * By default the plugins run in the order of getPlugins(). The adaptive
+ * ordering (see Ordering) lets the group try its most promising alternatives
+ * first.
  */
 template <typename _Plugin>
 struct PluginGroup {
@@ -152,79 +199,1105 @@ struct PluginGroup {
   using NamedPlugin = std::pair<PluginParameter, PluginPtr>;
   using PluginMap = std::vector<NamedPlugin>;
 
+  /// @brief creates and initializes a lazy plugin (nullptr on failure)
+  using Loader = std::function<PluginPtr(const PluginParameter&)>;
+
+  /**
+   * @brief Parameters of the adaptive ordering.
+   *
+   * The adaptive ordering permutes the alternatives of the group: the runs of
+   * consecutive plugins with on_success_break, without on_failure_break and
+   * without read_only. Within a run, the plugins with try_first lead in their
+   * original order. The others follow, sorted by their expected time to a
+   * success: the mean runtime divided by the (smoothed) success rate. Plugins
+   * without calls are tried first, so every plugin gets its statistics.
+   *
+   * The outcomes of a trailing plugin would never be updated: every
+   * exploration-th run of a context moves the least tried of the trailing
+   * alternatives to the front (behind the try_first plugins).
+   *
+   * The outcomes are counted per context (see setContext). The bounds split
+   * the context value (e.x. the goal distance) into the buckets.
+   */
+  struct Ordering {
+    bool adaptive = false;
+    std::vector<double> bounds;  ///< ascending upper bounds of the buckets
+    size_t exploration = 10;     ///< zero disables the exploration
+  };
+
   inline const PluginMap&
   getPlugins() const noexcept {
     return plugins_;
   }
 
+  /**
+   * @brief returns the plugin at _index (nullptr if it could not be loaded)
+   *
+   * Lazy plugins are loaded on the first call - even if the loading fails,
+   * the Loader is called only once. The function is thread-safe.
+   *
+   * @param _index index of the plugin within getPlugins()
+   */
+  _Plugin*
+  getPlugin(size_t _index) const {
+    const auto& plugin = plugins_.at(_index);
+    if (plugin.second || !plugin.first.lazy)
+      return plugin.second.get();
+
+    std::call_once(lazy_flags_[_index], [&]() {
+      if (!loader_)
+        return;
+      const auto begin = std::chrono::steady_clock::now();
+      lazy_[_index] = loader_(plugin.first);
+      // the loading is not a call: it stays out of the latencies
+      const std::chrono::duration<double> loading =
+          std::chrono::steady_clock::now() - begin;
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      if (stats_.size() < plugins_.size())
+        stats_.resize(plugins_.size());
+      stats_[_index].load_time = loading.count();
+    });
+    return lazy_[_index].get();
+  }
+
+  /// @brief sets the Loader for the lazy plugins
+  inline void
+  setLoader(Loader _loader) {
+    loader_ = std::move(_loader);
+  }
+
+  /**
+   * @brief returns true, if the instance of the _loaded plugin can be reused
+   * for the _wanted plugin
+   *
+   * This is the case, if name and type are equal. A lazy plugin is only
+   * reused for another lazy plugin, since it might not be loaded yet.
+   */
+  static bool
+  isReusable(const PluginParameter& _loaded,
+             const PluginParameter& _wanted) noexcept {
+    return _loaded.name == _wanted.name && _loaded.type == _wanted.type &&
+           (!_loaded.lazy || _wanted.lazy);
+  }
+
+  /**
+   * @brief replaces the plugins of the group by the _plugins
+   *
+   * Entries of _plugins without an instance take over the instance and the
+   * statistics of a reusable plugin (see isReusable), so the order of the
+   * plugins may change. Don't call it while the group is running.
+   *
+   * @return the plugins, which were not taken over
+   */
+  PluginMap
+  replace(PluginMap&& _plugins) {
+    PluginMap dropped;
+    std::vector<bool> taken(plugins_.size(), false);
+    std::vector<PluginStats> stats(_plugins.size());
+    std::vector<Expectation> expectations(_plugins.size());
+    // the outcomes of the adaptive ordering follow their instances
+    std::vector<std::vector<Tally>> tallies(_plugins.size());
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.resize(plugins_.size());
+    expectations_.resize(plugins_.size());
+    for (size_t ii = 0; ii != _plugins.size(); ++ii) {
+      auto& plugin = _plugins[ii];
+      if (plugin.second)
+        continue;
+
+      for (size_t jj = 0; jj != plugins_.size(); ++jj) {
+        auto& loaded = plugins_[jj];
+        if (taken[jj] || !isReusable(loaded.first, plugin.first))
+          continue;
+
+        // the lazy plugin might be loaded already
+        if (!loaded.second && jj < lazy_.size())
+          loaded.second = std::move(lazy_[jj]);
+        plugin.second = std::move(loaded.second);
+        stats[ii] = stats_[jj];
+        expectations[ii] = expectations_[jj];
+        if (jj < tallies_.size())
+          tallies[ii] = std::move(tallies_[jj]);
+        taken[jj] = true;
+        break;
+      }
+    }
+
+    // collect the remaining instances
+    for (size_t jj = 0; jj != plugins_.size(); ++jj) {
+      if (taken[jj])
+        continue;
+      if (!plugins_[jj].second && jj < lazy_.size())
+        plugins_[jj].second = std::move(lazy_[jj]);
+      dropped.emplace_back(std::move(plugins_[jj]));
+    }
+
+    plugins_ = std::move(_plugins);
+    stats_ = std::move(stats);
+    expectations_ = std::move(expectations);
+    tallies_.clear();
+    if (ordering_.adaptive)
+      resizeTallies();
+    for (size_t ii = 0; ii != tallies_.size(); ++ii)
+      if (tallies[ii].size() == tallies_[ii].size())
+        tallies_[ii] = std::move(tallies[ii]);
+    order_.clear();
+    resetLazy();
+    return dropped;
+  }
+
   inline const std::string&
   getName() const noexcept {
     return name_;
   }
 
+  /// @brief prefix for log messages ("[name]: ")
+  inline const std::string&
+  getPrefix() const noexcept {
+    return prefix_;
+  }
+
   inline const bool&
   getDefaultValue() const noexcept {
     return default_value_;
   }
 
+  /// @brief time budget of the entire group in seconds (zero for unlimited)
+  inline double
+  getMaxDuration() const noexcept {
+    return max_duration_;
+  }
+
+  inline const Ordering&
+  getOrdering() const noexcept {
+    return ordering_;
+  }
+
+  /// @brief sets the ordering. A different ordering drops the outcomes of
+  /// the old one. Don't call it while the group is running
+  void
+  setOrdering(Ordering _ordering) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (_ordering.adaptive != ordering_.adaptive ||
+        _ordering.bounds != ordering_.bounds) {
+      tallies_.clear();
+      runs_.clear();
+    }
+    ordering_ = std::move(_ordering);
+    order_.clear();
+  }
+
+  /**
+   * @brief selects the bucket of the adaptive ordering for the next run
+   *
+   * @param _value the context, e.x. the distance between start and goal
+   */
+  inline void
+  setContext(double _value) const noexcept {
+    const auto& bounds = ordering_.bounds;
+    context_ = std::upper_bound(bounds.begin(), bounds.end(), _value) -
+               bounds.begin();
+  }
+
+  /**
+   * @brief recomputes the order of the plugins for the current context
+   *
+   * Does nothing, if the ordering is not adaptive. Allocates only on the
+   * first call. Call it before the run.
+   */
+  void
+  updateOrder() const {
+    if (!ordering_.adaptive)
+      return;
+
+    const auto size = plugins_.size();
+    order_.resize(size);
+    scores_.resize(size);
+    calls_.resize(size);
+    runs_.resize(ordering_.bounds.size() + 1);
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      for (size_t ii = 0; ii != size; ++ii) {
+        const auto tally = ii < tallies_.size() ? tallies_[ii][context_]
+                                                : Tally{};
+        // laplace smoothing: an unknown plugin succeeds with 50%
+        const auto rate = (tally.successes + 1.) / (tally.calls + 2.);
+        const auto mean = tally.calls ? tally.total / tally.calls : 0.;
+        scores_[ii] = mean / rate;
+        calls_[ii] = tally.calls;
+      }
+    }
+    const auto explore = ordering_.exploration &&
+                         ++runs_[context_] % ordering_.exploration == 0;
+
+    auto alternative = [](const PluginParameter& _param) {
+      return _param.on_success_break && !_param.on_failure_break &&
+             !_param.read_only;
+    };
+    // the try_first plugins lead, the others follow by their score
+    auto less = [this](size_t _a, size_t _b) {
+      const auto first_a = plugins_[_a].first.try_first;
+      const auto first_b = plugins_[_b].first.try_first;
+      if (first_a || first_b)
+        return first_a && !first_b;
+      return scores_[_a] < scores_[_b];
+    };
+
+    for (size_t ii = 0; ii != size; ++ii)
+      order_[ii] = ii;
+    for (size_t begin = 0; begin != size;) {
+      if (!alternative(plugins_[begin].first)) {
+        ++begin;
+        continue;
+      }
+      size_t end = begin + 1;
+      while (end != size && alternative(plugins_[end].first))
+        ++end;
+
+      // stable insertion sort - the runs are short and we don't allocate
+      for (size_t ii = begin + 1; ii != end; ++ii) {
+        const auto index = order_[ii];
+        size_t jj = ii;
+        for (; jj != begin && less(index, order_[jj - 1]); --jj)
+          order_[jj] = order_[jj - 1];
+        order_[jj] = index;
+      }
+
+      // exploration: the least tried of the trailing plugins leads
+      if (explore) {
+        size_t lead = begin;
+        while (lead != end && plugins_[order_[lead]].first.try_first)
+          ++lead;
+        size_t pick = end;
+        for (size_t ii = lead + 1; ii < end; ++ii)
+          if (pick == end || calls_[order_[ii]] < calls_[order_[pick]])
+            pick = ii;
+        if (pick != end)
+          std::rotate(order_.begin() + lead, order_.begin() + pick,
+                      order_.begin() + pick + 1);
+      }
+      begin = end;
+    }
+  }
+
+  /// @brief returns the index of the plugin to run at the _position (see
+  /// updateOrder)
+  inline size_t
+  getIndex(size_t _position) const noexcept {
+    return _position < order_.size() ? order_[_position] : _position;
+  }
+
+  /// @brief returns a copy of the statistics - aligned with getPlugins()
+  std::vector<PluginStats>
+  getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto stats = stats_;
+    stats.resize(plugins_.size());
+    return stats;
+  }
+
+  /**
+   * @brief adds the outcome of one call to the statistics
+   *
+   * The call is also traced, if a TraceRing is installed. Call it right
+   * after the call has finished.
+   *
+   * @param _index index of the plugin within getPlugins()
+   * @param _success outcome of the call
+   * @param _duration runtime of the call
+   * @param _allocations heap allocations of the call
+   */
+  void
+  record(size_t _index, bool _success, PluginStats::Duration _duration,
+         size_t _allocations = 0) const {
+    const auto trace = getTraceRing();
+    if (trace) {
+      const auto& param = plugins_.at(_index).first;
+      const bool decisive = _breaksGroup(param, _success);
+      const auto end = TraceRing::Clock::now();
+      trace->record(name_.c_str(), param.name.c_str(), end - _duration, end,
+                    TraceEvent::outcome | (_success ? TraceEvent::success : 0) |
+                        (decisive ? TraceEvent::decisive : 0));
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    // allocates only on the first call
+    if (stats_.size() < plugins_.size())
+      stats_.resize(plugins_.size());
+    stats_.at(_index).record(_success, _duration, _allocations);
+
+    // allocates only on the first call
+    if (expectations_.size() < plugins_.size())
+      expectations_.resize(plugins_.size());
+    auto& expectation = expectations_[_index];
+    const auto seconds = std::chrono::duration<double>(_duration).count();
+    if (seconds > expectation.duration)
+      expectation.duration = seconds;
+    else
+      expectation.duration +=
+          expectation_decay * (seconds - expectation.duration);
+    expectation.skips = 0;
+
+    if (ordering_.adaptive) {
+      resizeTallies();
+      auto& tally = tallies_.at(_index)[context_];
+      ++tally.calls;
+      tally.successes += _success;
+      tally.total += std::chrono::duration<double>(_duration).count();
+    }
+  }
+
+  /**
+   * @brief returns the expected runtime of a plugin in seconds
+   *
+   * The expectation follows a slower call at once and decays towards the
+   * faster ones (by expectation_decay per call), so it reflects the recent
+   * calls only. Zero, if the plugin has never been called.
+   *
+   * @param _index index of the plugin within getPlugins()
+   */
+  double
+  getExpectedDuration(size_t _index) const noexcept {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return _index < expectations_.size() ? expectations_[_index].duration : 0;
+  }
+
+  /**
+   * @brief returns true, if the optional plugin should be skipped, since it
+   * would most likely exceed the _remaining time
+   *
+   * A skipped plugin collects no new calls, so its expectation would never
+   * change: every probe_interval-th skip in a row runs the plugin anyway.
+   *
+   * @param _index index of the plugin within getPlugins()
+   * @param _remaining the remaining budget in seconds
+   */
+  bool
+  skipOptional(size_t _index, double _remaining) const noexcept {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (_index >= expectations_.size() ||
+        expectations_[_index].duration <= _remaining)
+      return false;
+
+    auto& skips = expectations_[_index].skips;
+    if (++skips < probe_interval)
+      return true;
+    skips = 0;
+    return false;
+  }
+
+  /// @brief weight of the latest call in the decay of the expectation
+  static constexpr double expectation_decay = 0.2;
+  /// @brief skips in a row, after which an optional plugin is probed
+  static constexpr size_t probe_interval = 10;
+
 protected:
+  /// @brief the expected runtime of one plugin (see getExpectedDuration)
+  struct Expectation {
+    double duration = 0;  ///< in seconds
+    size_t skips = 0;     ///< skips in a row (see skipOptional)
+  };
+
+  /// @brief outcomes of one plugin in one context (see Ordering)
+  struct Tally {
+    size_t calls = 0;
+    size_t successes = 0;
+    double total = 0;  ///< in seconds
+  };
+
+  /// @brief aligns the tallies_ with the plugins_ (lock the stats_mutex_)
+  void
+  resizeTallies() const {
+    if (tallies_.size() < plugins_.size())
+      tallies_.resize(plugins_.size(),
+                      std::vector<Tally>(ordering_.bounds.size() + 1));
+  }
+
+  /// @brief drops the lazy instances - call it after altering plugins_
+  void
+  resetLazy() {
+    lazy_.clear();
+    lazy_.resize(plugins_.size());
+    lazy_flags_.reset(new std::once_flag[plugins_.size()]);
+  }
+
   bool default_value_;
+  double max_duration_ = 0;
   std::string name_ = "undefined";
+  std::string prefix_ = "[undefined]: ";
   PluginMap plugins_;
+
+  // the lazy plugins (aligned with plugins_)
+  Loader loader_;
+  mutable std::vector<PluginPtr> lazy_;
+  mutable std::unique_ptr<std::once_flag[]> lazy_flags_;
+
+  // the statistics don't alter the group
+  mutable std::mutex stats_mutex_;
+  mutable std::vector<PluginStats> stats_;
+  mutable std::vector<Expectation> expectations_;
+
+  // adaptive ordering: the outcomes per plugin and context. the order_ is
+  // only touched by the thread running the group
+  Ordering ordering_;
+  mutable std::vector<std::vector<Tally>> tallies_;
+  mutable size_t context_ = 0;
+  mutable std::vector<size_t> order_;
+  mutable std::vector<double> scores_;
+  mutable std::vector<size_t> calls_;
+  // the runs per context (see Ordering::exploration)
+  mutable std::vector<size_t> runs_;
+};
+
+/// @brief returns the runtime of _func
+template <typename _Functor>
+PluginStats::Duration
+_measure(const _Functor& _func) {
+  const auto begin = std::chrono::steady_clock::now();
+  _func();
+  return std::chrono::steady_clock::now() - begin;
+}
+
+/// @brief converts seconds to a duration (zero and negative values stay so)
+inline Watchdog::Clock::duration
+_toDuration(double _seconds) noexcept {
+  return std::chrono::duration_cast<Watchdog::Clock::duration>(
+      std::chrono::duration<double>(_seconds));
+}
+
+/// @brief converts a duration to seconds
+inline double
+_toSeconds(Watchdog::Clock::duration _duration) noexcept {
+  return std::chrono::duration<double>(_duration).count();
+}
+
+/**
+ * @brief Forwards a cancel request to the _plugin, if its interface allows it.
+ *
+ * The generic version does nothing. Provide an overload for plugin-types,
+ * which can be interrupted.
+ *
+ * @return true, if the cancel request was forwarded successfully.
+ */
+template <typename _Plugin>
+bool
+_cancelPlugin(_Plugin&) {
+  return false;
+}
+
+/// @brief overload for the planning group (see BaseGlobalPlannerWrapper)
+bool
+_cancelPlugin(BaseGlobalPlanner& _plugin);
+
+/// @brief predicate for _runPlugins, which skips no plugin
+struct _NoSkip {
+  constexpr bool
+  operator()(const PluginParameter&) const noexcept {
+    return false;
+  }
 };
 
+/// @brief true, if the plugin may run concurrently to its read-only
+/// neighbours: it must alter neither its input nor the cost
+inline bool
+_isConcurrent(const PluginParameter& _param) noexcept {
+  return _param.read_only && !_param.affects_cost;
+}
+
+/// @brief calls the _func with the _plugin and its _param, if the functor
+/// accepts both
+template <typename _Functor, typename _Plugin>
+auto
+_invoke(const _Functor& _func, _Plugin& _plugin, const PluginParameter& _param,
+        int) -> decltype(_func(_plugin, _param)) {
+  return _func(_plugin, _param);
+}
+
+/// @brief fallback for functors taking only the _plugin
+template <typename _Functor, typename _Plugin>
+bool
+_invoke(const _Functor& _func, _Plugin& _plugin, const PluginParameter&,
+        long) {
+  return _func(_plugin);
+}
+
+/**
+ * @brief Runs the concurrent plugins [_begin, _end) of the _grp concurrently
+ *
+ * Helper for _runPlugins: the calling thread runs the first plugin, the
+ * _pool the others (see _isConcurrent). Which plugins run and their budgets
+ * is decided upfront; the results are then evaluated in the order of the
+ * group, following the rules of _runPlugins. The function returns only after
+ * every plugin has finished. A plugin which starts after the _cancel flag is
+ * set, fails without running.
+ *
+ * The watchdog is not armed for these plugins, but an overrun still counts as
+ * failure. The allocations are not recorded. Lazy plugins are loaded before
+ * the fan-out.
+ *
+ * @param _deadline deadline of the group (time_point::max() for unlimited)
+ * @param _cancel boolean cancel flag
+ * @param _result the result of the group, if it is decided
+ * @param _loading the time spent loading the lazy plugins
+ * @return true, if the result of the group is decided
+ */
+template <typename _Plugin, typename _Functor, typename _Skip>
+bool
+_fanOutPlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
+               size_t _begin, size_t _end,
+               Watchdog::Clock::time_point _deadline, const _Skip& _skip,
+               const std::atomic_bool& _cancel, ThreadPool& _pool,
+               bool& _result, Watchdog::Clock::duration& _loading) {
+  using Clock = Watchdog::Clock;
+  const auto& plugins = _grp.getPlugins();
+  const auto& name = _grp.getPrefix();
+  const auto zero = Clock::duration::zero();
+  const auto limited = _deadline != Clock::time_point::max();
+  const auto remaining = limited ? _deadline - Clock::now() : zero;
+
+  // the plugins to run and their budgets (zero stands for unlimited)
+  std::vector<size_t> indices;
+  std::vector<Clock::duration> budgets;
+  std::vector<_Plugin*> instances;
+  for (size_t ii = _begin; ii != _end; ++ii) {
+    const auto& param = plugins[ii].first;
+    if (_skip(param)) {
+      GPP_HOT_DEBUG(name << "skips " << param.name);
+      continue;
+    }
+
+    auto budget = _toDuration(param.max_duration);
+    if (limited) {
+      const auto optional = !param.on_failure_break;
+      if (remaining <= zero && !optional) {
+        GPP_HOT_WARN(name << "out of time before " << param.name);
+        _result = false;
+        return true;
+      }
+
+      // skip optional plugins, which would most likely break the deadline
+      if (optional && (remaining <= zero ||
+                       _grp.skipOptional(ii, _toSeconds(remaining)))) {
+        GPP_HOT_DEBUG(name << "skips " << param.name);
+        continue;
+      }
+
+      if (budget <= zero || remaining < budget)
+        budget = remaining;
+    }
+    indices.emplace_back(ii);
+    budgets.emplace_back(budget);
+  }
+
+  // lazy plugins are loaded here (outside of their budgets)
+  _loading = _measure([&]() {
+    for (const auto ii : indices)
+      instances.emplace_back(_grp.getPlugin(ii));
+  });
+
+  if (indices.empty())
+    return false;
+
+  auto call = [&](size_t _kk) {
+    // the queued plugins don't start after a cancel
+    if (_cancel)
+      return false;
+
+    const auto& param = plugins[indices[_kk]].first;
+    const auto instance = instances[_kk];
+    bool success = false;
+    const auto duration = _measure([&]() {
+      // an exception must not escape, since we have to join all plugins
+      try {
+        success = instance && _invoke(_func, *instance, param, 0);
+      }
+      catch (std::exception& _ex) {
+        ROS_WARN_STREAM(name << param.name << " threw " << _ex.what());
+      }
+    });
+
+    // an overrun counts as failure
+    if (success && budgets[_kk] > zero && duration > budgets[_kk]) {
+      GPP_HOT_WARN(name << param.name << " overran its budget");
+      success = false;
+    }
+    _grp.record(indices[_kk], success, duration);
+    return success;
+  };
+
+  GPP_HOT_DEBUG(name << "runs " << indices.size() << " read-only plugins");
+  std::vector<std::future<bool>> results;
+  results.reserve(indices.size() - 1);
+  for (size_t kk = 1; kk < indices.size(); ++kk)
+    results.emplace_back(_pool.submit([&call, kk]() { return call(kk); }));
+  bool success = call(0);
+
+  // evaluate the results in the order of the group (and wait for all)
+  bool decided = false;
+  for (size_t kk = 0; kk != indices.size(); ++kk) {
+    if (kk)
+      success = results[kk - 1].get();
+    if (decided)
+      continue;
+
+    if (_cancel) {
+      GPP_HOT_DEBUG(name << "cancelled");
+      _result = false;
+      decided = true;
+      continue;
+    }
+
+    // we have failed - we can either abort or ignore
+    const auto& param = plugins[indices[kk]].first;
+    if (!success)
+      GPP_HOT_WARN(name << "failed at " << param.name);
+    if (_breaksGroup(param, success)) {
+      _result = success;
+      decided = true;
+    }
+  }
+  return decided;
+}
+
 /**
  * @brief Execution logic to run all plugins within one group
  *
  * @tparam _Plugin type of the plugin (PrePlanningInterface, etc)
  * @tparam _Functor functor taking the _Plugin-ref and returning true on success
+ * @tparam _Skip predicate taking the PluginParameter and returning true, if
+ * the plugin should be skipped
  *
  * This function implements the main logic, how to map the result from plugins
  * within a group to the group result.
  *
+ * If the group has a time budget (PluginGroup::getMaxDuration), the function
+ * keeps track of the remaining budget. Optional plugins (on_failure_break is
+ * false), which would most likely break the deadline, are skipped. The
+ * expectation is learned from the recent calls, and a skipped plugin is
+ * probed periodically (see PluginGroup::skipOptional). If a mandatory plugin
+ * is reached without any budget left, the group fails.
+ *
+ * With an adaptive ordering (see PluginGroup::Ordering) the alternatives run
+ * in the order learned for the group's current context.
+ *
+ * A plugin running longer than its budget (the minimum of its max_duration
+ * and the remaining group budget) fails. If a _watchdog is given, the
+ * overrunning plugin is additionally cancelled (see _cancelPlugin).
+ *
+ * If an AllocationCounter is installed, the heap allocations of every call
+ * are recorded.
+ *
+ * If a _pool is given, consecutive read-only plugins, which don't affect the
+ * cost, run concurrently (see _isConcurrent and _fanOutPlugins). The other
+ * read-only plugins run sequentially, since they write the cost.
+ *
  * @param _grp a group of plugins
  * @param _func a functor responsible for calling the plugin's main function.
+ * It may additionally take the PluginParameter as second argument. The calls
+ * for read-only plugins must be thread-safe, if a _pool is given.
  * @param _cancel boolean cancel flag.
+ * @param _watchdog optional watchdog for cancelling overrunning plugins.
+ * @param _skip predicate for skipping plugins (skipped plugins are not
+ * counted in the statistics).
+ * @param _pool optional pool for the read-only plugins.
  */
-template <typename _Plugin, typename _Functor>
+template <typename _Plugin, typename _Functor, typename _Skip = _NoSkip>
 bool
 _runPlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
-            const std::atomic_bool& _cancel) {
+            const std::atomic_bool& _cancel, Watchdog* _watchdog = nullptr,
+            const _Skip& _skip = _Skip{}, ThreadPool* _pool = nullptr) {
+  using Clock = Watchdog::Clock;
   const auto& plugins = _grp.getPlugins();
-  const std::string name = "[" + _grp.getName() + "]: ";
-  for (const auto& plugin : plugins) {
+  const auto& name = _grp.getPrefix();
+  const auto zero = Clock::duration::zero();
+  const auto group_budget = _toDuration(_grp.getMaxDuration());
+  // the loading of the lazy plugins doesn't count against the group budget
+  auto begin = group_budget > zero ? Clock::now() : Clock::time_point{};
+  const auto counter = getAllocationCounter();
+  // the adaptive ordering permutes only the alternatives: the read-only
+  // plugins keep their positions
+  _grp.updateOrder();
+  for (size_t pos = 0; pos != plugins.size(); ++pos) {
+    const auto ii = _grp.getIndex(pos);
+    const auto& plugin = plugins[ii];
     // allow the user to cancel the job
     if (_cancel) {
-      ROS_INFO_STREAM(name << "cancelled");
+      GPP_HOT_DEBUG(name << "cancelled");
       return false;
     }
 
+    // consecutive read-only plugins run concurrently
+    if (_pool && _isConcurrent(plugin.first)) {
+      size_t end = ii + 1;
+      while (end != plugins.size() && _isConcurrent(plugins[end].first))
+        ++end;
+      if (end - ii > 1) {
+        const auto deadline = group_budget > zero
+                                  ? begin + group_budget
+                                  : Clock::time_point::max();
+        bool result;
+        Clock::duration loading = zero;
+        const auto decided =
+            _fanOutPlugins(_grp, _func, ii, end, deadline, _skip, _cancel,
+                           *_pool, result, loading);
+        begin += loading;
+        if (decided)
+          return result;
+        pos = end - 1;
+        continue;
+      }
+    }
+
+    if (_skip(plugin.first)) {
+      GPP_HOT_DEBUG(name << "skips " << plugin.first.name);
+      continue;
+    }
+
+    // the time this plugin may take (zero stands for unlimited)
+    auto budget = _toDuration(plugin.first.max_duration);
+    if (group_budget > zero) {
+      const auto remaining = group_budget - (Clock::now() - begin);
+      const auto optional = !plugin.first.on_failure_break;
+      if (remaining <= zero && !optional) {
+        GPP_HOT_WARN(name << "out of time before " << plugin.first.name);
+        return false;
+      }
+
+      // skip optional plugins, which would most likely break the deadline
+      if (optional &&
+          (remaining <= zero || _grp.skipOptional(ii, _toSeconds(remaining)))) {
+        GPP_HOT_DEBUG(name << "skips " << plugin.first.name);
+        continue;
+      }
+
+      if (budget <= zero || remaining < budget)
+        budget = remaining;
+    }
+
     // tell my name
-    ROS_INFO_STREAM(name << "runs " << plugin.first.name);
+    GPP_HOT_DEBUG(name << "runs " << plugin.first.name);
+
+    // lazy plugins are loaded here (outside of their budget)
+    _Plugin* instance = nullptr;
+    begin += _measure([&]() { instance = _grp.getPlugin(ii); });
+
+    // cancel the plugin, once it overruns its budget
+    const auto armed = _watchdog && budget > zero && instance;
+    if (armed)
+      _watchdog->arm(Clock::now() + budget,
+                     [instance]() { _cancelPlugin(*instance); });
 
     // run the impl, but don't die
-    if (!plugin.second || !_func(*plugin.second)) {
-      // we have failed - we can either abort or ignore
-      ROS_WARN_STREAM(name << "failed at " << plugin.first.name);
-      if (plugin.first.on_failure_break)
-        return false;
+    bool success;
+    const size_t allocations = counter ? counter() : 0;
+    const auto duration = _measure([&]() {
+      success = instance && _invoke(_func, *instance, plugin.first, 0);
+    });
+    if (armed)
+      _watchdog->disarm();
+
+    // an overrun counts as failure
+    if (success && budget > zero && duration > budget) {
+      GPP_HOT_WARN(name << plugin.first.name << " overran its budget");
+      success = false;
     }
-    else if (plugin.first.on_success_break)
-      return true;
+    _grp.record(ii, success, duration,
+                counter ? counter() - allocations : 0);
+
+    // we have failed - we can either abort or ignore
+    if (!success)
+      GPP_HOT_WARN(name << "failed at " << plugin.first.name);
+    if (_breaksGroup(plugin.first, success))
+      return success;
   }
   return _grp.getDefaultValue();
 }
 
 /// @brief as _runPlugins but with a warning on failure
-template <typename _Plugin, typename _Functor>
+template <typename _Plugin, typename _Functor, typename _Skip = _NoSkip>
 bool
 runPlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
-           const std::atomic_bool& _cancel) {
-  const auto result = _runPlugins(_grp, _func, _cancel);
+           const std::atomic_bool& _cancel, Watchdog* _watchdog = nullptr,
+           const _Skip& _skip = _Skip{}, ThreadPool* _pool = nullptr) {
+  const auto result =
+      _runPlugins(_grp, _func, _cancel, _watchdog, _skip, _pool);
   // print a conditional warning
-  ROS_WARN_STREAM_COND(!result, "[gpp]: failed at group " << _grp.getName());
+  if (!result)
+    GPP_HOT_WARN("[gpp]: failed at group " << _grp.getName());
   return result;
 }
+
+/**
+ * @brief Reusable state of _racePlugins.
+ *
+ * The buffers are sized by resize, so a race of the same size does not
+ * allocate. The tasks are posted to the pool and signal their completion
+ * through the cv.
+ */
+struct RaceState {
+  using Clock = Watchdog::Clock;
+
+  RaceState() = default;
+  // the tasks refer to this instance
+  RaceState(const RaceState&) = delete;
+  RaceState&
+  operator=(const RaceState&) = delete;
+
+  /// @brief sizes the buffers for _size plugins
+  inline void
+  resize(size_t _size) {
+    skipped.resize(_size);
+    deadlines.resize(_size);
+    done.resize(_size);
+    success.resize(_size);
+    for (size_t ii = tasks.size(); ii < _size; ++ii)
+      tasks.emplace_back([this, ii]() { run(ii); });
+    tasks.resize(_size);
+  }
+
+  /// @brief wakes up the waiting race (e.x. after setting its cancel flag)
+  inline void
+  notify() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cv.notify_all();
+  }
+
+  std::vector<char> skipped;
+  std::vector<Clock::time_point> deadlines;
+  std::vector<char> done;     ///< guarded by the mutex
+  std::vector<char> success;  ///< guarded by the mutex
+
+  /// @brief body of the tasks (set by the running race)
+  std::function<void(size_t)> run;
+  /// @brief the task ii calls run(ii)
+  std::vector<std::function<void()>> tasks;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+/**
+ * @brief Execution logic to run all plugins within one group concurrently
+ *
+ * @tparam _Plugin type of the plugin (PrePlanningInterface, etc)
+ * @tparam _Functor functor taking the _Plugin-ref and its index within the
+ * group and returning true on success
+ *
+ * All plugins are started at once on the _pool. The results are evaluated in
+ * the order of the group, following the same rules as in _runPlugins. As soon
+ * as the group's result is decided, the remaining plugins are cancelled (if
+ * they support it). Since the plugins are not thread-safe, the function
+ * returns only after every plugin has finished.
+ *
+ * The allocations are not recorded, since the plugins run concurrently.
+ * Lazy plugins are loaded before the race starts. Skipped plugins don't take
+ * part in the race. The race itself does not allocate, once the _state has
+ * the size of the group.
+ *
+ * The time budgets are measured from the start of the race: a plugin is
+ * cancelled once it exceeds its max_duration and fails. If the group's budget
+ * is exhausted before the result is decided, the group fails.
+ *
+ * @param _grp a group of plugins
+ * @param _func a functor responsible for calling the plugin's main function.
+ * The functor is called concurrently: calls with different indices must not
+ * share any output.
+ * @param _cancel boolean cancel flag. Call RaceState::notify after setting
+ * it, so the race sees it without delay.
+ * @param _pool pool executing the plugins.
+ * @param _state the buffers of the race (resized to the group, if required).
+ * @param _winner index of the last successful plugin, which was evaluated.
+ * Equal to the size of the group, if no plugin succeeded.
+ * @param _skip predicate for skipping plugins (see _runPlugins).
+ */
+template <typename _Plugin, typename _Functor, typename _Skip = _NoSkip>
+bool
+_racePlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
+             const std::atomic_bool& _cancel, ThreadPool& _pool,
+             RaceState& _state, size_t& _winner,
+             const _Skip& _skip = _Skip{}) {
+  using Clock = Watchdog::Clock;
+  const auto& plugins = _grp.getPlugins();
+  const auto size = plugins.size();
+  const auto& name = _grp.getPrefix();
+  const auto zero = Clock::duration::zero();
+  const auto group_budget = _toDuration(_grp.getMaxDuration());
+  if (_state.tasks.size() != size)
+    _state.resize(size);
+
+  // lazy plugins are loaded first (outside of the budgets)
+  auto& skipped = _state.skipped;
+  for (size_t ii = 0; ii != size; ++ii) {
+    skipped[ii] = _skip(plugins[ii].first);
+    if (skipped[ii])
+      GPP_HOT_DEBUG(name << "skips " << plugins[ii].first.name);
+    else
+      _grp.getPlugin(ii);
+  }
+
+  // the deadlines of the plugins (time_point::max() for unlimited budgets)
+  const auto begin = Clock::now();
+  const auto group_deadline =
+      group_budget > zero ? begin + group_budget : Clock::time_point::max();
+  auto& deadlines = _state.deadlines;
+  for (size_t ii = 0; ii != size; ++ii) {
+    const auto budget = _toDuration(plugins[ii].first.max_duration);
+    deadlines[ii] = !skipped[ii] && budget > zero ? begin + budget
+                                                  : Clock::time_point::max();
+  }
+
+  // the body of the tasks. the run wrapper captures only the reference, so
+  // the std::function stores it without allocating
+  const auto task = [&](size_t _ii) {
+    const auto& plugin = plugins[_ii];
+    bool success = false;
+    const auto duration = _measure([&]() {
+      // an exception must not escape, since we have to join all plugins
+      try {
+        const auto instance = _grp.getPlugin(_ii);
+        success = instance && _func(*instance, _ii);
+      }
+      catch (std::exception& _ex) {
+        ROS_WARN_STREAM(name << plugin.first.name << " threw " << _ex.what());
+      }
+    });
+    // an overrun counts as failure
+    const auto budget = _toDuration(plugin.first.max_duration);
+    if (success && budget.count() > 0 && duration > budget) {
+      GPP_HOT_WARN(name << plugin.first.name << " overran its budget");
+      success = false;
+    }
+    _grp.record(_ii, success, duration);
+
+    std::lock_guard<std::mutex> lock(_state.mutex);
+    _state.success[_ii] = success;
+    _state.done[_ii] = true;
+    _state.cv.notify_all();
+  };
+  _state.run = [&task](size_t _ii) { task(_ii); };
+
+  // start all plugins at once
+  {
+    std::lock_guard<std::mutex> lock(_state.mutex);
+    for (size_t ii = 0; ii != size; ++ii)
+      _state.done[ii] = skipped[ii];
+  }
+  for (size_t ii = 0; ii != size; ++ii)
+    if (!skipped[ii])
+      _pool.post(_state.tasks[ii]);
+
+  // cancels the plugin ii (if it's running)
+  const auto cancel_plugin = [&](size_t _ii) {
+    const auto instance = skipped[_ii] ? nullptr : _grp.getPlugin(_ii);
+    if (instance)
+      _cancelPlugin(*instance);
+  };
+
+  // evaluate the results in the order of the group
+  _winner = size;
+  bool result = _grp.getDefaultValue();
+  bool cancelled = false;
+  size_t ii = 0;
+  for (; ii != size; ++ii) {
+    if (skipped[ii])
+      continue;
+
+    // wait for the plugin, but keep an eye on the cancel flag and the budgets
+    bool out_of_time = false;
+    bool success = false;
+    {
+      std::unique_lock<std::mutex> lock(_state.mutex);
+      while (!_cancel && !_state.done[ii]) {
+        // wake up at the next deadline
+        auto wake = group_deadline;
+        for (size_t jj = ii; jj != size; ++jj)
+          wake = std::min(wake, deadlines[jj]);
+        if (wake == Clock::time_point::max()) {
+          _state.cv.wait(lock);
+          continue;
+        }
+        if (_state.cv.wait_until(lock, wake) == std::cv_status::no_timeout)
+          continue;
+
+        const auto now = Clock::now();
+        if (now >= group_deadline) {
+          out_of_time = true;
+          break;
+        }
+
+        // cancel the overrunning plugins (only once)
+        lock.unlock();
+        for (size_t jj = ii; jj != size; ++jj) {
+          if (now >= deadlines[jj]) {
+            deadlines[jj] = Clock::time_point::max();
+            cancel_plugin(jj);
+          }
+        }
+        lock.lock();
+      }
+      success = _state.success[ii];
+    }
+
+    // allow the user to cancel the job
+    if (_cancel) {
+      cancelled = true;
+      break;
+    }
+
+    if (out_of_time) {
+      GPP_HOT_WARN(name << "out of time at " << plugins[ii].first.name);
+      result = false;
+      break;
+    }
+
+    // we have failed - we can either abort or ignore
+    const auto& plugin = plugins[ii];
+    if (!success)
+      GPP_HOT_WARN(name << "failed at " << plugin.first.name);
+    else
+      _winner = ii;
+    if (_breaksGroup(plugin.first, success)) {
+      result = success;
+      ++ii;
+      break;
+    }
+  }
+
+  // the result is decided: stop the remaining plugins and wait for them
+  for (size_t jj = ii; jj != size; ++jj)
+    cancel_plugin(jj);
+
+  {
+    std::unique_lock<std::mutex> lock(_state.mutex);
+    _state.cv.wait(lock, [&]() {
+      return std::all_of(_state.done.begin(), _state.done.end(),
+                         [](char _done) { return _done; });
+    });
+  }
+  _state.run = nullptr;
+
+  if (cancelled) {
+    GPP_HOT_DEBUG(name << "cancelled");
+    return false;
+  }
+  return result;
+}
+
+/// @brief as _racePlugins but with a warning on failure
+template <typename _Plugin, typename _Functor, typename _Skip = _NoSkip>
+bool
+racePlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
+            const std::atomic_bool& _cancel, ThreadPool& _pool,
+            RaceState& _state, size_t& _winner, const _Skip& _skip = _Skip{}) {
+  const auto result =
+      _racePlugins(_grp, _func, _cancel, _pool, _state, _winner, _skip);
+  // print a conditional warning
+  if (!result)
+    GPP_HOT_WARN("[gpp]: failed at group " << _grp.getName());
+  return result;
+}
+
 /**
  * @brief Loads an array of plugins.
  *
@@ -270,13 +1343,28 @@ runPlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
  * 'name' defines a unique descriptor which will be passed to a plugin.
  * 'type' defines the type of the plugin.
  * Both tags must have literal values.
+ * The optional tag 'max_duration' defines the time budget of the plugin in
+ * seconds. The budget of the entire group is read from
+ * `<_resource>_max_duration`.
+ * The optional boolean tag 'affects_cost' (default true) marks plugins which
+ * must run in the cost-only mode.
+ * The optional boolean tag 'lazy' (default false) defers the loading of the
+ * plugin until its first use (see PluginGroup::getPlugin).
+ * The optional boolean tag 'read_only' (default false) marks plugins which
+ * don't alter their input (see _runPlugins and _isConcurrent).
+ *
+ * The group can be reloaded at runtime: prepare creates only the plugins,
+ * which are not loaded under the same name and type, and commit swaps them
+ * in - reusing the loaded instances.
  *
  * Code example:
  *
  * @code{yaml}
+ * my_resource_tag_max_duration: 0.1
  * my_resource_tag:
  *  - {name: foo, type: a_valid_type}
- *  - {name: baz, type: another_type}
+ *  - {name: baz, type: another_type, max_duration: 0.05}
+ *  - {name: bar, type: rarely_used_type, lazy: true}
  * @endcode
  *
  * @section Remarks
@@ -293,13 +1381,61 @@ runPlugins(const PluginGroup<_Plugin>& _grp, const _Functor& _func,
 template <typename _Plugin>
 struct ArrayPluginManager : public PluginManager<_Plugin>,
                             public PluginGroup<_Plugin> {
+  using PluginPtr = typename PluginGroup<_Plugin>::PluginPtr;
+  using PluginMap = typename PluginGroup<_Plugin>::PluginMap;
+
+  /**
+   * @brief loads the plugins (equivalent to commit(prepare(...)))
+   *
+   * @param _resource name of the array on the param-server
+   * @param _nh node-handle to the param-server
+   * @param _default_value default value of the group, if the parameter
+   * `<_resource>_default_value` is not set
+   */
   void
-  load(const std::string& _resource, ros::NodeHandle& _nh);
+  load(const std::string& _resource, ros::NodeHandle& _nh,
+       bool _default_value = true);
+
+  /**
+   * @brief reads the plugins from _resource and creates the missing ones
+   *
+   * The group is not altered. Plugins, which can reuse a loaded instance (see
+   * PluginGroup::isReusable), and lazy plugins have no instance. The created
+   * plugins are not initialized.
+   *
+   * @param _resource name of the array on the param-server
+   * @param _nh node-handle to the param-server
+   * @param _strict if set, an invalid or failing plugin throws a
+   * std::runtime_error. Otherwise it is skipped with a warning
+   */
+  PluginMap
+  prepare(const std::string& _resource, ros::NodeHandle& _nh,
+          bool _strict = false);
+
+  /**
+   * @brief updates the group parameters and replaces the plugins
+   *
+   * See PluginGroup::replace. Don't call it while the group is running.
+   *
+   * @param _pending the output of prepare
+   * @return the dropped plugins
+   */
+  PluginMap
+  commit(const std::string& _resource, ros::NodeHandle& _nh,
+         PluginMap&& _pending, bool _default_value = true);
+
+  /// @brief as createCustomInstance, but safe to call from multiple threads
+  PluginPtr
+  create(const std::string& _type);
+
+private:
+  std::mutex create_mutex_;
 };
 
 // compile time specification of the ArrayPluginManager
 using PrePlanningManager = ArrayPluginManager<PrePlanningInterface>;
 using PostPlanningManager = ArrayPluginManager<PostPlanningInterface>;
+using ReplanningManager = ArrayPluginManager<ReplanningInterface>;
 using GlobalPlannerManager = ArrayPluginManager<BaseGlobalPlanner>;
 
 /**
@@ -309,6 +1445,11 @@ using GlobalPlannerManager = ArrayPluginManager<BaseGlobalPlanner>;
  * Implementation is very simpliar to move-base-flex wrapper class.
  * However, all publicly available planners stick to the BaseGlobalPlanner API,
  * so we treat it as default.
+ *
+ * The BaseGlobalPlanner API has no tolerance and no outcome codes: calling
+ * makePlan on the wrapper plans with a zero tolerance. The
+ * GlobalPlannerPipeline avoids this, by calling the wrapped planner directly
+ * (see getImpl).
  */
 struct BaseGlobalPlannerWrapper : public BaseGlobalPlanner {
   // define the interface types
@@ -332,6 +1473,16 @@ struct BaseGlobalPlannerWrapper : public BaseGlobalPlanner {
   void
   initialize(std::string name, Map* costmap_ros) override;
 
+  /// @brief forwards the cancel request to the CostmapPlanner
+  bool
+  cancel();
+
+  /// @brief returns the wrapped CostmapPlanner
+  inline CostmapPlanner&
+  getImpl() noexcept {
+    return *impl_;
+  }
+
 private:
   ImplPlanner impl_;
 };
@@ -354,6 +1505,56 @@ private:
   PluginManager<CostmapPlanner> manager_;
 };
 
+/**
+ * @brief Wrappes the CompactPostPlanningInterface into the
+ * PostPlanningInterface.
+ *
+ * Calling postProcess on the wrapper converts the path forth and back. The
+ * GlobalPlannerPipeline avoids this, by calling the wrapped plugin directly
+ * (see getImpl).
+ */
+struct PostPlanningWrapper : public PostPlanningInterface {
+  using ImplPlugin = pluginlib::UniquePtr<CompactPostPlanningInterface>;
+
+  /// @brief our c'tor
+  /// @param _impl a valid instance of the CompactPostPlanningInterface
+  /// @throw std::invalid_argument, if _impl is nullptr
+  explicit PostPlanningWrapper(ImplPlugin&& _impl);
+
+  bool
+  postProcess(Path& _path, double& _cost) override;
+
+  void
+  initialize(const std::string& _name, Map* _map) override;
+
+  /// @brief returns the wrapped CompactPostPlanningInterface
+  inline CompactPostPlanningInterface&
+  getImpl() noexcept {
+    return *impl_;
+  }
+
+private:
+  ImplPlugin impl_;
+  gpp_interface::CompactPath compact_;
+};
+
+/**
+ * @brief Loads either PostPlanningInterface or CompactPostPlanningInterface
+ * plugins under a uniform interface.
+ *
+ * The usage is equivalent to the ArrayPluginManager.
+ */
+struct CompactPostPlanningManager : public PostPlanningManager {
+  ~CompactPostPlanningManager();
+
+  // dont call this yourself
+  pluginlib::UniquePtr<PostPlanningInterface>
+  createCustomInstance(const std::string& _type) override;
+
+private:
+  PluginManager<CompactPostPlanningInterface> manager_;
+};
+
 /**
  * @brief Combine pre-planning, planning and post-planning to customize the
  * your path.
@@ -375,6 +1576,93 @@ private:
  *
  * You need to provide at least one plugin under the tag `planning`.
  *
+ * The planning group is executed sequentially by default. Set the parameter
+ * `planning_mode` to `race` in order to start all planners at once. The
+ * results are then evaluated in the order of the group, and the planners
+ * which are not needed anymore will be cancelled. In this mode the planners
+ * don't receive the output of their predecessors.
+ *
+ * The plugins are initialized on `init_threads` threads (one by default,
+ * zero for one thread per core). Plugins tagged with `lazy: true` are loaded
+ * and initialized when their group reaches them for the first time.
+ *
+ * The service `~<name>/reload` (std_srvs::Trigger) reloads the groups from
+ * the param-server. Plugins with an unchanged name and type are reused (see
+ * reload()).
+ *
+ * Every plugin invocation is timed and counted. The accumulated statistics
+ * are available through getStats(). If the parameter `diagnostics_rate` is
+ * positive, the statistics are also published as
+ * `diagnostic_msgs::DiagnosticArray` under the topic `~<name>/diagnostics`.
+ *
+ * Optionally you can define replanning plugins under the tag `replanning`.
+ * Those plugins must adhere to `gpp_interface::ReplanningInterface`. They run
+ * after the pre-planning group, if the goal did not change since the last
+ * successful plan. If they succeed, the last path is reused and the planning
+ * and post-planning groups are skipped.
+ *
+ * Besides the blocking makePlan calls, the pipeline offers makePlanAsync.
+ * It runs the pipeline on a worker thread and returns a future. A newer
+ * request preempts the older one: a queued request is dropped, and a running
+ * request is cancelled. Cancel requests are forwarded to the active planner,
+ * if it implements the CostmapPlanner interface.
+ *
+ * With `pipelined: true` makePlanAsync runs every stage on its own thread:
+ * the pre-planning (with the cache lookup), the planning (with the snapshot
+ * and the replanning) and the post-planning. Consecutive requests overlap,
+ * so the throughput is bound by the slowest stage and not by the sum of all
+ * stages. A newer request does not cancel the running stages; it only drops
+ * the older request queued in front of a stage.
+ *
+ * Every plugin may define a time budget under the tag `max_duration` and
+ * every group under the parameter `<group>_max_duration` (both in seconds).
+ * A plugin overrunning its budget is cancelled and fails. Optional plugins
+ * (`on_failure_break: false`), which would most likely break the budget of
+ * their group, are skipped.
+ *
+ * The post-planning group accepts plugins implementing either
+ * `gpp_interface::PostPlanningInterface` or
+ * `gpp_interface::CompactPostPlanningInterface`. The path is converted only
+ * where two subsequent plugins use different representations.
+ *
+ * Plugins of the replanning, planning and post-planning groups may implement
+ * gpp_interface::CostmapSnapshotInterface in addition to their interface.
+ * If any plugin does so, the pipeline copies the costmap once per request
+ * (after the pre-planning group) into a reused buffer and passes this
+ * snapshot to all of them.
+ *
+ * makePlans plans a batch of queries. If the parameter `batch_workers` is
+ * positive, the pipeline creates this many copies of itself (each with its
+ * own plugin instances) and spreads the queries over them.
+ *
+ * With `concurrent: true` the batch workers also serve concurrent makePlan
+ * calls: if the pipeline is busy, the caller borrows an idle worker instead
+ * of waiting. Every worker has its own cancel flag and buffers. cancel()
+ * still cancels all running requests. The pre-planning of all pipelines is
+ * serialized, since it may alter the live map; a worker serves a request
+ * only, if its planners and post-planners read nothing but the snapshot.
+ *
+ * makeCost and makeCosts return only the cost. Planners implementing
+ * gpp_interface::CostEstimateInterface estimate it without a path.
+ *
+ * Planners and post-planning plugins implementing
+ * gpp_interface::PathStreamInterface may stream the prefix of their path. The
+ * pipeline forwards the prefix of the last plugin altering the path to the
+ * callback set by setPrefixCallback and (with `publish_prefix: true`) to the
+ * topic `~<name>/prefix`. If read-only plugins follow this plugin, the last
+ * prefix is forwarded once they accepted the path. A path from the cache or
+ * from a leg planned ahead is forwarded as a whole.
+ *
+ * speculate plans the upcoming legs of a mission on a batch worker. A later
+ * makePlan to the goal of a leg is served from this plan, if the start is
+ * close to it and its remainder is free on the live costmap.
+ *
+ * The pipeline can cache its output. The cache runs before the pre-planning
+ * group and is keyed on the quantized start and goal poses, the tolerance and
+ * the revision of the costmap. On a hit no plugin is called. The revision is
+ * read from the RevisionLayer of the costmap - without it the pipeline hashes
+ * the entire map.
+ *
  * If you are not using `move_base_flex`, you can also define a custom tolerance
  * under the parameter `tolerance` - defining the metric goal tolerance.
  *
@@ -385,11 +1673,31 @@ private:
  * # goal tolerance in meters
  * tolerance: 0.1
  *
+ * # execution mode of the planning group (sequential or race)
+ * planning_mode: sequential
+ *
+ * # run the stages of makePlanAsync on their own threads
+ * pipelined: false
+ *
+ * # rate for publishing the plugin statistics (zero disables the publishing)
+ * diagnostics_rate: 0
+ *
+ * # plan cache (zero capacity disables the cache)
+ * cache:
+ *   capacity: 0
+ *   memory: 16                # in MB
+ *   position_resolution: 0.05 # in meters
+ *   angle_resolution: 0.1     # in radians
+ *
  * # define the pre-planning plugins
  * pre_planning:
  * -  {name: first_pre_planning_name, type: first_pre_planning_type}
  * -  {name: second_pre_planning_name, type: second_pre_planning_type}
  *
+ * # define the replanning plugins
+ * replanning:
+ * -  {name: first_replanning_name, type: first_replanning_type}
+ *
  * # define the planning plugins
  * planning:
  * -  {name: first_planning_name, type: first_planning_type}
@@ -409,6 +1717,22 @@ struct GlobalPlannerPipeline : public BaseGlobalPlanner, public CostmapPlanner {
   using Path = std::vector<Pose>;
   using Map = costmap_2d::Costmap2DROS;
 
+  /// @brief output of one pipeline run
+  struct PlanResult {
+    uint32_t outcome;  ///< outcome code as defined by mbf_msgs/GetPath
+    Path plan;
+    double cost = 0;
+    std::string message;
+  };
+
+  /// @brief one planning problem of a batch (see makePlans)
+  struct PlanQuery {
+    Pose start;
+    Pose goal;
+  };
+
+  ~GlobalPlannerPipeline();
+
   bool
   makePlan(const Pose& _start, const Pose& _goal, Path& _plan) override;
 
@@ -425,26 +1749,681 @@ struct GlobalPlannerPipeline : public BaseGlobalPlanner, public CostmapPlanner {
   bool
   cancel() override;
 
+  /**
+   * @brief Runs the pipeline on a worker thread.
+   *
+   * The request preempts all older async requests: a queued request
+   * finishes with the outcome CANCELED and a running request is cancelled. A
+   * blocking makePlan is not preempted. In the pipelined mode only the
+   * queued requests are preempted.
+   *
+   * @param _start start pose of the planning problem
+   * @param _goal goal pose of the planning problem
+   * @param _tolerance goal tolerance
+   * @return future holding the output of the pipeline
+   */
+  std::future<PlanResult>
+  makePlanAsync(const Pose& _start, const Pose& _goal, double _tolerance);
+
+  /// @brief as above, but with the tolerance from the param-server
+  std::future<PlanResult>
+  makePlanAsync(const Pose& _start, const Pose& _goal);
+
+  /// @brief receives the streamed prefix of the path
+  using PrefixCallback = std::function<void(const Path&)>;
+
+  /**
+   * @brief Sets the receiver of the streamed prefixes.
+   *
+   * Only the last plugin altering the path (followed only by read-only
+   * plugins) may stream its prefix (see gpp_interface::PathStreamInterface).
+   * The _callback runs on the thread of this plugin. If read-only plugins
+   * follow it, the last prefix is held back until they accepted the path - a
+   * rejected path forwards nothing. Don't call it while the pipeline is
+   * running.
+   *
+   * The workers serving concurrent requests (see `concurrent`) forward their
+   * prefixes to the same _callback - it may run on multiple threads at once.
+   *
+   * @param _callback the receiver (an empty function disables the callback)
+   */
+  void
+  setPrefixCallback(PrefixCallback _callback);
+
+  /**
+   * @brief Plans the upcoming legs of a mission in the background.
+   *
+   * One batch worker plans every leg from one goal to the next, while the
+   * pipeline stays free for the real requests. A later makePlan to the goal
+   * of a leg is served from its plan - if the start is close to the plan and
+   * the remainder of the plan is free on the live costmap. Otherwise the
+   * request is planned as usual. A new call replaces the older legs.
+   *
+   * The legs skip the pre-planning, which may alter the live map, and plan
+   * on their own snapshot. Without batch workers - or if not all planners
+   * and post-planners read the snapshot - nothing is planned ahead.
+   *
+   * @param _goals the current goal followed by the upcoming goals. an empty
+   * vector drops all legs
+   */
+  void
+  speculate(const std::vector<Pose>& _goals);
+
+  /**
+   * @brief Plans all _queries in one call.
+   *
+   * The revision of the costmap (for the cache) is taken once for all
+   * queries. The pre-planning may alter the live map: it runs for every query
+   * on the calling thread, then the snapshot is taken once. The planning and
+   * the post-planning are spread over the batch workers (see the parameter
+   * `batch_workers`); the calling thread works as well. A worker joins only,
+   * if all its planners and post-planners read the snapshot - the workers
+   * never touch the live map. The replanning group is skipped, since the
+   * queries are independent.
+   *
+   * @param _queries the planning problems
+   * @param _tolerance goal tolerance for all queries
+   * @return one result per query, in the order of the _queries
+   */
+  std::vector<PlanResult>
+  makePlans(const std::vector<PlanQuery>& _queries, double _tolerance);
+
+  /// @brief as above, but with the tolerance from the param-server
+  std::vector<PlanResult>
+  makePlans(const std::vector<PlanQuery>& _queries);
+
+  /**
+   * @brief Computes only the cost from _start to _goal.
+   *
+   * The path is not returned. Compared to makePlan
+   * - planners implementing gpp_interface::CostEstimateInterface are asked
+   *   for an estimate instead of a path (without the _tolerance; a failed
+   *   estimate reports MBF_FAILURE without a _message),
+   * - post-planning plugins with `affects_cost: false` are skipped (all
+   *   post-planning plugins are skipped, if the cost was estimated),
+   * - the replanning group is skipped and the result is not cached.
+   *
+   * @return outcome code as defined by mbf_msgs/GetPath
+   */
+  uint32_t
+  makeCost(const Pose& _start, const Pose& _goal, double _tolerance,
+           double& _cost, std::string& _message);
+
+  /// @brief batch version of makeCost (see makePlans) - the plans are empty
+  std::vector<PlanResult>
+  makeCosts(const std::vector<PlanQuery>& _queries, double _tolerance);
+
+  /// @brief statistics of all plugins, stored under "<group>/<plugin-name>"
+  using StatsMap = std::map<std::string, PluginStats>;
+
+  /// @brief returns the statistics of every loaded plugin (including the
+  /// plugins of the batch workers)
+  StatsMap
+  getStats() const;
+
+  /// @brief returns the counters of the cache (all zero, if disabled)
+  PlanCache::Stats
+  getCacheStats() const;
+
+  /**
+   * @brief writes the recorded trace in the Chrome trace format to _file
+   *
+   * @return false, if the tracing is disabled or the file can't be written
+   */
+  bool
+  dumpTrace(const std::string& _file) const;
+
+  /**
+   * @brief Reloads the plugin groups from the param-server.
+   *
+   * Plugins with an unchanged name and type keep their instance (and their
+   * statistics); only the other plugins are loaded and initialized. This
+   * happens while the pipeline may still plan. The groups are then swapped
+   * between two requests. The cache is cleared.
+   *
+   * Reused plugins are not initialized again - changes of their own
+   * parameters require a restart.
+   *
+   * @return false, if a new plugin could not be created or its
+   * initialization threw. The loaded groups remain unchanged then.
+   */
+  bool
+  reload();
+
 private:
+  using InitJobs = std::vector<std::function<void()>>;
+
+  /// @brief the optional interfaces of a plugin (nullptr if not implemented)
+  struct PluginMixins {
+    gpp_interface::OutcomeInterface* outcome = nullptr;
+    CostmapPlanner* planner = nullptr;  ///< behind the wrapper
+    gpp_interface::CostEstimateInterface* estimator = nullptr;
+    gpp_interface::PathSeedInterface* seed = nullptr;
+    gpp_interface::CostmapSnapshotInterface* snapshot = nullptr;
+  };
+
+  /// @brief one request passing the stages of the pipeline
+  struct PlanJob {
+    Pose start;  ///< altered by the pre-planning
+    Pose goal;   ///< altered by the pre-planning
+    double tolerance;
+    PlanCacheKey key;
+    PlanResult result;
+    // the snapshot for the post-planning group (nullptr if none was taken)
+    const costmap_2d::Costmap2D* snapshot = nullptr;
+    bool replanned = false;  ///< the replanning group reused the last path
+    uint64_t trace = 0;      ///< id of the request (see TraceRing)
+
+    // the pipelined mode: the caller's promise, the cancel_generation_ at the
+    // submission and the buffer of the snapshot
+    std::unique_ptr<std::promise<PlanResult>> promise;
+    size_t generation = 0;
+    std::unique_ptr<CostmapSnapshot> buffer;
+    // the full map for the post-planning, if the buffer is cropped
+    std::unique_ptr<CostmapSnapshot> full_buffer;
+    // the prefix of the planning, held back for the post-planning
+    Path prefix;
+  };
+
+  /// @brief the plugins of a (re)load, which are not committed yet
+  struct PendingGroups {
+    PrePlanningManager::PluginMap pre_planning;
+    PostPlanningManager::PluginMap post_planning;
+    ReplanningManager::PluginMap replanning;
+    GlobalPlannerManager::PluginMap planning;
+  };
+
+  /// @brief sets up the loading of the lazy plugins
+  void
+  setupLoaders();
+
+  /**
+   * @brief reads the plugin groups and creates the new plugins
+   *
+   * @param _jobs will contain the initialization of the new plugins. The
+   * caller must run them before calling commitGroups.
+   * @param _strict see ArrayPluginManager::prepare
+   */
+  PendingGroups
+  prepareGroups(ros::NodeHandle& _nh, InitJobs& _jobs, bool _strict = false);
+
+  /**
+   * @brief replaces the plugin groups and sets up their execution modes
+   *
+   * Don't call it while the pipeline is running.
+   *
+   * @return the dropped plugins
+   */
+  PendingGroups
+  commitGroups(ros::NodeHandle& _nh, PendingGroups&& _pending);
+
+  /// @brief callback of the reload service
   bool
-  prePlanning(Pose& _start, Pose& _goal, double _tolerance);
+  onReload(std_srvs::Trigger::Request& _req,
+           std_srvs::Trigger::Response& _res);
 
+  /// @brief callback of the dump_trace service
   bool
-  postPlanning(Path& _path, double& _cost);
+  onDumpTrace(std_srvs::Trigger::Request& _req,
+              std_srvs::Trigger::Response& _res);
+
+  /// @brief finishes the _span of a request. a slow request triggers a dump
+  /// of the trace (see runTraceDumps)
+  void
+  finishTrace(TraceSpan& _span);
+
+  /// @brief body of the trace_thread_: writes the triggered dumps into the
+  /// rotated files `<trace_file_ stem>_<n><extension>`
+  void
+  runTraceDumps();
+
+  /// @brief stops and joins the trace_thread_ (if running)
+  void
+  stopTraceDumps();
+
+  /// @brief runs the planning and the post-planning of one query of a batch
+  /// under the _trace (no cache, no replanning, no snapshot)
+  uint32_t
+  runQuery(const PlanQuery& _query, uint64_t _trace, double _tolerance,
+           bool _cost_only, Path& _plan, double& _cost, std::string& _message);
+
+  /// @brief implementation of makePlans and makeCosts
+  std::vector<PlanResult>
+  runBatch(const std::vector<PlanQuery>& _queries, double _tolerance,
+           bool _cost_only);
+
+  /// @brief runs all groups (the caller must hold the lockPipeline)
+  uint32_t
+  runPipeline(const Pose& _start, const Pose& _goal, double _tolerance,
+              Path& _plan, double& _cost, std::string& _message);
 
+  /**
+   * @brief runs the cache lookup and the pre-planning group
+   *
+   * @return false, if the _job is done (its outcome is set then)
+   */
   bool
-  globalPlanning(const Pose& _start, const Pose& _goal, Path& _plan,
+  runPreStage(PlanJob& _job);
+
+  /**
+   * @brief runs the replanning and planning groups on the _snapshot buffer
+   *
+   * If the planning succeeds on a cropped snapshot, the _full buffer receives
+   * a copy of the full map for the post-planning group (allocated on demand).
+   *
+   * @return false, if the _job is done (its outcome is set then)
+   */
+  bool
+  runPlanningStage(PlanJob& _job, CostmapSnapshot& _snapshot,
+                   std::unique_ptr<CostmapSnapshot>& _full);
+
+  /// @brief runs the post-planning group and stores the output
+  void
+  runPostStage(PlanJob& _job);
+
+  /// @brief main function of the async_worker_
+  void
+  runAsync();
+
+  /// @brief cancels the run of this pipeline and its active planner - but
+  /// neither the workers nor the pipelined stages (see cancel)
+  void
+  cancelRun();
+
+  /// @brief main function of the _stage's thread in the pipelined mode
+  void
+  runStage(size_t _stage);
+
+  /// @brief passes the output of the _job to its caller and recycles its
+  /// buffer (the caller must hold the async_mutex_)
+  void
+  finishJob(PlanJob& _job);
+
+  using PipelineLock = std::array<std::unique_lock<std::mutex>, 4>;
+
+  /**
+   * @brief locks the plan_mutex_ and the stages of the pipelined mode
+   *
+   * @param _try if set, the function does not block. check then the
+   * owns_lock of the returned locks
+   */
+  PipelineLock
+  lockPipeline(bool _try = false);
+
+  /// @brief returns an idle batch worker (or nullptr, if none is idle)
+  GlobalPlannerPipeline*
+  borrowWorker();
+
+  /// @brief returns all idle batch workers. with _all set, the function waits
+  /// until every worker is idle
+  std::vector<GlobalPlannerPipeline*>
+  borrowWorkers(bool _all);
+
+  /// @brief makes the _workers available again
+  void
+  returnWorkers(const std::vector<GlobalPlannerPipeline*>& _workers);
+
+  /// @brief main function of the speculation_thread_
+  void
+  runSpeculation();
+
+  /**
+   * @brief serves the request from a leg planned ahead (see speculate)
+   *
+   * @return true, if the _plan and the _cost are set
+   */
+  bool
+  useSpeculation(const Pose& _start, const Pose& _goal, Path& _plan,
                  double& _cost);
 
+  void
+  publishDiagnostics(const ros::WallTimerEvent& _event);
+
+  /**
+   * @brief runs the pre-planning group
+   *
+   * @param _outcome the outcome reported by a failed plugin (see
+   * gpp_interface::OutcomeInterface), MBF_FAILURE otherwise
+   */
+  bool
+  prePlanning(Pose& _start, Pose& _goal, double _tolerance, uint32_t& _outcome,
+              std::string& _message);
+
+  bool
+  postPlanning(Path& _path, double& _cost, bool _cost_only = false);
+
+  /// @brief true, if the planner of the _param reads the snapshot (or is not
+  /// loaded yet)
+  bool
+  readsSnapshot(const PluginParameter& _param) const;
+
+  /**
+   * @brief resolves the mixins of the loaded _plugin (see mixins_)
+   *
+   * Called by the commit and by the loaders of the lazy plugins. The entry of
+   * the _param must exist: the lazy plugins fill theirs without a lock.
+   */
+  void
+  resolveMixins(const PluginParameter& _param, PrePlanningInterface& _plugin);
+
+  /// @brief overload for the planning group
+  void
+  resolveMixins(const PluginParameter& _param, BaseGlobalPlanner& _plugin);
+
+  /// @brief returns the mixins of the plugin of the _param
+  const PluginMixins&
+  getMixins(const PluginParameter& _param) const;
+
+  /// @brief true, if all planners and post-planners read the snapshot (the
+  /// lazy ones count as readers, until they are loaded)
+  bool
+  readsOnlySnapshot() const;
+
+  /// @brief true, if the replanning group can reuse the last path
+  bool
+  canReplan(const Pose& _goal);
+
+  bool
+  replanning(const Pose& _start, const Pose& _goal, Path& _plan,
+             double& _cost);
+
+  /**
+   * @brief runs the planning group
+   *
+   * @param _outcome the outcome of the last planner (or MBF_FAILURE, if the
+   * group fails without a failing planner)
+   * @param _message the message of the last CostmapPlanner
+   * @param _consumers_only runs only the planners reading the snapshot (e.x.
+   * on a larger region of interest)
+   */
+  bool
+  globalPlanning(const Pose& _start, const Pose& _goal, double _tolerance,
+                 Path& _plan, double& _cost, uint32_t& _outcome,
+                 std::string& _message, bool _cost_only = false,
+                 bool _consumers_only = false);
+
+  /**
+   * @brief updates the _snapshot and passes it to the consumers of the
+   * replanning and planning groups
+   *
+   * If _crop is set, the snapshot is cropped to the region of interest of the
+   * _attempt (see gpp_interface::RegionOfInterestInterface).
+   *
+   * @return true, if the snapshot is smaller than the costmap
+   */
+  bool
+  takeSnapshot(const PlanJob& _job, size_t _attempt, bool _crop,
+               CostmapSnapshot& _snapshot);
+
+  /// @brief passes the _snapshot to the consumers of the replanning and
+  /// planning groups. _stamp is the revision of the RevisionLayer before the
+  /// _snapshot was taken (zero without the layer)
+  void
+  shareSnapshot(const costmap_2d::Costmap2D& _snapshot, uint64_t _stamp);
+
+  /// @brief passes the _snapshot to the consumers of the post-planning group
+  /// (nullptr is ignored)
+  void
+  sharePostSnapshot(const costmap_2d::Costmap2D* _snapshot);
+
+  /// @brief frees the path buffers exceeding the scratch_memory_
+  void
+  trimBuffers();
+
+  /// @brief passes the shared setup (cache, streaming, etc) to the _worker
+  void
+  configureWorker(GlobalPlannerPipeline& _worker) const;
+
+  /// @brief passes the _prefix to the callback and the topic
+  void
+  forwardPrefix(const Path& _prefix);
+
+  /// @brief forwards the prefixes of a plugin - or holds them back, until the
+  /// read-only plugins following the plugin accepted the path
+  struct PrefixForwarder : public gpp_interface::PathPrefixSink {
+    // not explicit: allows the aggregate initialization of prefix_sinks_
+    PrefixForwarder(GlobalPlannerPipeline& _pipeline) : pipeline_(_pipeline) {}
+
+    void
+    onPrefix(const Path& _prefix) override;
+
+    bool hold = false;  ///< set by commitGroups
+    Path held;          ///< the last prefix, which was held back
+
+  private:
+    GlobalPlannerPipeline& pipeline_;
+  };
+
+  /// @brief returns true, if someone receives the prefixes
+  inline bool
+  isStreaming() const noexcept {
+    return !speculating_ && (prefix_callback_ || publish_prefix_);
+  }
+
+  /// @brief adds a lazily loaded plugin to the consumers (nullptr is ignored)
+  void
+  addSnapshotConsumer(gpp_interface::CostmapSnapshotInterface* _consumer);
+
+  /// @brief as above, but for the post-planning group
+  void
+  addPostSnapshotConsumer(gpp_interface::CostmapSnapshotInterface* _consumer);
+
   double tolerance_;
   std::atomic_bool cancel_;
+  // incremented by every cancel (see runStage)
+  std::atomic_size_t cancel_generation_{0};
+  // cancel the plugins overrunning their time budgets. a watchdog holds one
+  // deadline, so every stage has its own
+  std::array<Watchdog, 3> watchdogs_;
+
+  // the planner currently running (nullptr if none). the mutex keeps the
+  // planner alive, while cancelRun calls it
+  BaseGlobalPlanner* active_planner_ = nullptr;
+  std::mutex active_mutex_;
+
+  // serializes all pipeline runs
+  std::mutex plan_mutex_;
+
+  // reloading: one reload at a time. the groups_mutex_ guards the layout of
+  // the groups against readers, which don't hold the plan_mutex_
+  std::mutex reload_mutex_;
+  mutable std::mutex groups_mutex_;
+  ros::ServiceServer reload_srv_;
+  size_t init_threads_ = 1;
+
+  // async api: we store at most one pending request
+  struct AsyncRequest {
+    Pose start;
+    Pose goal;
+    double tolerance;
+    std::promise<PlanResult> promise;
+  };
+
+  std::unique_ptr<AsyncRequest> pending_;
+  bool busy_ = false;
+  bool async_busy_ = false;  ///< the async_worker_ runs a request
+  bool stop_ = false;
+  std::mutex async_mutex_;
+  std::condition_variable async_cv_;
+  std::thread async_worker_;
+
+  // pipelined mode: every stage holds at most one queued job. the mutex of a
+  // stage is locked while it runs a job (see lockPipeline)
+  struct Stage {
+    std::unique_ptr<PlanJob> queued;
+    bool busy = false;
+    std::mutex mutex;
+    std::thread thread;
+  };
+
+  bool pipelined_ = false;
+  std::array<Stage, 3> stages_;
+  // the snapshot buffers of the finished jobs, for reuse
+  std::vector<std::unique_ptr<CostmapSnapshot>> snapshot_pool_;
+
+  // the mixins of the pre-planning and planning plugins, resolved once they
+  // are loaded. the entries are created by the commit (see resolveMixins)
+  std::map<const PluginParameter*, PluginMixins> mixins_;
+
+  // race mode of the planning group: one output buffer per planner
+  std::unique_ptr<ThreadPool> race_pool_;
+  RaceState race_state_;
+  std::vector<Path> race_plans_;
+  std::vector<double> race_costs_;
+  std::vector<std::string> race_messages_;
+
+  // buffer for the CompactPostPlanningInterface plugins
+  gpp_interface::CompactPath compact_plan_;
+
+  // runs the consecutive read-only post-planning plugins (nullptr if none)
+  std::unique_ptr<ThreadPool> post_pool_;
+
+  // batch planning: every worker is a pipeline with its own plugins. they
+  // are initialized under the namespace of the worker (empty for the
+  // pipeline itself)
+  std::string plugin_ns_;
+  std::unique_ptr<ThreadPool> batch_pool_;
+  std::vector<std::unique_ptr<GlobalPlannerPipeline>> batch_workers_;
+
+  // concurrent mode: the workers, which don't serve a request
+  bool concurrent_ = false;
+  // serializes the pre-planning of the pipeline and its workers, since it
+  // may alter the live map. the workers share the mutex of the pipeline
+  std::shared_ptr<std::mutex> pre_planning_mutex_ =
+      std::make_shared<std::mutex>();
+  std::vector<GlobalPlannerPipeline*> idle_workers_;
+  std::mutex workers_mutex_;
+  std::condition_variable workers_cv_;
+
+  // speculative planning: the legs of the mission ahead. a new call of
+  // speculate increments the generation, so the running leg is dropped
+  struct Speculation {
+    Pose start;
+    Pose goal;
+    Path plan;
+    double cost;
+  };
+
+  std::vector<Pose> speculation_goals_;
+  std::vector<Speculation> speculations_;
+  // the worker planning the running leg (nullptr if none): only a stale leg
+  // or the destructor cancels it
+  GlobalPlannerPipeline* speculation_worker_ = nullptr;
+  Pose speculation_start_;
+  Pose speculation_goal_;
+  size_t speculation_generation_ = 0;
+  bool speculation_pending_ = false;
+  // read while waiting for a worker (see runSpeculation)
+  std::atomic_bool speculation_stop_{false};
+  std::mutex speculation_mutex_;
+  std::condition_variable speculation_cv_;
+  std::thread speculation_thread_;
+  // validity check of a leg (as in ReusePath)
+  double speculation_distance_ = 0.5;
+  unsigned char speculation_lethal_ = costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+
+  // one copy of the costmap per request - only if someone reads it
+  CostmapSnapshot snapshot_;
+  std::vector<gpp_interface::CostmapSnapshotInterface*> snapshot_consumers_;
+  std::vector<gpp_interface::CostmapSnapshotInterface*>
+      post_snapshot_consumers_;
+  // the planning stage reads it, while a lazy plugin may be added
+  std::atomic_bool post_consumed_{false};
+  // the lazy plugins after the pre-planning, which aren't loaded yet: they
+  // might read the snapshot, so it is taken for them (see takeSnapshot)
+  std::atomic_size_t lazy_readers_{0};
+  // the snapshot of the current request (nullptr if none was taken)
+  const costmap_2d::Costmap2D* current_snapshot_ = nullptr;
+  // as above, but for the post-planning group (which may lag behind)
+  const costmap_2d::Costmap2D* current_post_snapshot_ = nullptr;
+  // fallback for the lazy post-planning consumers
+  CostmapSnapshot post_snapshot_;
+  // the full map for the post-planning, if the snapshot_ is cropped
+  std::unique_ptr<CostmapSnapshot> full_snapshot_;
+  // pre-planning plugin cropping the snapshot (nullptr if none). a lazy
+  // plugin may set it from another stage
+  std::atomic<gpp_interface::RegionOfInterestInterface*> roi_{nullptr};
+  // the revision of the RevisionLayer before the current snapshot was taken
+  // (zero without the layer)
+  uint64_t snapshot_stamp_ = 0;
+
+  // coarse_to_fine mode: the downsampled snapshot for the first planner and
+  // the revision of the snapshot it was built from
+  CostmapSnapshot coarse_;
+  unsigned int coarse_factor_ = 0;
+  uint64_t coarse_revision_ = 0;
+  bool coarse_valid_ = false;
+
+  // output of the preceding planner (see gpp_interface::PathSeedInterface)
+  Path seed_plan_;
+
+  // the path of the current request: the planners write into it and it is
+  // swapped with the caller's path, so neither loses its capacity
+  Path plan_buffer_;
+
+  // temporary memory for the plugins (see gpp_interface::ScratchInterface).
+  // every stage resets its own arena. the arenas and the path buffers keep
+  // up to scratch_memory_ bytes between the requests
+  std::array<gpp_interface::ScratchArena, 3> scratch_;
+  size_t scratch_memory_ = 1000000;
+
+  // streaming of the prefix: the plugin, which may stream (nullptr if none)
+  const PluginParameter* planning_stream_ = nullptr;
+  const PluginParameter* post_stream_ = nullptr;
+  PrefixCallback prefix_callback_;
+  bool publish_prefix_ = false;
+  ros::Publisher prefix_pub_;
+  // the sinks of the planning and of the post-planning stage
+  std::array<PrefixForwarder, 2> prefix_sinks_{{{*this}, {*this}}};
+  // set while the worker plans a leg ahead (see speculate): the leg isn't
+  // streamed, and the cancel of the owner doesn't abort it
+  std::atomic_bool speculating_{false};
+
+  // shared goal-keyed distance field (see gpp_interface::DistanceField).
+  // every stage has its own view, since the stages of the pipelined mode
+  // work on the maps of different jobs
+  DistanceFieldCache distance_field_;
+  std::array<DistanceFieldCache::View, 3> distance_views_{
+      {{distance_field_}, {distance_field_}, {distance_field_}}};
+
+  // optional cache of the pipeline's output (shared with the batch workers)
+  std::shared_ptr<PlanCache> cache_;
+  // counts the changes of the costmap (optional)
+  const RevisionLayer* revision_layer_ = nullptr;
+
+  // publishing of the statistics
+  ros::Publisher diagnostics_pub_;
+  ros::WallTimer diagnostics_timer_;
+
+  // tracing: the ring is installed while the pipeline lives. requests
+  // running longer than trace_slow_ seconds let the trace_thread_ dump it
+  // into one of trace_files_ rotated files. at most one dump is pending
+  std::unique_ptr<TraceRing> trace_;
+  double trace_slow_ = 0;
+  std::string trace_file_;
+  size_t trace_files_ = 10;
+  size_t trace_dumps_ = 0;
+  bool trace_pending_ = false;
+  bool trace_stop_ = false;
+  std::mutex trace_mutex_;
+  std::condition_variable trace_cv_;
+  std::thread trace_thread_;
+  ros::ServiceServer trace_srv_;
 
   // nav_core conforming members
   std::string name_;
   Map* costmap_ = nullptr;
 
+  // the last successful output (for the replanning group). the mutex guards
+  // it in the pipelined mode
+  std::mutex last_plan_mutex_;
+  Path last_plan_;
+  double last_cost_;
+  Pose last_goal_;
+
   PrePlanningManager pre_planning_;
-  PostPlanningManager post_planning_;
+  CompactPostPlanningManager post_planning_;
+  ReplanningManager replanning_;
   CostmapPlannerManager global_planning_;
 };
 
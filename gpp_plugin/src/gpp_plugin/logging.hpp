@@ -0,0 +1,42 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <ros/console.h>
+
+// logging on the hot path (every makePlan call). the debug messages go to the
+// named logger "ros.gpp_plugin.hot_path" and the warnings are throttled.
+// define GPP_DISABLE_HOT_PATH_LOGGING to compile the logging out entirely.
+#ifdef GPP_DISABLE_HOT_PATH_LOGGING
+#define GPP_HOT_DEBUG(_msg) \
+  do {                      \
+  } while (0)
+#define GPP_HOT_WARN(_msg) \
+  do {                     \
+  } while (0)
+#else
+#define GPP_HOT_DEBUG(_msg) ROS_DEBUG_STREAM_NAMED("hot_path", _msg)
+#define GPP_HOT_WARN(_msg) ROS_WARN_STREAM_THROTTLE(1, _msg)
+#endif
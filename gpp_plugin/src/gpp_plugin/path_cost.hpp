@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <gpp_interface/compact_path.hpp>
+#include <gpp_interface/compact_post_planning_interface.hpp>
+#include <gpp_interface/costmap_snapshot_interface.hpp>
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/costmap_2d.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Evaluates the costmap cells traversed by a path.
+ *
+ * The kernel works in three passes over contiguous buffers:
+ * - the poses of the CompactPath are converted to cells (branch-free, so the
+ *   compiler can vectorize it),
+ * - the segments between the poses are rasterized (8-connected), and
+ * - the costs of all cells are gathered for the sum and the maximum. On x86
+ *   cpus with AVX2 the gather loads eight cells per instruction (selected at
+ *   runtime), otherwise it falls back to four scalar accumulators.
+ *
+ * The buffers are reused between the calls: evaluating paths of similar
+ * length does not allocate. The kernel is not thread-safe - use one instance
+ * per thread.
+ *
+ * @code{cpp}
+ * PathCostKernel kernel;
+ * // lock the map, if it's the live one
+ * const auto result = kernel.evaluate(map, compact_path);
+ * if (!result.inside || result.max >= costmap_2d::LETHAL_OBSTACLE)
+ *   return false;
+ * @endcode
+ */
+struct PathCostKernel {
+  /// @brief output of the kernel
+  struct Result {
+    uint64_t sum = 0;       ///< sum over the costs of the traversed cells
+    unsigned char max = 0;  ///< maximum cost of the traversed cells
+    uint64_t diagonal = 0;  ///< sum over the cells reached diagonally
+    size_t cells = 0;       ///< number of traversed cells
+    bool inside = true;     ///< false, if a pose lies outside of the map
+  };
+
+  /**
+   * @brief evaluates the cells traversed by the _path
+   *
+   * If a pose lies outside of the _map, only inside is set to false.
+   *
+   * @param _map the costmap (must be locked)
+   */
+  Result
+  evaluate(const costmap_2d::Costmap2D& _map,
+           const gpp_interface::CompactPath& _path);
+
+  /// @brief the traversed cells of the last evaluate call (as map indices)
+  inline const std::vector<unsigned int>&
+  getCells() const noexcept {
+    return cells_;
+  }
+
+  /**
+   * @brief converts the coordinates of the _path into cells
+   *
+   * @return false, if a pose is outside of the _map
+   */
+  static bool
+  toCells(const costmap_2d::Costmap2D& _map,
+          const gpp_interface::CompactPath& _path, std::vector<int>& _mx,
+          std::vector<int>& _my);
+
+  /// @brief appends the 8-connected line from the first to the last cell
+  /// (without the first one) to the _cells
+  ///
+  /// The cells reached by a diagonal step are also appended to the _diagonal.
+  static void
+  rasterize(int _x0, int _y0, int _x1, int _y1, unsigned int _size_x,
+            std::vector<unsigned int>& _cells,
+            std::vector<unsigned int>* _diagonal = nullptr);
+
+  /// @brief gathers the _costs of the _cells
+  /// @param _map_size number of cells of the map
+  static Result
+  gather(const unsigned char* _costs, size_t _map_size,
+         const std::vector<unsigned int>& _cells) noexcept;
+
+private:
+  std::vector<int> mx_;
+  std::vector<int> my_;
+  std::vector<unsigned int> cells_;
+  std::vector<unsigned int> diagonal_;
+};
+
+/**
+ * @brief Checks the path for collisions and recomputes its cost.
+ *
+ * The plugin implements the gpp_interface::CompactPostPlanningInterface and
+ * evaluates the path with the PathCostKernel. It fails, if the path leaves
+ * the map or traverses a cell with a cost equal or above the lethal_cost.
+ * Otherwise it may replace the cost by the integral of the cell costs along
+ * the path (the sum of the costs times the resolution, where cells reached
+ * by a diagonal step weigh sqrt(2)). An empty path has the cost zero.
+ *
+ * If the pipeline provides a snapshot of the costmap, the check runs on the
+ * snapshot without locking the live map.
+ *
+ * @section Parameters
+ *
+ * The parameters are defined under the name of the plugin.
+ *
+ * @code{yaml}
+ * # cells with a cost equal or above are considered to be in collision
+ * lethal_cost: 253
+ * # replace the cost of the path
+ * update_cost: true
+ * @endcode
+ */
+struct PathCost : public gpp_interface::CompactPostPlanningInterface,
+                  public gpp_interface::CostmapSnapshotInterface {
+  bool
+  postProcess(Path& _path, double& _cost) override;
+
+  void
+  initialize(const std::string& _name, Map* _map) override;
+
+  void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) override;
+
+private:
+  /// @brief runs the kernel and applies the result
+  bool
+  check(const costmap_2d::Costmap2D& _map, const Path& _path, double& _cost);
+
+  Map* map_ = nullptr;
+  const costmap_2d::Costmap2D* snapshot_ = nullptr;
+  PathCostKernel kernel_;
+  unsigned char lethal_cost_ = costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+  bool update_cost_ = true;
+};
+
+}  // namespace gpp_plugin
@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/PoseStamped.h>
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Returns a hash over the content and the geometry of the _map.
+ *
+ * Two maps with the same revision are (with a very high probability) equal.
+ * The function reads the entire map. Lock the map before calling it.
+ */
+uint64_t
+costmapRevision(const costmap_2d::Costmap2D& _map) noexcept;
+
+/**
+ * @brief Returns a hash over the geometry of the _map and the _stamp.
+ *
+ * As above, but the content is represented by the _stamp (e.x. the revision
+ * of the RevisionLayer). The function runs in O(1).
+ */
+uint64_t
+costmapRevision(const costmap_2d::Costmap2D& _map, uint64_t _stamp) noexcept;
+
+/// @brief returns the yaw angle of the _pose
+double
+getYaw(const geometry_msgs::Pose& _pose) noexcept;
+
+/**
+ * @brief Key of the PlanCache
+ *
+ * The start and goal poses are quantized, so small deviations (e.x. from
+ * localization noise) map to the same key.
+ */
+struct PlanCacheKey {
+  std::array<int64_t, 6> poses;
+  int64_t tolerance;
+  uint64_t frame;
+  uint64_t revision;
+
+  bool
+  operator==(const PlanCacheKey& _other) const noexcept;
+};
+
+/// @brief hash functor for the PlanCacheKey
+struct PlanCacheKeyHash {
+  size_t
+  operator()(const PlanCacheKey& _key) const noexcept;
+};
+
+/**
+ * @brief LRU-cache storing the output of the pipeline.
+ *
+ * The cache is bounded by the number of entries and by the (approximate)
+ * memory of the stored paths. If one of the limits is exceeded, the least
+ * recently used entries are dropped. A single path larger than the memory
+ * limit is never stored.
+ *
+ * The class is thread-safe.
+ */
+struct PlanCache {
+  using Pose = geometry_msgs::PoseStamped;
+  using Path = std::vector<Pose>;
+
+  /// @brief parameters defining the cache
+  struct Parameter {
+    size_t capacity = 0;             ///< maximum number of entries
+    size_t memory = 0;               ///< maximum memory in bytes
+    double position_resolution = 0;  ///< in meters
+    double angle_resolution = 0;     ///< in radians
+  };
+
+  /// @brief counters of the cache
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t size = 0;
+    size_t memory = 0;
+  };
+
+  /// @throw std::invalid_argument if the resolutions are not positive
+  explicit PlanCache(const Parameter& _param);
+
+  /// @brief builds the key for the planning problem
+  PlanCacheKey
+  makeKey(const Pose& _start, const Pose& _goal, double _tolerance,
+          uint64_t _revision) const noexcept;
+
+  /**
+   * @brief looks up the _key
+   *
+   * @param _plan will contain the stored path on success
+   * @param _cost will contain the stored cost on success
+   * @return true, if the _key was found
+   */
+  bool
+  find(const PlanCacheKey& _key, Path& _plan, double& _cost);
+
+  /// @brief as find, but without copying the path
+  bool
+  findCost(const PlanCacheKey& _key, double& _cost);
+
+  /// @brief stores the _plan and _cost under the _key
+  void
+  insert(const PlanCacheKey& _key, const Path& _plan, double _cost);
+
+  /// @brief drops all entries
+  void
+  clear();
+
+  Stats
+  getStats() const;
+
+  /// @brief approximate memory of the _path in bytes
+  static size_t
+  memory(const Path& _path) noexcept;
+
+private:
+  struct Entry {
+    PlanCacheKey key;
+    Path plan;
+    double cost;
+    size_t memory;
+  };
+
+  using Lru = std::list<Entry>;
+
+  void
+  evict();
+
+  Parameter param_;
+  Lru lru_;
+  std::unordered_map<PlanCacheKey, Lru::iterator, PlanCacheKeyHash> map_;
+  Stats stats_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace gpp_plugin
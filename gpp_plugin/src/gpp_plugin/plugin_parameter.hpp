@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <xmlrpcpp/XmlRpcException.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+#include <string>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Parameters defining how to execute a plugin.
+ *
+ * If on_success_break is set to true, and the plugin is executed successfully,
+ * the entire plugin-group (pre-, post-planning or planning) succeeds.
+ *
+ * If on_failure_continue is set to true, and the plugin fails, its plugin-group
+ * continues the execution.
+ *
+ * If max_duration is positive, the plugin fails if it runs longer than
+ * max_duration seconds.
+ *
+ * If affects_cost is set to false, the plugin does not alter the cost. Such
+ * plugins are skipped if only the cost is requested.
+ *
+ * If lazy is set to true, the plugin is loaded and initialized when its group
+ * reaches it for the first time.
+ *
+ * If read_only is set to true, the plugin does not alter its input (e.x. a
+ * validation of the path). Consecutive read-only plugins may run
+ * concurrently, if they don't affect the cost either.
+ *
+ * If try_first is set to true, the adaptive ordering of the group (see
+ * PluginGroup::Ordering) keeps the plugin in front of its alternatives.
+ */
+struct PluginParameter {
+  std::string name;
+  std::string type;
+  bool on_success_break = false;
+  bool on_failure_break = true;
+  double max_duration = 0;
+  bool affects_cost = true;
+  bool lazy = false;
+  bool read_only = false;
+  bool try_first = false;
+};
+
+/**
+ * @brief returns true, if the result of the plugin decides its group
+ *
+ * This is the case, if the plugin succeeds with on_success_break or fails
+ * with on_failure_break. The group then returns the _success.
+ */
+inline bool
+_breaksGroup(const PluginParameter& _param, bool _success) noexcept {
+  return _success ? _param.on_success_break : _param.on_failure_break;
+}
+
+/// @brief helper to get a string element with the tag _tag from _v
+/// @throw XmlRpc::XmlRpcException if the tag is missing
+inline std::string
+_getStringElement(const XmlRpc::XmlRpcValue& _v, const std::string& _tag) {
+  // we have to check manually, since XmlRpc would just return _tag if its
+  // missing...
+  if (!_v.hasMember(_tag))
+    throw XmlRpc::XmlRpcException(_tag + " not found");
+
+  return static_cast<std::string>(_v[_tag]);
+}
+
+/// @brief helper to get any value from _v under _tag.
+/// If anything goes wrong, the function will fall-back to the _default value.
+template <typename _T>
+_T
+_getElement(const XmlRpc::XmlRpcValue& _v, const std::string& _tag,
+            const _T& _default) noexcept {
+  // check if the tag is defined (see above for explanation)
+  if (!_v.hasMember(_tag))
+    return _default;
+
+  // try to get the desired value
+  try {
+    return static_cast<_T>(_v[_tag]);
+  }
+  catch (XmlRpc::XmlRpcException& _ex) {
+    return _default;
+  }
+}
+
+/// @brief helper to get a number from _v under _tag.
+/// Unlike _getElement, the function accepts integers and doubles.
+inline double
+_getNumber(const XmlRpc::XmlRpcValue& _v, const std::string& _tag,
+           double _default) noexcept {
+  if (!_v.hasMember(_tag))
+    return _default;
+
+  // XmlRpc does not convert between the types
+  auto value = _v[_tag];
+  switch (value.getType()) {
+    case XmlRpc::XmlRpcValue::TypeInt: return static_cast<int>(value);
+    case XmlRpc::XmlRpcValue::TypeDouble: return static_cast<double>(value);
+    default: return _default;
+  }
+}
+
+/**
+ * @brief reads the PluginParameter from one element of a plugin array
+ *
+ * See ArrayPluginManager for the tags. The type is left empty if the element
+ * has no tag 'type'.
+ *
+ * @throw XmlRpc::XmlRpcException if the tag 'name' is missing
+ */
+inline PluginParameter
+readPluginParameter(const XmlRpc::XmlRpcValue& _element) {
+  PluginParameter param;
+  param.name = _getStringElement(_element, "name");
+  param.type = _getElement(_element, "type", std::string());
+  // lazy plugins are created on their first use (see PluginGroup::getPlugin)
+  param.lazy = _getElement(_element, "lazy", false);
+  param.on_failure_break = _getElement(_element, "on_failure_break", true);
+  param.on_success_break = _getElement(_element, "on_success_break", false);
+  param.max_duration = _getNumber(_element, "max_duration", 0.);
+  param.affects_cost = _getElement(_element, "affects_cost", true);
+  param.read_only = _getElement(_element, "read_only", false);
+  param.try_first = _getElement(_element, "try_first", false);
+  return param;
+}
+
+}  // namespace gpp_plugin
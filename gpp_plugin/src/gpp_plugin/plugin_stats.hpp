@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Histogram with logarithmic buckets for latencies.
+ *
+ * Every power of two (in microseconds) is split into four buckets, so the
+ * relative error of a percentile is below 25%. The histogram covers the range
+ * from one microsecond up to roughly four minutes - larger values end up in
+ * the last bucket.
+ *
+ * The class has a fixed size and does not allocate.
+ */
+struct LatencyHistogram {
+  using Duration = std::chrono::nanoseconds;
+
+  static constexpr size_t size = 112;
+
+  /// @brief adds one sample to the histogram
+  void
+  record(Duration _duration) noexcept;
+
+  /**
+   * @brief returns the upper bound of the bucket containing the percentile
+   *
+   * @param _q percentile in the range [0, 1], e.x. 0.95 for p95
+   * @return the latency in seconds (or zero, if the histogram is empty)
+   */
+  double
+  percentile(double _q) const noexcept;
+
+  inline size_t
+  count() const noexcept {
+    return count_;
+  }
+
+  /// @brief adds all samples of _other to this histogram
+  void
+  merge(const LatencyHistogram& _other) noexcept;
+
+  /// @brief maps microseconds to the bucket index
+  static size_t
+  index(uint64_t _us) noexcept;
+
+  /// @brief upper bound of a bucket in microseconds
+  static uint64_t
+  upperBound(size_t _index) noexcept;
+
+private:
+  std::array<size_t, size> buckets_{};
+  size_t count_ = 0;
+};
+
+/// @brief function returning the number of heap allocations so far
+using AllocationCounter = size_t (*)();
+
+/**
+ * @brief Installs a counter for the heap allocations.
+ *
+ * By default no counter is installed. Tools replacing the global operator new
+ * (e.x. benchmarks) may install one: the allocations of every plugin call are
+ * then added to its PluginStats. Pass nullptr to uninstall the counter.
+ */
+void
+setAllocationCounter(AllocationCounter _counter) noexcept;
+
+/// @brief returns the installed counter (or nullptr)
+AllocationCounter
+getAllocationCounter() noexcept;
+
+/**
+ * @brief Accumulated statistics of one plugin.
+ *
+ * Every invocation of the plugin is counted as a call. A call may either
+ * succeed or fail.
+ */
+struct PluginStats {
+  using Duration = LatencyHistogram::Duration;
+
+  size_t calls = 0;
+  size_t successes = 0;
+  size_t failures = 0;
+
+  /// accumulated runtime in seconds
+  double total = 0;
+
+  /// accumulated heap allocations (see setAllocationCounter)
+  size_t allocations = 0;
+
+  /// time in seconds to load the lazy instances (not counted as a call)
+  double load_time = 0;
+
+  LatencyHistogram latency;
+
+  /// @brief adds the outcome of one call to the statistics
+  void
+  record(bool _success, Duration _duration, size_t _allocations = 0) noexcept;
+
+  /// @brief adds the statistics of _other (e.x. of another instance)
+  void
+  merge(const PluginStats& _other) noexcept;
+
+  /// @brief average runtime of a call in seconds
+  double
+  mean() const noexcept;
+};
+
+}  // namespace gpp_plugin
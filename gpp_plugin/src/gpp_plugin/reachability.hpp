@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <gpp_interface/outcome_interface.hpp>
+#include <gpp_interface/pre_planning_interface.hpp>
+#include <costmap_2d/costmap_2d.h>
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Connected components of the free space of a costmap.
+ *
+ * The map labels the free cells of an 8-connected grid with a union-find
+ * structure. Two free cells with the same root are connected. The labels are
+ * updated on demand: cells which became free are merged into their
+ * neighbourhood. A new obstacle may split its component, which the
+ * union-find cannot undo: the remains of the touched components are flooded
+ * again - the other components keep their labels. Only a new geometry
+ * triggers a full relabelling.
+ *
+ * The class is not thread-safe.
+ */
+struct ReachabilityMap {
+  using Pose = geometry_msgs::PoseStamped;
+
+  /// @brief the kind of work an update did
+  enum class Update { NONE, INCREMENTAL, FULL };
+
+  /// @brief the answer of a query
+  enum class Verdict { REACHABLE, BLOCKED_GOAL, DISCONNECTED };
+
+  /**
+   * @brief brings the labels up to date with the _map
+   *
+   * @param _map the costmap (must be locked)
+   * @param _lethal cost from which on a cell is considered occupied
+   * @param _allow_unknown if true, cells without information are free
+   * @param _begin the first row, which may have changed
+   * @param _end the row past the last, which may have changed. A new
+   * geometry compares all rows
+   */
+  Update
+  update(const costmap_2d::Costmap2D& _map, unsigned char _lethal,
+         bool _allow_unknown, unsigned int _begin = 0,
+         unsigned int _end = std::numeric_limits<unsigned int>::max());
+
+  /**
+   * @brief checks if the _goal can be reached from the _start
+   *
+   * The _start connects to every free cell within the _start_tolerance, the
+   * _goal to every free cell within the _goal_tolerance. A _start without a
+   * free cell is never rejected.
+   */
+  Verdict
+  check(const Pose& _start, const Pose& _goal, double _start_tolerance,
+        double _goal_tolerance);
+
+  /// @brief true, if the map was never updated
+  inline bool
+  empty() const noexcept {
+    return free_.empty();
+  }
+
+private:
+  /// @brief returns the root of the free _cell
+  uint32_t
+  find(uint32_t _cell) noexcept;
+
+  void
+  merge(uint32_t _a, uint32_t _b) noexcept;
+
+  /// @brief calls _fn with the neighbours of the _cell (see connect)
+  template <typename _Fn>
+  void
+  forNeighbours(uint32_t _cell, bool _all, _Fn&& _fn) const noexcept;
+
+  /// @brief merges the free _cell with its free neighbours
+  void
+  connect(uint32_t _cell, bool _all) noexcept;
+
+  /// @brief labels the component of the free _seed with the _seed
+  void
+  flood(uint32_t _seed) noexcept;
+
+  /// @brief collects the roots of the free cells within _radius of _pose
+  void
+  collect(const Pose& _pose, double _radius, std::vector<uint32_t>& _roots);
+
+  unsigned int size_x_ = 0;
+  unsigned int size_y_ = 0;
+  double resolution_ = 0;
+  double origin_x_ = 0;
+  double origin_y_ = 0;
+
+  std::vector<uint8_t> free_;
+  std::vector<uint32_t> parent_;
+  // the cells flooded in the current epoch_
+  std::vector<uint32_t> visited_;
+  uint32_t epoch_ = 0;
+
+  // buffers of update, flood and check
+  std::vector<uint32_t> freed_;
+  std::vector<uint32_t> blocked_;
+  std::vector<uint32_t> queue_;
+  std::vector<uint32_t> start_roots_;
+  std::vector<uint32_t> goal_roots_;
+};
+
+/**
+ * @brief Rejects requests with an unreachable goal before the planning.
+ *
+ * The plugin keeps a ReachabilityMap of the costmap. If the goal lies in the
+ * component of the start, the request passes without touching the costmap.
+ * Otherwise the labels are updated under the lock of the costmap and the
+ * plugin checks again. With a RevisionLayer in the costmap the update
+ * compares only the rows changed since the last update (and nothing if the
+ * revision is unchanged); otherwise it compares the entire map.
+ *
+ * An unreachable request fails with mbf_msgs::GetPath::Result::BLOCKED_GOAL
+ * (the goal is occupied) or NO_PATH_FOUND (the goal lies in another
+ * component), so it never reaches the planning group.
+ *
+ * @section Parameters
+ *
+ * The parameters are defined under the name of the plugin.
+ *
+ * @code{yaml}
+ * # cells with a cost equal or above are considered to be occupied
+ * lethal_cost: 253
+ * # if true, cells without information are free
+ * allow_unknown: true
+ * # radius in meters around the start, which the robot may leave
+ * start_tolerance: 0.2
+ * @endcode
+ */
+struct Reachability : public gpp_interface::PrePlanningInterface,
+                      public gpp_interface::OutcomeInterface {
+  bool
+  preProcess(Pose& _start, Pose& _goal, Map& _map, double _tolerance) override;
+
+  void
+  initialize(const std::string& _name) override;
+
+  uint32_t
+  getOutcome(std::string& _message) override;
+
+private:
+  ReachabilityMap labels_;
+  // the revision of the costmap, which the labels_ reflect
+  uint64_t revision_ = 0;
+  unsigned char lethal_cost_ = 253;
+  bool allow_unknown_ = true;
+  double start_tolerance_ = 0.2;
+
+  uint32_t outcome_ = 0;
+  std::string message_;
+  std::mutex mutex_;
+};
+
+}  // namespace gpp_plugin
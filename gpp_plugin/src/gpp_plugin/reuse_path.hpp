@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <gpp_interface/costmap_snapshot_interface.hpp>
+#include <gpp_interface/replanning_interface.hpp>
+#include <costmap_2d/costmap_2d.h>
+
+#include <string>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Reuses the last path, if it is still collision-free.
+ *
+ * The plugin looks up the pose of the path closest to the start. The
+ * already traveled part before this pose is removed, and the cost is reduced
+ * by the traveled share of the path's length (see remainingCost). The cells
+ * of the remaining path (including the ones between two poses) are checked
+ * against the costmap. If the pipeline provides a snapshot of the costmap,
+ * the check runs on the snapshot without locking the live map.
+ *
+ * @section Parameters
+ *
+ * The parameters are defined under the name of the plugin.
+ *
+ * @code{yaml}
+ * # poses with a cost equal or above are considered to be in collision
+ * lethal_cost: 253
+ * # maximum distance in meters between the start and the path
+ * max_distance: 0.5
+ * @endcode
+ */
+struct ReusePath : public gpp_interface::ReplanningInterface,
+                   public gpp_interface::CostmapSnapshotInterface {
+  bool
+  reuse(const Pose& _start, const Pose& _goal, Path& _path,
+        double& _cost) override;
+
+  void
+  initialize(const std::string& _name, Map* _map) override;
+
+  void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) override;
+
+  /**
+   * @brief returns the index of the pose closest to the _start
+   *
+   * @return the size of the _path, if the _path is empty
+   */
+  static size_t
+  findClosest(const Pose& _start, const Path& _path) noexcept;
+
+  /**
+   * @brief returns the share of the _cost, which falls on the poses from
+   * _begin on
+   *
+   * The cost of the _path is split along its length: the planners don't
+   * report the cost per pose.
+   *
+   * @return the _cost, if the _path has no length
+   */
+  static double
+  remainingCost(const Path& _path, size_t _begin, double _cost) noexcept;
+
+  /**
+   * @brief checks if the path in the [_begin, _end) range is free
+   *
+   * The cells between two subsequent poses are checked as well - as
+   * 8-connected line on the resolution of the _map.
+   *
+   * @param _map the costmap (must be locked)
+   * @param _lethal cost from which on a cell is considered occupied
+   */
+  static bool
+  isFree(const costmap_2d::Costmap2D& _map, Path::const_iterator _begin,
+         Path::const_iterator _end, unsigned char _lethal) noexcept;
+
+private:
+  Map* map_ = nullptr;
+  const costmap_2d::Costmap2D* snapshot_ = nullptr;
+  unsigned char lethal_cost_ = costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+  double max_distance_ = 0.5;
+};
+
+}  // namespace gpp_plugin
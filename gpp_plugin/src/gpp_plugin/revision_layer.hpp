@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <costmap_2d/costmap_2d_ros.h>
+#include <costmap_2d/layer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Costmap layer counting the changes of the master grid
+ *
+ * The layer does not alter the costmap. It compares the cells, which the
+ * update of the layered costmap touched, with its own copy and increments the
+ * revision if one of them changed. The comparison runs on the update thread
+ * of the costmap: reading the revision is O(1).
+ *
+ * Add the layer as the last plugin of the costmap, so it sees the final
+ * costs. Writes bypassing the layered costmap are not detected.
+ */
+struct RevisionLayer : public costmap_2d::Layer {
+  void
+  updateBounds(double _robot_x, double _robot_y, double _robot_yaw,
+               double* _min_x, double* _min_y, double* _max_x,
+               double* _max_y) override;
+
+  void
+  updateCosts(costmap_2d::Costmap2D& _master, int _min_i, int _min_j,
+              int _max_i, int _max_j) override;
+
+  void
+  matchSize() override;
+
+  void
+  reset() override;
+
+  /// @brief returns the number of observed changes
+  uint64_t
+  getRevision() const noexcept;
+
+  /**
+   * @brief returns the rows [_begin, _end), which changed after the revision
+   * _since
+   *
+   * Call it under the lock of the costmap. Before the first update all rows
+   * are reported.
+   */
+  void
+  getChangedRows(uint64_t _since, unsigned int& _begin,
+                 unsigned int& _end) const;
+
+protected:
+  void
+  onInitialize() override;
+
+private:
+  std::vector<unsigned char> copy_;
+  // the revision of the last change per row
+  std::vector<uint64_t> rows_;
+  std::atomic<uint64_t> revision_{0};
+};
+
+/// @brief returns the RevisionLayer of the _map (or nullptr)
+const RevisionLayer*
+findRevisionLayer(costmap_2d::Costmap2DROS& _map);
+
+}  // namespace gpp_plugin
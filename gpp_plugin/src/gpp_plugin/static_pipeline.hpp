@@ -0,0 +1,444 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <gpp_interface/compact_path.hpp>
+#include <gpp_interface/compact_post_planning_interface.hpp>
+#include <gpp_interface/post_planning_interface.hpp>
+#include <gpp_interface/pre_planning_interface.hpp>
+#include <gpp_plugin/logging.hpp>
+#include <gpp_plugin/plugin_parameter.hpp>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <mbf_costmap_core/costmap_planner.h>
+#include <nav_core/base_global_planner.h>
+#include <ros/ros.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// the StaticPipeline is header-only. don't include gpp_plugin.hpp here, since
+// it defines the PluginDefinitions of the gpp_plugin library.
+
+namespace gpp_plugin {
+
+/**
+ * @brief Plugin group with plugin types known at compile time.
+ *
+ * The plugins are stored by value, in the order of the template arguments.
+ * Every plugin has a PluginParameter (see StaticPipeline for how they are
+ * loaded). Only the tags 'name', 'on_success_break' and 'on_failure_break'
+ * are used.
+ *
+ * @tparam _Plugins default constructible plugin types
+ */
+template <typename... _Plugins>
+struct StaticGroup {
+  static constexpr size_t size = sizeof...(_Plugins);
+
+  std::tuple<_Plugins...> plugins;
+  std::array<PluginParameter, size> params;
+  std::string name = "undefined";
+  bool default_value = true;
+};
+
+/// @brief end of the recursion: no break condition was triggered
+template <size_t _Index = 0, typename _Functor, typename... _Plugins>
+inline std::enable_if_t<_Index == sizeof...(_Plugins), bool>
+_runStaticPlugins(StaticGroup<_Plugins...>& _grp, _Functor&,
+                  const std::atomic_bool&) {
+  return _grp.default_value;
+}
+
+/**
+ * @brief Execution logic to run all plugins within one StaticGroup
+ *
+ * Follows the same rules as _runPlugins, but without the time budgets, the
+ * statistics and the lazy loading. The loop is unrolled at compile time, so
+ * the _func is instantiated (and can be inlined) for every plugin type.
+ *
+ * @param _grp a group of plugins
+ * @param _func a generic functor taking the plugin and returning true on
+ * success.
+ * @param _cancel boolean cancel flag.
+ */
+template <size_t _Index = 0, typename _Functor, typename... _Plugins>
+inline std::enable_if_t<(_Index < sizeof...(_Plugins)), bool>
+_runStaticPlugins(StaticGroup<_Plugins...>& _grp, _Functor& _func,
+                  const std::atomic_bool& _cancel) {
+  // allow the user to cancel the job
+  if (_cancel)
+    return false;
+
+  // we have failed - we can either abort or ignore
+  const auto& param = _grp.params[_Index];
+  const bool success = _func(std::get<_Index>(_grp.plugins));
+  if (!success)
+    GPP_HOT_WARN("[" << _grp.name << "]: failed at " << param.name);
+  if (_breaksGroup(param, success))
+    return success;
+
+  return _runStaticPlugins<_Index + 1>(_grp, _func, _cancel);
+}
+
+/// @brief calls _func on every element of the _tuple
+template <typename _Tuple, typename _Functor, size_t... _Is>
+inline void
+_forEach(_Tuple& _tuple, const _Functor& _func, std::index_sequence<_Is...>) {
+  // c++14 has no fold expressions
+  const int expand[] = {0, (_func(std::get<_Is>(_tuple)), 0)...};
+  (void)expand;
+}
+
+template <typename... _Plugins, typename _Functor>
+inline void
+_forEach(std::tuple<_Plugins...>& _tuple, const _Functor& _func) {
+  _forEach(_tuple, _func, std::index_sequence_for<_Plugins...>{});
+}
+
+/**
+ * @brief reads the parameters of the _grp from the array _resource
+ *
+ * Uses the same format as the ArrayPluginManager: the tag 'type' is ignored.
+ * If the array is missing or its size differs from the group, the plugins are
+ * named `<_resource>_<index>` and use the default tags.
+ */
+template <typename... _Plugins>
+void
+_loadStaticGroup(StaticGroup<_Plugins...>& _grp, const std::string& _resource,
+                 ros::NodeHandle& _nh, bool _default_value = true) {
+  _grp.name = _resource;
+  _grp.default_value = _nh.param(_resource + "_default_value", _default_value);
+  for (size_t ii = 0; ii != _grp.size; ++ii) {
+    _grp.params[ii] = PluginParameter{};
+    _grp.params[ii].name = _resource + "_" + std::to_string(ii);
+  }
+
+  XmlRpc::XmlRpcValue raw;
+  if (!_nh.getParam(_resource, raw))
+    return;
+
+  if (raw.getType() != XmlRpc::XmlRpcValue::TypeArray ||
+      raw.size() != static_cast<int>(_grp.size)) {
+    ROS_WARN_STREAM("[gpp]: " << _resource << " must be an array of size "
+                              << _grp.size);
+    return;
+  }
+
+  for (size_t ii = 0; ii != _grp.size; ++ii) {
+    try {
+      _grp.params[ii] = readPluginParameter(raw[static_cast<int>(ii)]);
+    }
+    catch (XmlRpc::XmlRpcException& _ex) {
+      ROS_WARN_STREAM("[gpp]: failed to read the tag: " << _ex.getMessage());
+    }
+  }
+}
+
+// the calls below are qualified with the plugin type: this resolves them at
+// compile time and allows the compiler to inline them.
+
+/// @brief calls preProcess without virtual dispatch
+template <typename _Plugin>
+inline bool
+_staticPreProcess(_Plugin& _plugin, geometry_msgs::PoseStamped& _start,
+                  geometry_msgs::PoseStamped& _goal,
+                  costmap_2d::Costmap2DROS& _map, double _tolerance) {
+  return _plugin._Plugin::preProcess(_start, _goal, _map, _tolerance);
+}
+
+/// @brief calls makePlan of a CostmapPlanner without virtual dispatch
+/// @param _outcome the outcome of the planner
+template <typename _Plugin>
+inline std::enable_if_t<
+    std::is_base_of<mbf_costmap_core::CostmapPlanner, _Plugin>::value, bool>
+_staticMakePlan(_Plugin& _plugin, const geometry_msgs::PoseStamped& _start,
+                const geometry_msgs::PoseStamped& _goal, double _tolerance,
+                std::vector<geometry_msgs::PoseStamped>& _plan, double& _cost,
+                std::string& _message, uint32_t& _outcome) {
+  _outcome = _plugin._Plugin::makePlan(_start, _goal, _tolerance, _plan, _cost,
+                                       _message);
+  return _outcome == 0;
+}
+
+/// @brief helper for the BaseGlobalPlanner: prefers the qualified call
+template <typename _Plugin>
+inline auto
+_staticMakePlan(_Plugin& _plugin, const geometry_msgs::PoseStamped& _start,
+                const geometry_msgs::PoseStamped& _goal,
+                std::vector<geometry_msgs::PoseStamped>& _plan, double& _cost,
+                int) -> decltype(_plugin._Plugin::makePlan(_start, _goal,
+                                                           _plan, _cost)) {
+  return _plugin._Plugin::makePlan(_start, _goal, _plan, _cost);
+}
+
+/// @brief helper for the BaseGlobalPlanner: the _Plugin hides the overload
+/// with the cost, so we have to use the virtual call
+template <typename _Plugin>
+inline bool
+_staticMakePlan(_Plugin& _plugin, const geometry_msgs::PoseStamped& _start,
+                const geometry_msgs::PoseStamped& _goal,
+                std::vector<geometry_msgs::PoseStamped>& _plan, double& _cost,
+                long) {
+  return static_cast<nav_core::BaseGlobalPlanner&>(_plugin).makePlan(
+      _start, _goal, _plan, _cost);
+}
+
+/// @brief calls makePlan of a BaseGlobalPlanner (if possible) without
+/// virtual dispatch
+/// @param _outcome the outcome of the planner (success or failure)
+template <typename _Plugin>
+inline std::enable_if_t<
+    !std::is_base_of<mbf_costmap_core::CostmapPlanner, _Plugin>::value, bool>
+_staticMakePlan(_Plugin& _plugin, const geometry_msgs::PoseStamped& _start,
+                const geometry_msgs::PoseStamped& _goal, double,
+                std::vector<geometry_msgs::PoseStamped>& _plan, double& _cost,
+                std::string&, uint32_t& _outcome) {
+  const bool success = _staticMakePlan(_plugin, _start, _goal, _plan, _cost, 0);
+  _outcome = success ? 0 : 50;
+  return success;
+}
+
+/// @brief forwards the cancel request to a CostmapPlanner
+template <typename _Plugin>
+inline std::enable_if_t<
+    std::is_base_of<mbf_costmap_core::CostmapPlanner, _Plugin>::value>
+_staticCancel(_Plugin& _plugin) {
+  _plugin.cancel();
+}
+
+/// @brief a BaseGlobalPlanner cannot be cancelled
+template <typename _Plugin>
+inline std::enable_if_t<
+    !std::is_base_of<mbf_costmap_core::CostmapPlanner, _Plugin>::value>
+_staticCancel(_Plugin&) {}
+
+/// @brief calls postProcess of a CompactPostPlanningInterface without
+/// virtual dispatch. the path is converted only, if the representation changes
+template <typename _Plugin>
+inline std::enable_if_t<
+    std::is_base_of<gpp_interface::CompactPostPlanningInterface,
+                    _Plugin>::value,
+    bool>
+_staticPostProcess(_Plugin& _plugin,
+                   std::vector<geometry_msgs::PoseStamped>& _path,
+                   gpp_interface::CompactPath& _compact, bool& _is_compact,
+                   double& _cost) {
+  if (!_is_compact)
+    gpp_interface::toCompact(_path, _compact);
+  _is_compact = true;
+  return _plugin._Plugin::postProcess(_compact, _cost);
+}
+
+/// @brief calls postProcess of a PostPlanningInterface without virtual
+/// dispatch
+template <typename _Plugin>
+inline std::enable_if_t<
+    !std::is_base_of<gpp_interface::CompactPostPlanningInterface,
+                     _Plugin>::value,
+    bool>
+_staticPostProcess(_Plugin& _plugin,
+                   std::vector<geometry_msgs::PoseStamped>& _path,
+                   gpp_interface::CompactPath& _compact, bool& _is_compact,
+                   double& _cost) {
+  if (_is_compact)
+    gpp_interface::fromCompact(_compact, _path);
+  _is_compact = false;
+  return _plugin._Plugin::postProcess(_path, _cost);
+}
+
+/**
+ * @brief Pipeline with plugin chains fixed at compile time.
+ *
+ * Header-only alternative to the GlobalPlannerPipeline for targets, where the
+ * plugins are known at build time. The plugins are not loaded with pluginlib,
+ * but stored by value. Every stage call is resolved at compile time (no
+ * virtual dispatch and no wrappers), so the compiler can inline it. The
+ * success/failure break semantics are the same as in the
+ * GlobalPlannerPipeline.
+ *
+ * @tparam _PrePlanning StaticGroup of gpp_interface::PrePlanningInterface
+ * plugins.
+ * @tparam _Planning StaticGroup of mbf_costmap_core::CostmapPlanner or
+ * nav_core::BaseGlobalPlanner plugins (they may be mixed).
+ * @tparam _PostPlanning StaticGroup of gpp_interface::PostPlanningInterface or
+ * gpp_interface::CompactPostPlanningInterface plugins (they may be mixed).
+ *
+ * @section Parameters
+ *
+ * The parameters `pre_planning`, `planning` and `post_planning` use the same
+ * format as for the GlobalPlannerPipeline. Their sizes must match the groups.
+ * The tag 'type' is ignored, since the types are defined by the template
+ * arguments. Time budgets, lazy loading, replanning, the cache, statistics
+ * and the costmap snapshots are not supported.
+ *
+ * @code{cpp}
+ * using MyPipeline = gpp_plugin::StaticPipeline<
+ *     gpp_plugin::StaticGroup<MyPrePlanning>,
+ *     gpp_plugin::StaticGroup<MyFastPlanner, MyFallbackPlanner>,
+ *     gpp_plugin::StaticGroup<MySmoother>>;
+ *
+ * // optionally export it as a plugin
+ * PLUGINLIB_EXPORT_CLASS(MyPipeline, nav_core::BaseGlobalPlanner);
+ * @endcode
+ */
+template <typename _PrePlanning, typename _Planning, typename _PostPlanning>
+struct StaticPipeline : public nav_core::BaseGlobalPlanner,
+                        public mbf_costmap_core::CostmapPlanner {
+  // define the interface types
+  using Pose = geometry_msgs::PoseStamped;
+  using Path = std::vector<Pose>;
+  using Map = costmap_2d::Costmap2DROS;
+
+  void
+  initialize(std::string _name, Map* _costmap) override {
+    costmap_ = _costmap;
+    ros::NodeHandle nh("~" + _name);
+    tolerance_ = nh.param("tolerance", 0.1);
+    _loadStaticGroup(pre_planning_, "pre_planning", nh);
+    _loadStaticGroup(planning_, "planning", nh);
+    _loadStaticGroup(post_planning_, "post_planning", nh);
+
+    // init the plugins
+    size_t ii = 0;
+    _forEach(pre_planning_.plugins, [&](auto& _plugin) {
+      _plugin.initialize(pre_planning_.params[ii++].name);
+    });
+    ii = 0;
+    _forEach(planning_.plugins, [&](auto& _plugin) {
+      _plugin.initialize(planning_.params[ii++].name, _costmap);
+    });
+    ii = 0;
+    _forEach(post_planning_.plugins, [&](auto& _plugin) {
+      _plugin.initialize(post_planning_.params[ii++].name, _costmap);
+    });
+  }
+
+  bool
+  makePlan(const Pose& _start, const Pose& _goal, Path& _plan) override {
+    double cost;
+    return makePlan(_start, _goal, _plan, cost);
+  }
+
+  bool
+  makePlan(const Pose& _start, const Pose& _goal, Path& _plan,
+           double& _cost) override {
+    std::string message;
+    return makePlan(_start, _goal, tolerance_, _plan, _cost, message) == 0;
+  }
+
+  uint32_t
+  makePlan(const Pose& _start, const Pose& _goal, double _tolerance,
+           Path& _plan, double& _cost, std::string& _message) override {
+    // outcome definition for mbf_costmap_core based plugins
+    constexpr uint32_t success = 0;
+    constexpr uint32_t failure = 50;
+    constexpr uint32_t canceled = 51;
+
+    cancel_ = false;
+    _plan.clear();
+
+    // local copies since the pre-planning might alter the poses
+    Pose start = _start;
+    Pose goal = _goal;
+    auto pre_planning = [&](auto& _plugin) {
+      return _staticPreProcess(_plugin, start, goal, *costmap_, _tolerance);
+    };
+    // the outcome of the last planner, which ran
+    uint32_t outcome = failure;
+    auto planning = [&](auto& _plugin) {
+      return _staticMakePlan(_plugin, start, goal, _tolerance, _plan, _cost,
+                             _message, outcome);
+    };
+    bool compact = false;
+    auto post_planning = [&](auto& _plugin) {
+      return _staticPostProcess(_plugin, _plan, compact_plan_, compact,
+                                _cost);
+    };
+
+    if (!_runStaticPlugins(pre_planning_, pre_planning, cancel_))
+      return cancel_ ? canceled : failure;
+
+    // keep the outcome of the last failing planner. the group may also fail
+    // without one (e.x. due to its default value)
+    if (!_runStaticPlugins(planning_, planning, cancel_)) {
+      if (cancel_)
+        return canceled;
+      return outcome == success ? failure : outcome;
+    }
+
+    const auto result = _runStaticPlugins(post_planning_, post_planning,
+                                          cancel_);
+    if (compact)
+      gpp_interface::fromCompact(compact_plan_, _plan);
+
+    if (result)
+      return success;
+    return cancel_ ? canceled : failure;
+  }
+
+  /// @brief cancels the pipeline and forwards the request to the planners
+  /// implementing the CostmapPlanner interface
+  bool
+  cancel() override {
+    cancel_ = true;
+    _forEach(planning_.plugins, [](auto& _plugin) { _staticCancel(_plugin); });
+    return true;
+  }
+
+  // access to the plugins, e.x. for setting them up programmatically
+  inline _PrePlanning&
+  getPrePlanning() noexcept {
+    return pre_planning_;
+  }
+
+  inline _Planning&
+  getPlanning() noexcept {
+    return planning_;
+  }
+
+  inline _PostPlanning&
+  getPostPlanning() noexcept {
+    return post_planning_;
+  }
+
+private:
+  _PrePlanning pre_planning_;
+  _Planning planning_;
+  _PostPlanning post_planning_;
+
+  double tolerance_ = 0.1;
+  std::atomic_bool cancel_{false};
+  gpp_interface::CompactPath compact_plan_;
+  Map* costmap_ = nullptr;
+};
+
+}  // namespace gpp_plugin
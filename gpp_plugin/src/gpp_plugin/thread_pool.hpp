@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Minimal fixed-size thread pool.
+ *
+ * The workers are started in the c'tor and joined in the d'tor. Jobs are
+ * picked up in the order of their submission, where the posted jobs go first.
+ * Pending jobs are still executed before the d'tor returns.
+ *
+ * @code{cpp}
+ * ThreadPool pool(2);
+ * auto result = pool.submit([]() { return 42; });
+ * assert(result.get() == 42);
+ * @endcode
+ */
+struct ThreadPool {
+  /// @param _size number of worker threads (at least one is started)
+  explicit ThreadPool(size_t _size);
+  ~ThreadPool();
+
+  /**
+   * @brief Enqueues the _func for the execution on one of the workers.
+   *
+   * @param _func a functor without arguments.
+   * @return future holding the result of the _func.
+   */
+  template <typename _Functor>
+  std::future<typename std::result_of<_Functor()>::type>
+  submit(_Functor&& _func);
+
+  /**
+   * @brief Enqueues the _job without taking its ownership.
+   *
+   * The caller must keep the _job alive until it has run. Unlike submit, this
+   * does not allocate - once the queue has held as many posted jobs before.
+   */
+  void
+  post(const std::function<void()>& _job);
+
+  inline size_t
+  size() const noexcept {
+    return workers_.size();
+  }
+
+private:
+  void
+  run();
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> jobs_;
+  // the posted jobs from posted_[next_] on are pending
+  std::vector<const std::function<void()>*> posted_;
+  size_t next_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+};
+
+template <typename _Functor>
+std::future<typename std::result_of<_Functor()>::type>
+ThreadPool::submit(_Functor&& _func) {
+  using Result = typename std::result_of<_Functor()>::type;
+  // std::function requires copyable targets, so we share the task
+  auto task = std::make_shared<std::packaged_task<Result()>>(
+      std::forward<_Functor>(_func));
+  auto future = task->get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.emplace([task]() { (*task)(); });
+  }
+  cv_.notify_one();
+  return future;
+}
+
+}  // namespace gpp_plugin
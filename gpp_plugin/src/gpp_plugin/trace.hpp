@@ -0,0 +1,200 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace gpp_plugin {
+
+/// @brief one finished span of the trace
+struct TraceEvent {
+  static constexpr size_t category_size = 16;
+  static constexpr size_t name_size = 40;
+
+  /// the span has an outcome (the flags below are valid)
+  static constexpr uint8_t outcome = 1;
+  /// the span succeeded
+  static constexpr uint8_t success = 2;
+  /// the span decided the result of its group (a break condition)
+  static constexpr uint8_t decisive = 4;
+
+  uint64_t begin;     ///< in nanoseconds of the steady clock
+  uint64_t duration;  ///< in nanoseconds
+  uint64_t request;   ///< id of the request (zero if unknown)
+  uint32_t thread;    ///< small id of the recording thread
+  uint8_t flags;
+  char category[category_size];  ///< truncated and null-terminated
+  char name[name_size];          ///< truncated and null-terminated
+};
+
+/**
+ * @brief Lock-free ring buffer of TraceEvents.
+ *
+ * Any number of threads may record concurrently: a record claims the next
+ * slot with one atomic increment and overwrites the oldest event. A reader
+ * copies the events without blocking the writers - events overwritten while
+ * reading are skipped.
+ *
+ * The ring has a fixed size and does not allocate after its construction.
+ */
+struct TraceRing {
+  using Clock = std::chrono::steady_clock;
+
+  /// @param _capacity number of events (rounded up to a power of two)
+  explicit TraceRing(size_t _capacity);
+
+  inline size_t
+  capacity() const noexcept {
+    return mask_ + 1;
+  }
+
+  /**
+   * @brief stores one span
+   *
+   * The strings are truncated to the sizes of the TraceEvent. The request is
+   * the one of the calling thread (see setTraceRequest).
+   */
+  void
+  record(const char* _category, const char* _name, Clock::time_point _begin,
+         Clock::time_point _end, uint8_t _flags = 0) noexcept;
+
+  /// @brief returns the stored events, the oldest first
+  std::vector<TraceEvent>
+  getEvents() const;
+
+  /**
+   * @brief writes the stored events in the Chrome trace format
+   *
+   * The output can be opened with chrome://tracing or ui.perfetto.dev.
+   */
+  void
+  dump(std::ostream& _os) const;
+
+private:
+  static constexpr size_t words = sizeof(TraceEvent) / sizeof(uint64_t);
+  static_assert(sizeof(TraceEvent) % sizeof(uint64_t) == 0,
+                "the event must consist of whole words");
+
+  // the event is stored as atomic words, so a reader never sees a torn
+  // state. the sequence is odd while the slot is written
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::array<std::atomic<uint64_t>, words> data;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_;
+  std::atomic<uint64_t> head_{0};
+};
+
+/**
+ * @brief Installs the ring receiving the spans of the pipeline.
+ *
+ * By default no ring is installed and tracing costs one atomic load per span.
+ * Pass nullptr to uninstall the ring. The ring must outlive its installation.
+ */
+void
+setTraceRing(TraceRing* _ring) noexcept;
+
+/// @brief returns the installed ring (or nullptr)
+#ifdef GPP_DISABLE_TRACING
+inline TraceRing*
+getTraceRing() noexcept {
+  return nullptr;
+}
+#else
+TraceRing*
+getTraceRing() noexcept;
+#endif
+
+/// @brief returns a new id for a request
+uint64_t
+newTraceRequest() noexcept;
+
+/// @brief sets the request, which the calling thread works on
+void
+setTraceRequest(uint64_t _request) noexcept;
+
+/**
+ * @brief Records the span from its construction to finish (or destruction).
+ *
+ * Does nothing, if no ring is installed. The strings must outlive the span.
+ *
+ * @code{cpp}
+ * TraceSpan span("lock", "costmap");
+ * boost::unique_lock<mutex_t> lock(*map.getMutex());
+ * span.finish();
+ * @endcode
+ */
+struct TraceSpan {
+  using Clock = TraceRing::Clock;
+
+  TraceSpan(const char* _category, const char* _name) noexcept :
+      ring_(getTraceRing()), category_(_category), name_(_name) {
+    if (ring_)
+      begin_ = Clock::now();
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan&
+  operator=(const TraceSpan&) = delete;
+
+  ~TraceSpan() {
+    finish();
+  }
+
+  /// @brief records the span. Subsequent calls do nothing
+  inline void
+  finish(uint8_t _flags = 0) noexcept {
+    if (!ring_)
+      return;
+    const auto end = Clock::now();
+    seconds_ = std::chrono::duration<double>(end - begin_).count();
+    ring_->record(category_, name_, begin_, end, _flags);
+    ring_ = nullptr;
+  }
+
+  /// @brief runtime of the finished span in seconds (zero, if not recorded)
+  inline double
+  getSeconds() const noexcept {
+    return seconds_;
+  }
+
+private:
+  TraceRing* ring_;
+  const char* category_;
+  const char* name_;
+  Clock::time_point begin_;
+  double seconds_ = 0;
+};
+
+}  // namespace gpp_plugin
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace gpp_plugin {
+
+/**
+ * @brief Calls a callback, if a deadline passes.
+ *
+ * The watchdog owns one thread, which is started with the first call to arm.
+ * At most one deadline can be armed at a time.
+ *
+ * @code{cpp}
+ * Watchdog watchdog;
+ * watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(100),
+ *              [&]() { planner.cancel(); });
+ * planner.makePlan(...);
+ * watchdog.disarm();
+ * @endcode
+ */
+struct Watchdog {
+  using Clock = std::chrono::steady_clock;
+  using Callback = std::function<void()>;
+
+  Watchdog() = default;
+  ~Watchdog();
+
+  /**
+   * @brief Calls the _callback from the watchdog's thread at the _deadline.
+   *
+   * Replaces any previously armed deadline.
+   */
+  void
+  arm(Clock::time_point _deadline, Callback _callback);
+
+  /**
+   * @brief Disarms the deadline.
+   *
+   * If the callback is running, the function blocks until it has finished.
+   * After the call, the callback won't be called anymore.
+   *
+   * @return true, if the callback has been called.
+   */
+  bool
+  disarm();
+
+private:
+  void
+  run();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  Callback callback_;
+  Clock::time_point deadline_;
+  size_t generation_ = 0;
+  bool armed_ = false;
+  bool firing_ = false;
+  bool fired_ = false;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace gpp_plugin
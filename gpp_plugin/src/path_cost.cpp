@@ -0,0 +1,286 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/logging.hpp>
+#include <gpp_plugin/path_cost.hpp>
+
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GPP_PATH_COST_AVX2
+#include <immintrin.h>
+#endif
+
+namespace gpp_plugin {
+
+bool
+PathCostKernel::toCells(const costmap_2d::Costmap2D& _map,
+                        const gpp_interface::CompactPath& _path,
+                        std::vector<int>& _mx, std::vector<int>& _my) {
+  const auto size = _path.size();
+  _mx.resize(size);
+  _my.resize(size);
+
+  const double inv = 1. / _map.getResolution();
+  const double ox = _map.getOriginX();
+  const double oy = _map.getOriginY();
+  const double sx = _map.getSizeInCellsX();
+  const double sy = _map.getSizeInCellsY();
+  const double* x = _path.x.data();
+  const double* y = _path.y.data();
+  int* mx = _mx.data();
+  int* my = _my.data();
+
+  // no branches within the loop: the bounds are accumulated and the
+  // coordinates are clamped, so the cast stays defined.
+  bool inside = true;
+  for (size_t ii = 0; ii < size; ++ii) {
+    const double fx = (x[ii] - ox) * inv;
+    const double fy = (y[ii] - oy) * inv;
+    inside &= (fx >= 0) & (fx < sx) & (fy >= 0) & (fy < sy);
+    mx[ii] = static_cast<int>(std::min(std::max(fx, 0.), sx - 1));
+    my[ii] = static_cast<int>(std::min(std::max(fy, 0.), sy - 1));
+  }
+  return inside;
+}
+
+void
+PathCostKernel::rasterize(int _x0, int _y0, int _x1, int _y1,
+                          unsigned int _size_x,
+                          std::vector<unsigned int>& _cells,
+                          std::vector<unsigned int>* _diagonal) {
+  // bresenham's line algorithm
+  const int dx = std::abs(_x1 - _x0);
+  const int dy = -std::abs(_y1 - _y0);
+  const int sx = _x0 < _x1 ? 1 : -1;
+  const int sy = _y0 < _y1 ? 1 : -1;
+  int error = dx + dy;
+  while (_x0 != _x1 || _y0 != _y1) {
+    const int e2 = 2 * error;
+    const bool step_x = e2 >= dy;
+    const bool step_y = e2 <= dx;
+    if (step_x) {
+      error += dy;
+      _x0 += sx;
+    }
+    if (step_y) {
+      error += dx;
+      _y0 += sy;
+    }
+    const auto cell = static_cast<unsigned int>(_y0) * _size_x + _x0;
+    _cells.push_back(cell);
+    if (_diagonal && step_x && step_y)
+      _diagonal->push_back(cell);
+  }
+}
+
+namespace {
+
+PathCostKernel::Result
+gatherScalar(const unsigned char* _costs, const unsigned int* _cells,
+             size_t _size) noexcept {
+  // four independent accumulators, so the cpu can overlap the loads
+  constexpr size_t lanes = 4;
+  std::array<uint64_t, lanes> sum{};
+  std::array<unsigned char, lanes> max{};
+  size_t ii = 0;
+  for (; ii + lanes <= _size; ii += lanes) {
+    for (size_t ll = 0; ll != lanes; ++ll) {
+      const auto cost = _costs[_cells[ii + ll]];
+      sum[ll] += cost;
+      max[ll] = std::max(max[ll], cost);
+    }
+  }
+
+  // the remainder
+  for (; ii != _size; ++ii) {
+    const auto cost = _costs[_cells[ii]];
+    sum[0] += cost;
+    max[0] = std::max(max[0], cost);
+  }
+
+  PathCostKernel::Result result;
+  result.cells = _size;
+  for (size_t ll = 0; ll != lanes; ++ll) {
+    result.sum += sum[ll];
+    result.max = std::max(result.max, max[ll]);
+  }
+  return result;
+}
+
+#ifdef GPP_PATH_COST_AVX2
+
+__attribute__((target("avx2"))) PathCostKernel::Result
+gatherAvx2(const unsigned char* _costs, size_t _map_size,
+           const unsigned int* _cells, size_t _size) noexcept {
+  // the gather loads four bytes per cell: the indices are clamped to the last
+  // full word of the map and the cost is shifted into the lowest byte.
+  const auto base = reinterpret_cast<const int*>(_costs);
+  const __m256i limit = _mm256_set1_epi32(static_cast<int>(_map_size - 4));
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i sum = zero;
+  __m256i max = zero;
+  size_t ii = 0;
+  for (; ii + 8 <= _size; ii += 8) {
+    const __m256i cells =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_cells + ii));
+    const __m256i clamped = _mm256_min_epu32(cells, limit);
+    const __m256i shift =
+        _mm256_slli_epi32(_mm256_sub_epi32(cells, clamped), 3);
+    const __m256i words = _mm256_i32gather_epi32(base, clamped, 1);
+    const __m256i costs =
+        _mm256_and_si256(_mm256_srlv_epi32(words, shift), mask);
+    // sums the bytes of each 64 bit lane (two costs) without overflow
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(costs, zero));
+    max = _mm256_max_epu32(max, costs);
+  }
+
+  std::array<uint64_t, 4> sums;
+  std::array<uint32_t, 8> maxs;
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums.data()), sum);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxs.data()), max);
+
+  // the remainder
+  auto result = gatherScalar(_costs, _cells + ii, _size - ii);
+  result.cells = _size;
+  for (const auto& value : sums)
+    result.sum += value;
+  for (const auto& value : maxs)
+    result.max = std::max(result.max, static_cast<unsigned char>(value));
+  return result;
+}
+
+#endif
+
+}  // namespace
+
+PathCostKernel::Result
+PathCostKernel::gather(const unsigned char* _costs, size_t _map_size,
+                       const std::vector<unsigned int>& _cells) noexcept {
+#ifdef GPP_PATH_COST_AVX2
+  // the indices of the gather are signed 32 bit integers
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  if (avx2 && _map_size >= 4 && _map_size <= INT_MAX)
+    return gatherAvx2(_costs, _map_size, _cells.data(), _cells.size());
+#endif
+  return gatherScalar(_costs, _cells.data(), _cells.size());
+}
+
+PathCostKernel::Result
+PathCostKernel::evaluate(const costmap_2d::Costmap2D& _map,
+                         const gpp_interface::CompactPath& _path) {
+  cells_.clear();
+  diagonal_.clear();
+  Result result;
+  const auto costs = _map.getCharMap();
+  if (_path.empty() || !costs)
+    return result;
+
+  if (!toCells(_map, _path, mx_, my_)) {
+    result.inside = false;
+    return result;
+  }
+
+  // the first cell and then the segments without their first cell
+  const auto size_x = _map.getSizeInCellsX();
+  cells_.push_back(static_cast<unsigned int>(my_.front()) * size_x +
+                   mx_.front());
+  for (size_t ii = 1; ii < mx_.size(); ++ii)
+    rasterize(mx_[ii - 1], my_[ii - 1], mx_[ii], my_[ii], size_x, cells_,
+              &diagonal_);
+
+  const auto map_size = size_x * _map.getSizeInCellsY();
+  result = gather(costs, map_size, cells_);
+  result.diagonal = gather(costs, map_size, diagonal_).sum;
+  return result;
+}
+
+bool
+PathCost::check(const costmap_2d::Costmap2D& _map, const Path& _path,
+                double& _cost) {
+  const auto result = kernel_.evaluate(_map, _path);
+  if (!result.inside) {
+    GPP_HOT_DEBUG("[path_cost]: path leaves the map");
+    return false;
+  }
+  if (result.max >= lethal_cost_) {
+    GPP_HOT_DEBUG("[path_cost]: path is blocked");
+    return false;
+  }
+  // the cells reached by a diagonal step weigh sqrt(2)
+  if (update_cost_)
+    _cost = (result.sum + (std::sqrt(2.) - 1) * result.diagonal) *
+            _map.getResolution();
+  return true;
+}
+
+bool
+PathCost::postProcess(Path& _path, double& _cost) {
+  // an empty path traverses no cells
+  if (_path.empty()) {
+    if (update_cost_)
+      _cost = 0;
+    return true;
+  }
+
+  if (!map_ && !snapshot_)
+    return false;
+
+  // the snapshot requires no locking
+  if (snapshot_)
+    return check(*snapshot_, _path, _cost);
+
+  const auto costmap = map_->getCostmap();
+  using mutex_t = costmap_2d::Costmap2D::mutex_t;
+  boost::unique_lock<mutex_t> lock(*costmap->getMutex());
+  return check(*costmap, _path, _cost);
+}
+
+void
+PathCost::setSnapshot(const costmap_2d::Costmap2D& _snapshot) {
+  snapshot_ = &_snapshot;
+}
+
+void
+PathCost::initialize(const std::string& _name, Map* _map) {
+  map_ = _map;
+  ros::NodeHandle nh("~" + _name);
+  const int lethal = nh.param("lethal_cost",
+                              int(costmap_2d::INSCRIBED_INFLATED_OBSTACLE));
+  lethal_cost_ = static_cast<unsigned char>(std::min(std::max(lethal, 1), 255));
+  update_cost_ = nh.param("update_cost", true);
+}
+
+}  // namespace gpp_plugin
+
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::PathCost,
+                       gpp_interface::CompactPostPlanningInterface);
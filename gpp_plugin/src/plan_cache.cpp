@@ -0,0 +1,239 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/plan_cache.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace gpp_plugin {
+
+/// @brief mixes the _value into the _seed (see boost::hash_combine)
+inline uint64_t
+_mix(uint64_t _seed, uint64_t _value) noexcept {
+  _value *= 0x9e3779b97f4a7c15ULL;
+  _value ^= _value >> 32;
+  return (_seed ^ _value) * 0xff51afd7ed558ccdULL;
+}
+
+/// @brief returns the bits of a double
+inline uint64_t
+_bits(double _value) noexcept {
+  uint64_t bits;
+  std::memcpy(&bits, &_value, sizeof(bits));
+  return bits;
+}
+
+/// @brief returns a hash over the geometry of the _map
+inline uint64_t
+_geometry(const costmap_2d::Costmap2D& _map) noexcept {
+  uint64_t hash = _mix(_map.getSizeInCellsX(), _map.getSizeInCellsY());
+  hash = _mix(hash, _bits(_map.getResolution()));
+  hash = _mix(hash, _bits(_map.getOriginX()));
+  return _mix(hash, _bits(_map.getOriginY()));
+}
+
+uint64_t
+costmapRevision(const costmap_2d::Costmap2D& _map, uint64_t _stamp) noexcept {
+  return _mix(_geometry(_map), _stamp);
+}
+
+uint64_t
+costmapRevision(const costmap_2d::Costmap2D& _map) noexcept {
+  uint64_t hash = _geometry(_map);
+
+  // the content: we use four independent lanes, so the cpu can pipeline the
+  // multiplications.
+  const unsigned char* data = _map.getCharMap();
+  const size_t size = _map.getSizeInCellsX() * _map.getSizeInCellsY();
+  if (!data)
+    return hash;
+
+  constexpr size_t lanes = 4;
+  constexpr size_t step = lanes * sizeof(uint64_t);
+  std::array<uint64_t, lanes> lane = {1, 2, 3, 4};
+  size_t ii = 0;
+  for (; ii + step <= size; ii += step) {
+    uint64_t words[lanes];
+    std::memcpy(words, data + ii, step);
+    for (size_t ll = 0; ll != lanes; ++ll)
+      lane[ll] = _mix(lane[ll], words[ll]);
+  }
+
+  // the remainder
+  for (; ii != size; ++ii)
+    hash = _mix(hash, data[ii]);
+
+  for (const auto& value : lane)
+    hash = _mix(hash, value);
+  return hash;
+}
+
+double
+getYaw(const geometry_msgs::Pose& _pose) noexcept {
+  const auto& q = _pose.orientation;
+  return std::atan2(2 * (q.w * q.z + q.x * q.y), 1 - 2 * (q.y * q.y + q.z * q.z));
+}
+
+bool
+PlanCacheKey::operator==(const PlanCacheKey& _other) const noexcept {
+  return poses == _other.poses && tolerance == _other.tolerance &&
+         frame == _other.frame && revision == _other.revision;
+}
+
+size_t
+PlanCacheKeyHash::operator()(const PlanCacheKey& _key) const noexcept {
+  uint64_t hash = _mix(_key.revision, _key.frame);
+  hash = _mix(hash, static_cast<uint64_t>(_key.tolerance));
+  for (const auto& value : _key.poses)
+    hash = _mix(hash, static_cast<uint64_t>(value));
+  return hash;
+}
+
+PlanCache::PlanCache(const Parameter& _param) : param_(_param) {
+  if (param_.position_resolution <= 0 || param_.angle_resolution <= 0)
+    throw std::invalid_argument("resolution must be positive");
+}
+
+PlanCacheKey
+PlanCache::makeKey(const Pose& _start, const Pose& _goal, double _tolerance,
+                   uint64_t _revision) const noexcept {
+  auto quantize = [](double _value, double _resolution) {
+    return static_cast<int64_t>(std::round(_value / _resolution));
+  };
+
+  const auto& pos_res = param_.position_resolution;
+  const auto& ang_res = param_.angle_resolution;
+
+  PlanCacheKey key;
+  key.poses = {quantize(_start.pose.position.x, pos_res),
+               quantize(_start.pose.position.y, pos_res),
+               quantize(getYaw(_start.pose), ang_res),
+               quantize(_goal.pose.position.x, pos_res),
+               quantize(_goal.pose.position.y, pos_res),
+               quantize(getYaw(_goal.pose), ang_res)};
+  key.tolerance = quantize(_tolerance, pos_res);
+  key.frame = _mix(std::hash<std::string>{}(_start.header.frame_id),
+                   std::hash<std::string>{}(_goal.header.frame_id));
+  key.revision = _revision;
+  return key;
+}
+
+bool
+PlanCache::find(const PlanCacheKey& _key, Path& _plan, double& _cost) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = map_.find(_key);
+  if (it == map_.end()) {
+    ++stats_.misses;
+    return false;
+  }
+
+  // mark the entry as the most recently used one
+  lru_.splice(lru_.begin(), lru_, it->second);
+  _plan = it->second->plan;
+  _cost = it->second->cost;
+  ++stats_.hits;
+  return true;
+}
+
+bool
+PlanCache::findCost(const PlanCacheKey& _key, double& _cost) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = map_.find(_key);
+  if (it == map_.end()) {
+    ++stats_.misses;
+    return false;
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second);
+  _cost = it->second->cost;
+  ++stats_.hits;
+  return true;
+}
+
+void
+PlanCache::insert(const PlanCacheKey& _key, const Path& _plan, double _cost) {
+  const auto size = memory(_plan);
+  if (!param_.capacity || size > param_.memory)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = map_.find(_key);
+  if (it != map_.end()) {
+    // replace the old entry
+    stats_.memory -= it->second->memory;
+    lru_.erase(it->second);
+    map_.erase(it);
+  }
+
+  lru_.push_front(Entry{_key, _plan, _cost, size});
+  map_.emplace(_key, lru_.begin());
+  stats_.memory += size;
+  evict();
+}
+
+void
+PlanCache::evict() {
+  // drop the least recently used entries
+  while (!lru_.empty() &&
+         (lru_.size() > param_.capacity || stats_.memory > param_.memory)) {
+    stats_.memory -= lru_.back().memory;
+    map_.erase(lru_.back().key);
+    lru_.pop_back();
+  }
+  stats_.size = lru_.size();
+}
+
+void
+PlanCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  map_.clear();
+  stats_.size = 0;
+  stats_.memory = 0;
+}
+
+PlanCache::Stats
+PlanCache::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+size_t
+PlanCache::memory(const Path& _path) noexcept {
+  size_t size = sizeof(Entry) + _path.size() * sizeof(Pose);
+  for (const auto& pose : _path) {
+    // strings exceeding the small-string-optimization live on the heap
+    const auto& frame = pose.header.frame_id;
+    const auto begin = reinterpret_cast<const char*>(&frame);
+    if (frame.data() < begin || frame.data() >= begin + sizeof(frame))
+      size += frame.capacity() + 1;
+  }
+  return size;
+}
+
+}  // namespace gpp_plugin
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/plugin_stats.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace gpp_plugin {
+
+constexpr size_t LatencyHistogram::size;
+
+size_t
+LatencyHistogram::index(uint64_t _us) noexcept {
+  // the first four buckets are exact
+  if (_us < 4)
+    return _us;
+
+  // position of the leading bit. the two bits below it define the sub-bucket
+  const size_t exp = 63 - __builtin_clzll(_us);
+  const size_t sub = (_us >> (exp - 2)) & 3;
+  return std::min(4 * (exp - 1) + sub, size - 1);
+}
+
+uint64_t
+LatencyHistogram::upperBound(size_t _index) noexcept {
+  if (_index < 4)
+    return _index + 1;
+
+  // inverse of LatencyHistogram::index
+  const uint64_t exp = _index / 4 + 1;
+  const uint64_t sub = _index % 4;
+  return (5 + sub) << (exp - 2);
+}
+
+void
+LatencyHistogram::record(Duration _duration) noexcept {
+  const auto us =
+      std::chrono::duration_cast<std::chrono::microseconds>(_duration).count();
+  ++buckets_[index(static_cast<uint64_t>(std::max<int64_t>(us, 0)))];
+  ++count_;
+}
+
+double
+LatencyHistogram::percentile(double _q) const noexcept {
+  if (!count_)
+    return 0;
+
+  // the rank of the sample we are looking for (at least the first one)
+  const auto q = std::min(std::max(_q, 0.), 1.);
+  const auto rank = std::max<size_t>(std::ceil(q * count_), 1);
+
+  size_t seen = 0;
+  for (size_t ii = 0; ii != size; ++ii) {
+    seen += buckets_[ii];
+    if (seen >= rank)
+      return upperBound(ii) * 1e-6;
+  }
+  return upperBound(size - 1) * 1e-6;
+}
+
+void
+LatencyHistogram::merge(const LatencyHistogram& _other) noexcept {
+  for (size_t ii = 0; ii != size; ++ii)
+    buckets_[ii] += _other.buckets_[ii];
+  count_ += _other.count_;
+}
+
+namespace {
+
+std::atomic<AllocationCounter> allocation_counter{nullptr};
+
+}  // namespace
+
+void
+setAllocationCounter(AllocationCounter _counter) noexcept {
+  allocation_counter = _counter;
+}
+
+AllocationCounter
+getAllocationCounter() noexcept {
+  return allocation_counter;
+}
+
+void
+PluginStats::record(bool _success, Duration _duration,
+                    size_t _allocations) noexcept {
+  ++calls;
+  allocations += _allocations;
+  if (_success)
+    ++successes;
+  else
+    ++failures;
+
+  total += std::chrono::duration<double>(_duration).count();
+  latency.record(_duration);
+}
+
+void
+PluginStats::merge(const PluginStats& _other) noexcept {
+  calls += _other.calls;
+  successes += _other.successes;
+  failures += _other.failures;
+  total += _other.total;
+  allocations += _other.allocations;
+  load_time += _other.load_time;
+  latency.merge(_other.latency);
+}
+
+double
+PluginStats::mean() const noexcept {
+  return calls ? total / calls : 0;
+}
+
+}  // namespace gpp_plugin
@@ -0,0 +1,319 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/logging.hpp>
+#include <gpp_plugin/reachability.hpp>
+#include <gpp_plugin/revision_layer.hpp>
+#include <gpp_plugin/trace.hpp>
+
+#include <costmap_2d/cost_values.h>
+#include <mbf_msgs/GetPathResult.h>
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gpp_plugin {
+
+ReachabilityMap::Update
+ReachabilityMap::update(const costmap_2d::Costmap2D& _map,
+                        const unsigned char _lethal, const bool _allow_unknown,
+                        const unsigned int _begin, const unsigned int _end) {
+  const auto size_x = _map.getSizeInCellsX();
+  const auto size_y = _map.getSizeInCellsY();
+  const auto size = static_cast<size_t>(size_x) * size_y;
+
+  // a new geometry invalidates all labels
+  const auto full = free_.empty() || size_x != size_x_ || size_y != size_y_ ||
+                    _map.getResolution() != resolution_ ||
+                    _map.getOriginX() != origin_x_ ||
+                    _map.getOriginY() != origin_y_;
+  if (full) {
+    size_x_ = size_x;
+    size_y_ = size_y;
+    resolution_ = _map.getResolution();
+    origin_x_ = _map.getOriginX();
+    origin_y_ = _map.getOriginY();
+    free_.assign(size, 0);
+    parent_.resize(size);
+    visited_.assign(size, 0);
+    epoch_ = 0;
+  }
+
+  // diff the occupancy of the rows, which may have changed
+  const auto costs = _map.getCharMap();
+  const auto begin = full ? 0 : std::min(_begin, size_y) * size_x;
+  const auto end = full ? size : std::min(_end, size_y) * size_x;
+  freed_.clear();
+  blocked_.clear();
+  for (uint32_t cell = begin; cell < end; ++cell) {
+    const auto cost = costs[cell];
+    const uint8_t free =
+        cost < _lethal ||
+        (_allow_unknown && cost == costmap_2d::NO_INFORMATION);
+    if (free == free_[cell])
+      continue;
+
+    if (free)
+      freed_.push_back(cell);
+    else
+      blocked_.push_back(cell);
+    free_[cell] = free;
+  }
+
+  if (full) {
+    // the raster order allows us to look only at the visited neighbours
+    for (uint32_t cell = 0; cell != size; ++cell) {
+      if (free_[cell]) {
+        parent_[cell] = cell;
+        connect(cell, false);
+      }
+    }
+    return Update::FULL;
+  }
+
+  if (freed_.empty() && blocked_.empty())
+    return Update::NONE;
+
+  // the freed cells may neighbour each other: reset all of them first
+  for (const auto cell : freed_)
+    parent_[cell] = cell;
+
+  // every remain of a split component neighbours a new obstacle: flooding
+  // from these neighbours relabels exactly the touched components
+  if (!blocked_.empty()) {
+    if (++epoch_ == 0) {
+      std::fill(visited_.begin(), visited_.end(), 0);
+      epoch_ = 1;
+    }
+    for (const auto cell : blocked_) {
+      forNeighbours(cell, true, [this](uint32_t _neighbour) {
+        if (free_[_neighbour] && visited_[_neighbour] != epoch_)
+          flood(_neighbour);
+      });
+    }
+  }
+
+  for (const auto cell : freed_)
+    connect(cell, true);
+  return Update::INCREMENTAL;
+}
+
+ReachabilityMap::Verdict
+ReachabilityMap::check(const Pose& _start, const Pose& _goal,
+                       const double _start_tolerance,
+                       const double _goal_tolerance) {
+  collect(_goal, _goal_tolerance, goal_roots_);
+  if (goal_roots_.empty())
+    return Verdict::BLOCKED_GOAL;
+
+  // we don't judge a start in collision: the planner may handle it
+  collect(_start, _start_tolerance, start_roots_);
+  if (start_roots_.empty())
+    return Verdict::REACHABLE;
+
+  // both vectors are sorted
+  auto g = goal_roots_.begin();
+  for (const auto root : start_roots_) {
+    g = std::lower_bound(g, goal_roots_.end(), root);
+    if (g == goal_roots_.end())
+      break;
+    if (*g == root)
+      return Verdict::REACHABLE;
+  }
+  return Verdict::DISCONNECTED;
+}
+
+uint32_t
+ReachabilityMap::find(uint32_t _cell) noexcept {
+  // path halving
+  while (parent_[_cell] != _cell) {
+    parent_[_cell] = parent_[parent_[_cell]];
+    _cell = parent_[_cell];
+  }
+  return _cell;
+}
+
+void
+ReachabilityMap::merge(const uint32_t _a, const uint32_t _b) noexcept {
+  const auto a = find(_a);
+  const auto b = find(_b);
+  if (a != b)
+    parent_[std::max(a, b)] = std::min(a, b);
+}
+
+template <typename _Fn>
+void
+ReachabilityMap::forNeighbours(const uint32_t _cell, const bool _all,
+                               _Fn&& _fn) const noexcept {
+  const int x = _cell % size_x_;
+  const int y = _cell / size_x_;
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      // without _all only the cells before _cell (in the raster order)
+      if ((dx == 0 && dy == 0) || (!_all && (dy > 0 || (dy == 0 && dx > 0))))
+        continue;
+
+      const int nx = x + dx;
+      const int ny = y + dy;
+      if (nx < 0 || ny < 0 || nx >= static_cast<int>(size_x_) ||
+          ny >= static_cast<int>(size_y_))
+        continue;
+
+      _fn(static_cast<uint32_t>(ny * size_x_ + nx));
+    }
+  }
+}
+
+void
+ReachabilityMap::connect(const uint32_t _cell, const bool _all) noexcept {
+  forNeighbours(_cell, _all, [&](uint32_t _neighbour) {
+    if (free_[_neighbour])
+      merge(_cell, _neighbour);
+  });
+}
+
+void
+ReachabilityMap::flood(const uint32_t _seed) noexcept {
+  // breadth-first: the _seed becomes the root of a flat tree
+  queue_.clear();
+  queue_.push_back(_seed);
+  visited_[_seed] = epoch_;
+  for (size_t ii = 0; ii != queue_.size(); ++ii) {
+    parent_[queue_[ii]] = _seed;
+    forNeighbours(queue_[ii], true, [this](uint32_t _neighbour) {
+      if (free_[_neighbour] && visited_[_neighbour] != epoch_) {
+        visited_[_neighbour] = epoch_;
+        queue_.push_back(_neighbour);
+      }
+    });
+  }
+}
+
+void
+ReachabilityMap::collect(const Pose& _pose, const double _radius,
+                         std::vector<uint32_t>& _roots) {
+  _roots.clear();
+  if (free_.empty())
+    return;
+
+  // all in cell units
+  const auto& p = _pose.pose.position;
+  const auto px = (p.x - origin_x_) / resolution_;
+  const auto py = (p.y - origin_y_) / resolution_;
+  const auto radius = std::max(_radius, 0.) / resolution_;
+
+  const auto min_x = std::max(std::floor(px - radius), 0.);
+  const auto min_y = std::max(std::floor(py - radius), 0.);
+  const auto max_x = std::min(std::floor(px + radius), size_x_ - 1.);
+  const auto max_y = std::min(std::floor(py + radius), size_y_ - 1.);
+
+  for (auto y = min_y; y <= max_y; ++y) {
+    for (auto x = min_x; x <= max_x; ++x) {
+      // the cell containing the _pose is always within the _radius
+      const auto inside = x == std::floor(px) && y == std::floor(py);
+      if (!inside && std::hypot(x + 0.5 - px, y + 0.5 - py) > radius)
+        continue;
+
+      const auto cell = static_cast<uint32_t>(y) * size_x_ +
+                        static_cast<uint32_t>(x);
+      if (free_[cell])
+        _roots.push_back(find(cell));
+    }
+  }
+
+  std::sort(_roots.begin(), _roots.end());
+  _roots.erase(std::unique(_roots.begin(), _roots.end()), _roots.end());
+}
+
+bool
+Reachability::preProcess(Pose& _start, Pose& _goal, Map& _map,
+                         const double _tolerance) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // outdated labels may only err on the reachable side: the planner has the
+  // final word. so we only update the labels if we are about to reject
+  if (!labels_.empty() &&
+      labels_.check(_start, _goal, start_tolerance_, _tolerance) ==
+          ReachabilityMap::Verdict::REACHABLE)
+    return true;
+
+  {
+    const auto costmap = _map.getCostmap();
+    using mutex_t = costmap_2d::Costmap2D::mutex_t;
+    boost::unique_lock<mutex_t> map_lock;
+    {
+      TraceSpan wait("lock", "costmap");
+      map_lock = boost::unique_lock<mutex_t>(*costmap->getMutex());
+    }
+
+    // the revision layer tells us, which rows to compare
+    const auto layer = findRevisionLayer(_map);
+    unsigned int begin = 0;
+    unsigned int end = costmap->getSizeInCellsY();
+    if (layer && !labels_.empty())
+      layer->getChangedRows(revision_, begin, end);
+    if (begin < end || labels_.empty())
+      labels_.update(*costmap, lethal_cost_, allow_unknown_, begin, end);
+    if (layer)
+      revision_ = layer->getRevision();
+  }
+
+  switch (labels_.check(_start, _goal, start_tolerance_, _tolerance)) {
+    case ReachabilityMap::Verdict::REACHABLE:
+      return true;
+    case ReachabilityMap::Verdict::BLOCKED_GOAL:
+      outcome_ = mbf_msgs::GetPathResult::BLOCKED_GOAL;
+      message_ = "the goal is occupied";
+      break;
+    case ReachabilityMap::Verdict::DISCONNECTED:
+      outcome_ = mbf_msgs::GetPathResult::NO_PATH_FOUND;
+      message_ = "the goal is not reachable from the start";
+      break;
+  }
+  GPP_HOT_DEBUG("[reachability]: " << message_);
+  return false;
+}
+
+uint32_t
+Reachability::getOutcome(std::string& _message) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  _message = message_;
+  return outcome_;
+}
+
+void
+Reachability::initialize(const std::string& _name) {
+  ros::NodeHandle nh("~" + _name);
+  const int lethal = nh.param("lethal_cost",
+                              int(costmap_2d::INSCRIBED_INFLATED_OBSTACLE));
+  lethal_cost_ = static_cast<unsigned char>(std::min(std::max(lethal, 1), 255));
+  allow_unknown_ = nh.param("allow_unknown", true);
+  start_tolerance_ = std::max(nh.param("start_tolerance", 0.2), 0.);
+}
+
+}  // namespace gpp_plugin
+
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::Reachability,
+                       gpp_interface::PrePlanningInterface);
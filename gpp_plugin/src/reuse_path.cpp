@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/reuse_path.hpp>
+
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace gpp_plugin {
+
+size_t
+ReusePath::findClosest(const Pose& _start, const Path& _path) noexcept {
+  size_t closest = _path.size();
+  double min_dist = std::numeric_limits<double>::max();
+  const auto& s = _start.pose.position;
+  for (size_t ii = 0; ii != _path.size(); ++ii) {
+    const auto& p = _path[ii].pose.position;
+    const auto dist = (p.x - s.x) * (p.x - s.x) + (p.y - s.y) * (p.y - s.y);
+    if (dist < min_dist) {
+      min_dist = dist;
+      closest = ii;
+    }
+  }
+  return closest;
+}
+
+/// @brief returns the length of the path [_begin, _end)
+inline double
+_length(ReusePath::Path::const_iterator _begin,
+        ReusePath::Path::const_iterator _end) noexcept {
+  double length = 0;
+  for (auto pose = _begin; pose != _end && std::next(pose) != _end; ++pose) {
+    const auto& a = pose->pose.position;
+    const auto& b = std::next(pose)->pose.position;
+    length += std::hypot(b.x - a.x, b.y - a.y);
+  }
+  return length;
+}
+
+double
+ReusePath::remainingCost(const Path& _path, const size_t _begin,
+                         const double _cost) noexcept {
+  const auto begin = _path.cbegin() + std::min(_begin, _path.size());
+  const auto total = _length(_path.cbegin(), _path.cend());
+  if (total <= 0)
+    return _cost;
+  return _cost * _length(begin, _path.cend()) / total;
+}
+
+/// @brief checks the 8-connected line from the first to the last cell
+/// (without the first one)
+inline bool
+_isFree(const costmap_2d::Costmap2D& _map, int _x0, int _y0, int _x1, int _y1,
+        unsigned char _lethal) noexcept {
+  // bresenham's line algorithm (see PathCostKernel::rasterize)
+  const int dx = std::abs(_x1 - _x0);
+  const int dy = -std::abs(_y1 - _y0);
+  const int sx = _x0 < _x1 ? 1 : -1;
+  const int sy = _y0 < _y1 ? 1 : -1;
+  int error = dx + dy;
+  while (_x0 != _x1 || _y0 != _y1) {
+    const int e2 = 2 * error;
+    if (e2 >= dy) {
+      error += dy;
+      _x0 += sx;
+    }
+    if (e2 <= dx) {
+      error += dx;
+      _y0 += sy;
+    }
+    if (_map.getCost(_x0, _y0) >= _lethal)
+      return false;
+  }
+  return true;
+}
+
+bool
+ReusePath::isFree(const costmap_2d::Costmap2D& _map,
+                  Path::const_iterator _begin, Path::const_iterator _end,
+                  unsigned char _lethal) noexcept {
+  unsigned int mx, my;
+  int last_x = 0, last_y = 0;
+  for (auto pose = _begin; pose != _end; ++pose) {
+    const auto& p = pose->pose.position;
+    // poses outside of the map are not free
+    if (!_map.worldToMap(p.x, p.y, mx, my))
+      return false;
+
+    // check the cells between two poses as well
+    const int x = mx, y = my;
+    if (pose == _begin ? _map.getCost(mx, my) >= _lethal
+                       : !_isFree(_map, last_x, last_y, x, y, _lethal))
+      return false;
+    last_x = x;
+    last_y = y;
+  }
+  return true;
+}
+
+bool
+ReusePath::reuse(const Pose& _start, const Pose&, Path& _path,
+                 double& _cost) {
+  if ((!map_ && !snapshot_) || _path.empty())
+    return false;
+
+  // the robot must still be close to the path
+  const auto closest = findClosest(_start, _path);
+  const auto& p = _path[closest].pose.position;
+  const auto& s = _start.pose.position;
+  const auto dist = std::hypot(p.x - s.x, p.y - s.y);
+  if (dist > max_distance_) {
+    ROS_DEBUG_STREAM("[reuse_path]: start is " << dist << " m off");
+    return false;
+  }
+
+  // check the remaining path - the snapshot requires no locking
+  bool free;
+  if (snapshot_)
+    free = isFree(*snapshot_, _path.cbegin() + closest, _path.cend(),
+                  lethal_cost_);
+  else {
+    const auto costmap = map_->getCostmap();
+    using mutex_t = costmap_2d::Costmap2D::mutex_t;
+    boost::unique_lock<mutex_t> lock(*costmap->getMutex());
+    free = isFree(*costmap, _path.cbegin() + closest, _path.cend(),
+                  lethal_cost_);
+  }
+
+  if (!free) {
+    ROS_DEBUG_STREAM("[reuse_path]: path is blocked");
+    return false;
+  }
+
+  // remove the traveled part - and its cost
+  _cost = remainingCost(_path, closest, _cost);
+  _path.erase(_path.begin(), _path.begin() + closest);
+  return true;
+}
+
+void
+ReusePath::setSnapshot(const costmap_2d::Costmap2D& _snapshot) {
+  snapshot_ = &_snapshot;
+}
+
+void
+ReusePath::initialize(const std::string& _name, Map* _map) {
+  map_ = _map;
+  ros::NodeHandle nh("~" + _name);
+  const int lethal = nh.param("lethal_cost",
+                              int(costmap_2d::INSCRIBED_INFLATED_OBSTACLE));
+  lethal_cost_ = static_cast<unsigned char>(std::min(std::max(lethal, 1), 255));
+  max_distance_ = nh.param("max_distance", 0.5);
+}
+
+}  // namespace gpp_plugin
+
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::ReusePath,
+                       gpp_interface::ReplanningInterface);
@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/revision_layer.hpp>
+
+#include <costmap_2d/layered_costmap.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <algorithm>
+
+namespace gpp_plugin {
+
+void
+RevisionLayer::onInitialize() {
+  current_ = true;
+  matchSize();
+}
+
+void
+RevisionLayer::updateBounds(double, double, double, double*, double*, double*,
+                            double*) {
+  // we only observe the bounds of the other layers
+}
+
+void
+RevisionLayer::updateCosts(costmap_2d::Costmap2D& _master, int _min_i,
+                           int _min_j, int _max_i, int _max_j) {
+  const int size_x = _master.getSizeInCellsX();
+  const int size_y = _master.getSizeInCellsY();
+  const unsigned char* data = _master.getCharMap();
+  if (copy_.size() != static_cast<size_t>(size_x) * size_y) {
+    // the first update (or a resize, which we missed)
+    copy_.assign(data, data + size_x * size_y);
+    rows_.assign(size_y, ++revision_);
+    return;
+  }
+
+  // the bounds are not clamped by the layered costmap
+  _min_i = std::max(_min_i, 0);
+  _min_j = std::max(_min_j, 0);
+  _max_i = std::min(_max_i, size_x);
+  _max_j = std::min(_max_j, size_y);
+
+  bool changed = false;
+  const auto next = revision_ + 1;
+  for (int jj = _min_j; jj < _max_j; ++jj) {
+    const auto begin = static_cast<size_t>(jj) * size_x + _min_i;
+    const auto end = begin + std::max(_max_i - _min_i, 0);
+    if (std::equal(data + begin, data + end, copy_.begin() + begin))
+      continue;
+    std::copy(data + begin, data + end, copy_.begin() + begin);
+    rows_[jj] = next;
+    changed = true;
+  }
+  if (changed)
+    ++revision_;
+}
+
+void
+RevisionLayer::matchSize() {
+  // the next update copies the entire map
+  copy_.clear();
+  rows_.clear();
+  ++revision_;
+}
+
+void
+RevisionLayer::reset() {
+  matchSize();
+}
+
+uint64_t
+RevisionLayer::getRevision() const noexcept {
+  return revision_;
+}
+
+void
+RevisionLayer::getChangedRows(const uint64_t _since, unsigned int& _begin,
+                              unsigned int& _end) const {
+  if (rows_.empty()) {
+    _begin = 0;
+    _end = std::numeric_limits<unsigned int>::max();
+    return;
+  }
+
+  const auto changed = [_since](uint64_t _row) { return _row > _since; };
+  const auto first = std::find_if(rows_.begin(), rows_.end(), changed);
+  const auto last = std::find_if(rows_.rbegin(), rows_.rend(), changed);
+  _begin = first - rows_.begin();
+  _end = std::max<unsigned int>(rows_.rend() - last, _begin);
+}
+
+const RevisionLayer*
+findRevisionLayer(costmap_2d::Costmap2DROS& _map) {
+  const auto layered = _map.getLayeredCostmap();
+  if (!layered)
+    return nullptr;
+
+  for (const auto& layer : *layered->getPlugins()) {
+    const auto revision = dynamic_cast<const RevisionLayer*>(layer.get());
+    if (revision)
+      return revision;
+  }
+  return nullptr;
+}
+
+}  // namespace gpp_plugin
+
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::RevisionLayer, costmap_2d::Layer);
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/thread_pool.hpp>
+
+#include <algorithm>
+
+namespace gpp_plugin {
+
+ThreadPool::ThreadPool(size_t _size) {
+  // a pool without workers would never run anything
+  _size = std::max<size_t>(_size, 1);
+  workers_.reserve(_size);
+  for (size_t ii = 0; ii != _size; ++ii)
+    workers_.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+}
+
+void
+ThreadPool::post(const std::function<void()>& _job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    posted_.push_back(&_job);
+  }
+  cv_.notify_one();
+}
+
+void
+ThreadPool::run() {
+  while (true) {
+    const std::function<void()>* posted = nullptr;
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() {
+        return stop_ || !jobs_.empty() || next_ != posted_.size();
+      });
+
+      if (next_ != posted_.size()) {
+        posted = posted_[next_++];
+        // the queue keeps its capacity for the next posts
+        if (next_ == posted_.size()) {
+          posted_.clear();
+          next_ = 0;
+        }
+      }
+      // drain the queue before we leave
+      else if (jobs_.empty())
+        return;
+      else {
+        job = std::move(jobs_.front());
+        jobs_.pop();
+      }
+    }
+    if (posted)
+      (*posted)();
+    else
+      job();
+  }
+}
+
+}  // namespace gpp_plugin
@@ -0,0 +1,198 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/trace.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace gpp_plugin {
+
+constexpr size_t TraceEvent::category_size;
+constexpr size_t TraceEvent::name_size;
+constexpr uint8_t TraceEvent::outcome;
+constexpr uint8_t TraceEvent::success;
+constexpr uint8_t TraceEvent::decisive;
+
+namespace {
+
+std::atomic<TraceRing*> trace_ring{nullptr};
+std::atomic<uint64_t> trace_requests{0};
+std::atomic<uint32_t> trace_threads{0};
+thread_local uint64_t trace_request = 0;
+
+/// @brief returns the small id of the calling thread
+uint32_t
+threadId() noexcept {
+  thread_local const uint32_t id = ++trace_threads;
+  return id;
+}
+
+/// @brief copies the _src into the _dst, truncating it
+template <size_t _N>
+void
+copyString(char (&_dst)[_N], const char* _src) noexcept {
+  size_t ii = 0;
+  for (; _src && _src[ii] && ii != _N - 1; ++ii)
+    _dst[ii] = _src[ii];
+  _dst[ii] = '\0';
+}
+
+/// @brief writes the _str as json-string
+void
+writeString(std::ostream& _os, const char* _str) {
+  _os << '"';
+  for (; *_str; ++_str) {
+    const auto c = *_str;
+    if (c == '"' || c == '\\')
+      _os << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      _os << ' ';
+    else
+      _os << c;
+  }
+  _os << '"';
+}
+
+}  // namespace
+
+TraceRing::TraceRing(size_t _capacity) {
+  size_t capacity = 1;
+  while (capacity < _capacity)
+    capacity *= 2;
+  mask_ = capacity - 1;
+  slots_.reset(new Slot[capacity]);
+  for (size_t ii = 0; ii != capacity; ++ii)
+    for (auto& word : slots_[ii].data)
+      word.store(0, std::memory_order_relaxed);
+}
+
+void
+TraceRing::record(const char* _category, const char* _name,
+                  Clock::time_point _begin, Clock::time_point _end,
+                  uint8_t _flags) noexcept {
+  TraceEvent event;
+  std::memset(&event, 0, sizeof(event));
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  event.begin = duration_cast<nanoseconds>(_begin.time_since_epoch()).count();
+  event.duration = duration_cast<nanoseconds>(_end - _begin).count();
+  event.request = trace_request;
+  event.thread = threadId();
+  event.flags = _flags;
+  copyString(event.category, _category);
+  copyString(event.name, _name);
+
+  std::array<uint64_t, words> raw;
+  std::memcpy(raw.data(), &event, sizeof(event));
+
+  // claim the slot. the sequence 2 * (position + 1) marks it as complete
+  const auto position = head_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[position & mask_];
+  slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t ii = 0; ii != words; ++ii)
+    slot.data[ii].store(raw[ii], std::memory_order_relaxed);
+  slot.sequence.store(2 * (position + 1), std::memory_order_release);
+}
+
+std::vector<TraceEvent>
+TraceRing::getEvents() const {
+  const auto head = head_.load(std::memory_order_acquire);
+  const auto begin = head > capacity() ? head - capacity() : 0;
+
+  std::vector<TraceEvent> events;
+  events.reserve(head - begin);
+  std::array<uint64_t, words> raw;
+  for (auto position = begin; position != head; ++position) {
+    const auto& slot = slots_[position & mask_];
+    const auto expected = 2 * (position + 1);
+    if (slot.sequence.load(std::memory_order_acquire) != expected)
+      continue;
+    for (size_t ii = 0; ii != words; ++ii)
+      raw[ii] = slot.data[ii].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // a writer has claimed the slot in the meantime
+    if (slot.sequence.load(std::memory_order_relaxed) != expected)
+      continue;
+
+    events.emplace_back();
+    std::memcpy(&events.back(), raw.data(), sizeof(TraceEvent));
+  }
+  return events;
+}
+
+void
+TraceRing::dump(std::ostream& _os) const {
+  const auto events = getEvents();
+  // complete events ("X") with microsecond timestamps
+  _os << "{\"traceEvents\":[";
+  _os << std::fixed << std::setprecision(3);
+  for (size_t ii = 0; ii != events.size(); ++ii) {
+    const auto& event = events[ii];
+    if (ii)
+      _os << ',';
+    _os << "\n{\"name\":";
+    writeString(_os, event.name);
+    _os << ",\"cat\":";
+    writeString(_os, event.category);
+    _os << ",\"ph\":\"X\",\"ts\":" << event.begin * 1e-3
+        << ",\"dur\":" << event.duration * 1e-3
+        << ",\"pid\":1,\"tid\":" << event.thread
+        << ",\"args\":{\"request\":" << event.request;
+    if (event.flags & TraceEvent::outcome) {
+      _os << ",\"success\":"
+          << (event.flags & TraceEvent::success ? "true" : "false")
+          << ",\"decisive\":"
+          << (event.flags & TraceEvent::decisive ? "true" : "false");
+    }
+    _os << "}}";
+  }
+  _os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void
+setTraceRing(TraceRing* _ring) noexcept {
+  trace_ring = _ring;
+}
+
+#ifndef GPP_DISABLE_TRACING
+TraceRing*
+getTraceRing() noexcept {
+  return trace_ring.load(std::memory_order_relaxed);
+}
+#endif
+
+uint64_t
+newTraceRequest() noexcept {
+  return ++trace_requests;
+}
+
+void
+setTraceRequest(uint64_t _request) noexcept {
+  trace_request = _request;
+}
+
+}  // namespace gpp_plugin
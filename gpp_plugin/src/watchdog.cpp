@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/watchdog.hpp>
+
+#include <utility>
+
+namespace gpp_plugin {
+
+Watchdog::~Watchdog() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void
+Watchdog::arm(Clock::time_point _deadline, Callback _callback) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // don't replace the callback while it's running
+    cv_.wait(lock, [this]() { return !firing_; });
+    if (!thread_.joinable())
+      thread_ = std::thread(&Watchdog::run, this);
+
+    callback_ = std::move(_callback);
+    deadline_ = _deadline;
+    armed_ = true;
+    fired_ = false;
+    ++generation_;
+  }
+  cv_.notify_all();
+}
+
+bool
+Watchdog::disarm() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return !firing_; });
+  armed_ = false;
+  return fired_;
+}
+
+void
+Watchdog::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    if (!armed_) {
+      cv_.wait(lock);
+      continue;
+    }
+
+    // wait for the deadline - or for a change of the arming
+    const auto generation = generation_;
+    const auto deadline = deadline_;
+    if (cv_.wait_until(lock, deadline) != std::cv_status::timeout ||
+        !armed_ || generation != generation_ || stop_)
+      continue;
+
+    // the deadline has passed: call the callback without holding the lock
+    auto callback = std::move(callback_);
+    armed_ = false;
+    firing_ = true;
+    lock.unlock();
+    if (callback)
+      callback();
+    lock.lock();
+    firing_ = false;
+    fired_ = true;
+    cv_.notify_all();
+  }
+}
+
+}  // namespace gpp_plugin
@@ -0,0 +1,54 @@
+#pragma once
+
+// replaces the global operator new and delete in order to count the heap
+// allocations. include this header in exactly one translation unit.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace gpp_plugin {
+namespace test {
+
+/// @brief number of heap allocations since the start of the program
+inline std::atomic_size_t&
+allocations() noexcept {
+  static std::atomic_size_t counter{0};
+  return counter;
+}
+
+}  // namespace test
+}  // namespace gpp_plugin
+
+void*
+operator new(std::size_t _size) {
+  ++gpp_plugin::test::allocations();
+  if (void* ptr = std::malloc(_size ? _size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void*
+operator new[](std::size_t _size) {
+  return operator new(_size);
+}
+
+void
+operator delete(void* _ptr) noexcept {
+  std::free(_ptr);
+}
+
+void
+operator delete[](void* _ptr) noexcept {
+  std::free(_ptr);
+}
+
+void
+operator delete(void* _ptr, std::size_t) noexcept {
+  std::free(_ptr);
+}
+
+void
+operator delete[](void* _ptr, std::size_t) noexcept {
+  std::free(_ptr);
+}
@@ -0,0 +1,86 @@
+#include "allocation_counter.hpp"
+
+#include <gpp_interface/compact_path.hpp>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace gpp_interface;
+
+namespace {
+
+using Pose = geometry_msgs::PoseStamped;
+using Path = std::vector<Pose>;
+
+// frame long enough to defeat the small string optimization
+const std::string frame = "a_frame_with_a_rather_long_name";
+
+Path
+makePath(size_t _size) {
+  Path path(_size);
+  for (size_t ii = 0; ii != _size; ++ii) {
+    const double yaw = 0.01 * ii;
+    path[ii].header.frame_id = frame;
+    path[ii].pose.position.x = ii;
+    path[ii].pose.position.y = -1. * ii;
+    path[ii].pose.orientation.z = std::sin(yaw / 2);
+    path[ii].pose.orientation.w = std::cos(yaw / 2);
+  }
+  return path;
+}
+
+}  // namespace
+
+TEST(CompactPathTest, RoundTrip) {
+  const auto path = makePath(100);
+  CompactPath compact;
+  toCompact(path, compact);
+  ASSERT_EQ(compact.size(), path.size());
+  EXPECT_EQ(compact.frame_id, frame);
+  EXPECT_NEAR(compact.yaw[10], 0.1, 1e-9);
+
+  Path output;
+  fromCompact(compact, output);
+  ASSERT_EQ(output.size(), path.size());
+  for (size_t ii = 0; ii != path.size(); ++ii) {
+    EXPECT_EQ(output[ii].header.frame_id, frame);
+    EXPECT_EQ(output[ii].pose.position.x, path[ii].pose.position.x);
+    EXPECT_EQ(output[ii].pose.position.y, path[ii].pose.position.y);
+    EXPECT_NEAR(output[ii].pose.orientation.z, path[ii].pose.orientation.z,
+                1e-9);
+    EXPECT_NEAR(output[ii].pose.orientation.w, path[ii].pose.orientation.w,
+                1e-9);
+  }
+}
+
+TEST(CompactPathTest, Empty) {
+  CompactPath compact;
+  toCompact(Path{}, compact);
+  EXPECT_TRUE(compact.empty());
+
+  Path output = makePath(3);
+  fromCompact(compact, output);
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(CompactPathTest, NoAllocation) {
+  // converting forth and back reuses the memory of both representations
+  auto path = makePath(1000);
+  CompactPath compact;
+  toCompact(path, compact);
+  fromCompact(compact, path);
+
+  const auto before = gpp_plugin::test::allocations().load();
+  for (size_t ii = 0; ii != 10; ++ii) {
+    toCompact(path, compact);
+    fromCompact(compact, path);
+  }
+  EXPECT_EQ(gpp_plugin::test::allocations() - before, 0);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+#include <gpp_plugin/costmap_snapshot.hpp>
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+
+TEST(CostmapSnapshotTest, Copy) {
+  costmap_2d::Costmap2D map(10, 20, 0.1, 1, 2);
+  map.setCost(3, 4, costmap_2d::LETHAL_OBSTACLE);
+
+  CostmapSnapshot snapshot;
+  snapshot.update(map);
+  EXPECT_EQ(snapshot.getSizeInCellsX(), 10);
+  EXPECT_EQ(snapshot.getSizeInCellsY(), 20);
+  EXPECT_EQ(snapshot.getResolution(), 0.1);
+  EXPECT_EQ(snapshot.getOriginX(), 1);
+  EXPECT_EQ(snapshot.getOriginY(), 2);
+  EXPECT_EQ(snapshot.getCost(3, 4), costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(snapshot.getCost(4, 3), costmap_2d::FREE_SPACE);
+
+  // the snapshot does not follow the source
+  map.setCost(3, 4, costmap_2d::FREE_SPACE);
+  EXPECT_EQ(snapshot.getCost(3, 4), costmap_2d::LETHAL_OBSTACLE);
+}
+
+TEST(CostmapSnapshotTest, Reuse) {
+  // the buffer is kept as long as the size does not change
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  CostmapSnapshot snapshot;
+  snapshot.update(map);
+  const auto buffer = snapshot.getCharMap();
+
+  map.setCost(1, 1, costmap_2d::LETHAL_OBSTACLE);
+  snapshot.update(map);
+  EXPECT_EQ(snapshot.getCharMap(), buffer);
+  EXPECT_EQ(snapshot.getCost(1, 1), costmap_2d::LETHAL_OBSTACLE);
+
+  // resize the source
+  map.resizeMap(5, 5, 0.2, 1, 1);
+  snapshot.update(map);
+  EXPECT_EQ(snapshot.getSizeInCellsX(), 5);
+  EXPECT_EQ(snapshot.getResolution(), 0.2);
+}
+
+TEST(CostmapSnapshotTest, Window) {
+  costmap_2d::Costmap2D map(10, 20, 0.1, 1, 2);
+  map.setCost(3, 4, costmap_2d::LETHAL_OBSTACLE);
+
+  // the window covers the cells [2, 5] x [3, 6]
+  CostmapSnapshot snapshot;
+  EXPECT_TRUE(snapshot.update(map, 1.25, 2.35, 1.55, 2.65));
+  EXPECT_EQ(snapshot.getSizeInCellsX(), 4);
+  EXPECT_EQ(snapshot.getSizeInCellsY(), 4);
+  EXPECT_NEAR(snapshot.getOriginX(), 1.2, 1e-9);
+  EXPECT_NEAR(snapshot.getOriginY(), 2.3, 1e-9);
+  EXPECT_EQ(snapshot.getCost(1, 1), costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(snapshot.getCost(2, 1), costmap_2d::FREE_SPACE);
+
+  // the window is clipped to the map
+  EXPECT_FALSE(snapshot.update(map, -100, -100, 100, 100));
+  EXPECT_EQ(snapshot.getSizeInCellsX(), 10);
+  EXPECT_EQ(snapshot.getSizeInCellsY(), 20);
+  EXPECT_EQ(snapshot.getOriginX(), 1);
+  EXPECT_EQ(snapshot.getCost(3, 4), costmap_2d::LETHAL_OBSTACLE);
+}
+
+TEST(CostmapSnapshotTest, Downsample) {
+  costmap_2d::Costmap2D map(10, 5, 0.1, 1, 2);
+  map.setCost(3, 4, costmap_2d::LETHAL_OBSTACLE);
+  map.setCost(9, 0, 10);
+
+  // the size is rounded up
+  CostmapSnapshot coarse;
+  coarse.downsample(map, 4);
+  EXPECT_EQ(coarse.getSizeInCellsX(), 3);
+  EXPECT_EQ(coarse.getSizeInCellsY(), 2);
+  EXPECT_NEAR(coarse.getResolution(), 0.4, 1e-9);
+  EXPECT_EQ(coarse.getOriginX(), 1);
+
+  // every cell holds the maximum of the covered cells
+  EXPECT_EQ(coarse.getCost(0, 1), costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(coarse.getCost(2, 0), 10);
+  EXPECT_EQ(coarse.getCost(1, 0), costmap_2d::FREE_SPACE);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
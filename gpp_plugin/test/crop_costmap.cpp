@@ -0,0 +1,53 @@
+#include "test_pipeline.hpp"
+
+#include <gpp_plugin/crop_costmap.hpp>
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+namespace {
+
+using Pose = CropCostmap::Pose;
+using Window = CropCostmap::Window;
+
+}  // namespace
+
+TEST(CropCostmapTest, MakeWindow) {
+  const auto window =
+      CropCostmap::makeWindow(makePose(3, -1), makePose(1, 2), 0.5);
+  EXPECT_EQ(window.min_x, 0.5);
+  EXPECT_EQ(window.min_y, -1.5);
+  EXPECT_EQ(window.max_x, 3.5);
+  EXPECT_EQ(window.max_y, 2.5);
+}
+
+TEST(CropCostmapTest, Grow) {
+  // default parameters: margin 2, growth 2 and three attempts
+  CropCostmap crop;
+  const auto start = makePose(0, 0);
+  const auto goal = makePose(1, 0);
+
+  Window window;
+  ASSERT_TRUE(crop.getRegionOfInterest(start, goal, 0, 0, window));
+  EXPECT_EQ(window.min_x, -2);
+  EXPECT_EQ(window.max_x, 3);
+
+  // the margin doubles with every attempt
+  ASSERT_TRUE(crop.getRegionOfInterest(start, goal, 0, 2, window));
+  EXPECT_EQ(window.min_x, -8);
+  EXPECT_EQ(window.max_y, 8);
+
+  // the tolerance enlarges the margin
+  ASSERT_TRUE(crop.getRegionOfInterest(start, goal, 0.5, 0, window));
+  EXPECT_EQ(window.min_x, -2.5);
+
+  // the last attempt uses the full map
+  EXPECT_FALSE(crop.getRegionOfInterest(start, goal, 0, 3, window));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
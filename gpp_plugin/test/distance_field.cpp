@@ -0,0 +1,91 @@
+#include "test_pipeline.hpp"
+
+#include <gpp_plugin/distance_field.hpp>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+TEST(DistanceFieldTest, Compute) {
+  costmap_2d::Costmap2D map(5, 5, 1, 0, 0);
+  // a wall at x = 2, open at the top
+  for (unsigned int yy = 0; yy != 4; ++yy)
+    map.setCost(2, yy, costmap_2d::LETHAL_OBSTACLE);
+
+  DistanceFieldCache::DistanceField field;
+  DistanceFieldCache::Heap heap;
+  DistanceFieldCache::compute(map, map.getIndex(0, 0), 253, field, heap);
+  ASSERT_EQ(field.size_x, 5);
+  EXPECT_EQ(field.getDistance(0, 0), 0);
+  EXPECT_EQ(field.getDistance(1, 0), 1);
+  EXPECT_NEAR(field.getDistance(1, 1), std::sqrt(2.), 1e-6);
+  EXPECT_TRUE(std::isinf(field.getDistance(2, 0)));
+
+  // the path goes around the wall
+  EXPECT_NEAR(field.getDistance(3, 0), 3 * std::sqrt(2.) + 5, 1e-5);
+}
+
+TEST(DistanceFieldTest, Cache) {
+  costmap_2d::Costmap2D map(5, 5, 1, 0, 0);
+  DistanceFieldCache cache;
+  DistanceFieldCache::View view(cache);
+
+  // without a map the field is empty
+  EXPECT_TRUE(view.getDistanceField(makePose(0.5, 0.5))->distances.empty());
+
+  view.setMap(map);
+  const auto field = view.getDistanceField(makePose(0.5, 0.5));
+  EXPECT_EQ(field->getDistance(0, 0), 0);
+  EXPECT_EQ(cache.getStats().misses, 1);
+
+  // same goal cell and same map: reused across requests
+  view.getDistanceField(makePose(0.7, 0.2));
+  view.setMap(map);
+  view.getDistanceField(makePose(0.5, 0.5));
+  EXPECT_EQ(cache.getStats().hits, 2);
+  EXPECT_EQ(cache.getStats().misses, 1);
+
+  // the map changes (a snapshot is not locked)
+  map.setCost(1, 1, costmap_2d::LETHAL_OBSTACLE);
+  view.setSnapshot(map);
+  const auto changed = view.getDistanceField(makePose(0.5, 0.5));
+  EXPECT_TRUE(std::isinf(changed->getDistance(1, 1)));
+  EXPECT_EQ(cache.getStats().misses, 2);
+
+  // the field we hold is not altered by the next computation
+  EXPECT_NEAR(field->getDistance(1, 1), std::sqrt(2.), 1e-6);
+
+  // a new goal
+  EXPECT_EQ(view.getDistanceField(makePose(4.5, 4.5))->getDistance(4, 4), 0);
+  EXPECT_EQ(cache.getStats().misses, 3);
+  EXPECT_EQ(changed->getDistance(0, 0), 0);
+}
+
+TEST(DistanceFieldTest, Views) {
+  // two views on different maps share the cache, but not their maps
+  costmap_2d::Costmap2D live(5, 5, 1, 0, 0);
+  costmap_2d::Costmap2D snapshot(5, 5, 1, 0, 0);
+  DistanceFieldCache cache;
+  DistanceFieldCache::View first(cache), second(cache);
+  first.setMap(live);
+  second.setSnapshot(snapshot);
+
+  // the same content: the second view reuses the field of the first one
+  const auto goal = makePose(0.5, 0.5);
+  EXPECT_EQ(first.getDistanceField(goal), second.getDistanceField(goal));
+  EXPECT_EQ(cache.getStats().hits, 1);
+
+  // the live map changes: the snapshot's field does not
+  live.setCost(1, 1, costmap_2d::LETHAL_OBSTACLE);
+  first.setMap(live);
+  EXPECT_TRUE(std::isinf(first.getDistanceField(goal)->getDistance(1, 1)));
+  EXPECT_FALSE(std::isinf(second.getDistanceField(goal)->getDistance(1, 1)));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
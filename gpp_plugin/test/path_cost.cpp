@@ -0,0 +1,122 @@
+#include <gpp_plugin/path_cost.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace gpp_plugin;
+
+namespace {
+
+gpp_interface::CompactPath
+makePath(std::vector<double> _x, std::vector<double> _y) {
+  gpp_interface::CompactPath path;
+  path.x = std::move(_x);
+  path.y = std::move(_y);
+  path.yaw.resize(path.x.size());
+  return path;
+}
+
+}  // namespace
+
+TEST(PathCostKernelTest, Rasterize) {
+  // a diagonal line
+  std::vector<unsigned int> cells;
+  PathCostKernel::rasterize(0, 0, 3, 3, 10, cells);
+  EXPECT_EQ(cells, (std::vector<unsigned int>{11, 22, 33}));
+
+  // a straight line backwards
+  cells.clear();
+  PathCostKernel::rasterize(3, 1, 0, 1, 10, cells);
+  EXPECT_EQ(cells, (std::vector<unsigned int>{12, 11, 10}));
+
+  // the same cell
+  cells.clear();
+  PathCostKernel::rasterize(2, 2, 2, 2, 10, cells);
+  EXPECT_TRUE(cells.empty());
+
+  // only the diagonal steps are collected
+  cells.clear();
+  std::vector<unsigned int> diagonal;
+  PathCostKernel::rasterize(0, 0, 3, 1, 10, cells, &diagonal);
+  EXPECT_EQ(cells.size(), 3);
+  EXPECT_EQ(diagonal.size(), 1);
+}
+
+TEST(PathCostKernelTest, Gather) {
+  // the map size is not a multiple of four and the last cell is gathered
+  std::vector<unsigned char> costs(35);
+  for (size_t ii = 0; ii != costs.size(); ++ii)
+    costs[ii] = static_cast<unsigned char>(ii * 7);
+
+  std::vector<unsigned int> cells;
+  for (unsigned int ii = 0; ii != 3 * costs.size(); ++ii)
+    cells.push_back((ii * 13) % costs.size());
+  cells.push_back(34);
+
+  uint64_t sum = 0;
+  unsigned char max = 0;
+  for (const auto& cell : cells) {
+    sum += costs[cell];
+    max = std::max(max, costs[cell]);
+  }
+
+  const auto result = PathCostKernel::gather(costs.data(), costs.size(), cells);
+  EXPECT_EQ(result.cells, cells.size());
+  EXPECT_EQ(result.sum, sum);
+  EXPECT_EQ(result.max, max);
+}
+
+TEST(PathCostKernelTest, Evaluate) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  for (unsigned int xx = 0; xx != 10; ++xx)
+    map.setCost(xx, 0, 10);
+  map.setCost(7, 0, 100);
+
+  // segments from (0, 0) over (5, 0) to (9, 0)
+  PathCostKernel kernel;
+  const auto path = makePath({0.05, 0.55, 0.95}, {0.05, 0.05, 0.05});
+  const auto result = kernel.evaluate(map, path);
+  EXPECT_TRUE(result.inside);
+  EXPECT_EQ(result.cells, 10);
+  EXPECT_EQ(result.sum, 9 * 10 + 100);
+  EXPECT_EQ(result.max, 100);
+  EXPECT_EQ(kernel.getCells().front(), 0);
+  EXPECT_EQ(kernel.getCells().back(), 9);
+
+  // a pose outside of the map
+  const auto outside = makePath({0.05, -0.05}, {0.05, 0.05});
+  EXPECT_FALSE(kernel.evaluate(map, outside).inside);
+}
+
+TEST(PathCostTest, PostProcess) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  map.setCost(5, 5, costmap_2d::LETHAL_OBSTACLE);
+  map.setCost(1, 1, 10);
+
+  // without a map the plugin fails
+  PathCost plugin;
+  auto path = makePath({0.05, 0.35}, {0.05, 0.35});
+  double cost = 0;
+  EXPECT_FALSE(plugin.postProcess(path, cost));
+
+  // the cost is updated: the cell (1, 1) is reached by a diagonal step
+  plugin.setSnapshot(map);
+  ASSERT_TRUE(plugin.postProcess(path, cost));
+  EXPECT_NEAR(cost, std::sqrt(2.), 1e-9);
+
+  // an empty path has no cost
+  gpp_interface::CompactPath empty;
+  ASSERT_TRUE(plugin.postProcess(empty, cost));
+  EXPECT_EQ(cost, 0);
+
+  // the path is blocked
+  path = makePath({0.05, 0.95}, {0.05, 0.95});
+  EXPECT_FALSE(plugin.postProcess(path, cost));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
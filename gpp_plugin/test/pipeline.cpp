@@ -0,0 +1,684 @@
+#include "test_pipeline.hpp"
+
+#include <gpp_plugin/gpp_plugin.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+using Path = std::vector<geometry_msgs::PoseStamped>;
+
+TEST(PipelineTest, Replanning) {
+  // a reused path skips the planning
+  setPlugins("replan", "replanning", {{"reuse", "gpp_plugin::ReusePath"}});
+  setPlugins("replan", "planning",
+             {{"straight", "gpp_plugin::test::StraightPlanning"}});
+
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("replan", map.costmap.get());
+
+  const auto goal = makePose(8, 1.05);
+  Path plan;
+  double cost;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(makePose(1, 1.05), goal, 0.1, plan, cost,
+                              message),
+            0);
+  ASSERT_FALSE(plan.empty());
+  EXPECT_EQ(pipeline.getStats()["planning/straight"].calls, 1u);
+
+  // the robot has moved along the path: the planner doesn't run
+  ASSERT_EQ(pipeline.makePlan(makePose(2, 1.05), goal, 0.1, plan, cost,
+                              message),
+            0);
+  ASSERT_FALSE(plan.empty());
+  EXPECT_NEAR(plan.front().pose.position.x, 2, 0.1);
+  EXPECT_EQ(pipeline.getStats()["replanning/reuse"].calls, 1u);
+  EXPECT_EQ(pipeline.getStats()["planning/straight"].calls, 1u);
+
+  // block the path: now we have to plan again
+  map.costmap->getCostmap()->setCost(50, 10, costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(pipeline.makePlan(makePose(3, 1.05), goal, 0.1, plan, cost,
+                              message),
+            0);
+  EXPECT_EQ(pipeline.getStats()["replanning/reuse"].calls, 2u);
+  EXPECT_EQ(pipeline.getStats()["planning/straight"].calls, 2u);
+  EXPECT_NEAR(plan.front().pose.position.x, 3, 1e-3);
+}
+
+TEST(PipelineTest, Outcome) {
+  // the planner receives the tolerance of the request. the outcome and the
+  // message of the failing plugin reach the caller
+  setPlugins("outcome", "pre_planning",
+             {{"outcome_pre", "gpp_plugin::test::OutcomePrePlanning"}});
+  setPlugins("outcome", "planning",
+             {{"outcome_planner", "gpp_plugin::test::OutcomePlanning"}});
+  ros::NodeHandle nh("~");
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("outcome", map.costmap.get());
+
+  Path plan;
+  double cost;
+  std::string message;
+  const auto start = makePose(1, 1);
+  const auto goal = makePose(2, 1);
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0.3, plan, cost, message), 0);
+  EXPECT_EQ(nh.param("outcome_planner/tolerance", 0.), 0.3);
+
+  nh.setParam("outcome_planner/outcome", 53);
+  EXPECT_EQ(pipeline.makePlan(start, goal, 0.4, plan, cost, message), 53);
+  EXPECT_EQ(message, "planned");
+  EXPECT_EQ(nh.param("outcome_planner/tolerance", 0.), 0.4);
+
+  // the batch reports them per query
+  const auto results = pipeline.makePlans({{start, goal}}, 0.5);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0].outcome, 53u);
+  EXPECT_EQ(results[0].message, "planned");
+  EXPECT_EQ(nh.param("outcome_planner/tolerance", 0.), 0.5);
+
+  // the pre-planning rejects the request before the planner runs
+  nh.setParam("outcome_pre/outcome", 55);
+  EXPECT_EQ(pipeline.makePlan(start, goal, 0.3, plan, cost, message), 55);
+  EXPECT_EQ(message, "rejected");
+  EXPECT_EQ(pipeline.getStats()["planning/outcome_planner"].calls, 3u);
+}
+
+/// @brief defines a pipelined pipeline _name with a FieldPlanning of _delay
+inline void
+setPipelined(const std::string& _name, double _delay) {
+  setPlugins(_name, "planning",
+             {{_name + "_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle nh("~" + _name);
+  nh.setParam("pipelined", true);
+  ros::NodeHandle("~" + _name + "_field").setParam("delay", _delay);
+}
+
+/// @brief returns true, if the _future is ready
+template <typename _T>
+bool
+isReady(std::future<_T>& _future) {
+  return _future.wait_for(std::chrono::seconds(0)) ==
+         std::future_status::ready;
+}
+
+TEST(PipelineTest, AsyncPreemption) {
+  // a new async request cancels the running async request - but no blocking
+  // makePlan
+  setPlugins("async", "planning",
+             {{"async_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle("~async_field").setParam("delay", 0.2);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("async", map.costmap.get());
+
+  const auto start = makePose(1, 1.05);
+  const auto goal = makePose(8, 1.05);
+  auto blocking = std::async(std::launch::async, [&]() {
+    Path plan;
+    double cost;
+    std::string message;
+    return pipeline.makePlan(start, goal, 0, plan, cost, message);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto first = pipeline.makePlanAsync(start, goal);
+  EXPECT_EQ(blocking.get(), 0u);
+
+  // the first async request is running now
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto second = pipeline.makePlanAsync(start, goal);
+  EXPECT_EQ(first.get().outcome, 51u);
+  EXPECT_EQ(second.get().outcome, 0u);
+}
+
+TEST(PipelineTest, PipelinedOrder) {
+  // every request receives its own result, the older ones first
+  setPipelined("ordered", 0.05);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("ordered", map.costmap.get());
+
+  const auto start = makePose(1, 1.05);
+  std::vector<std::future<GlobalPlannerPipeline::PlanResult>> futures;
+  for (size_t ii = 0; ii != 4; ++ii)
+    futures.emplace_back(pipeline.makePlanAsync(start, makePose(2 + ii, 1.05)));
+
+  // the last request is never dropped
+  auto last = futures.back().get();
+  ASSERT_EQ(last.outcome, 0u);
+  EXPECT_EQ(last.plan.back().pose.position.x, 5);
+  EXPECT_TRUE(isReady(futures.front()));
+  for (size_t ii = 0; ii + 1 != futures.size(); ++ii) {
+    auto result = futures[ii].get();
+    // the queued requests may be preempted by the newer ones
+    if (result.outcome == 0)
+      EXPECT_EQ(result.plan.back().pose.position.x, 2 + ii);
+    else
+      EXPECT_EQ(result.outcome, 51u) << ii;
+  }
+}
+
+TEST(PipelineTest, PipelinedCancel) {
+  // a cancel drops the running and the queued requests
+  setPipelined("cancelled", 1);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("cancelled", map.costmap.get());
+
+  const auto start = makePose(1, 1.05);
+  const auto goal = makePose(8, 1.05);
+  const auto begin = std::chrono::steady_clock::now();
+  auto running = pipeline.makePlanAsync(start, goal);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto queued = pipeline.makePlanAsync(start, goal);
+  pipeline.cancel();
+  EXPECT_EQ(running.get().outcome, 51u);
+  EXPECT_EQ(queued.get().outcome, 51u);
+  // the planner was cancelled as well
+  EXPECT_LT(std::chrono::steady_clock::now() - begin,
+            std::chrono::milliseconds(500));
+
+  // the next generation runs again
+  auto next = pipeline.makePlanAsync(start, goal);
+  EXPECT_EQ(next.get().outcome, 0u);
+}
+
+TEST(PipelineTest, PipelinedSnapshot) {
+  // the planner of the first request reads the distance field of its own
+  // snapshot - while the second request already runs on the changed map
+  setPipelined("isolated", 0.2);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("isolated", map.costmap.get());
+
+  const auto start = makePose(1, 1.05);
+  const auto goal = makePose(8, 1.05);
+  auto first = pipeline.makePlanAsync(start, goal);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // a wall at x = 5 with a gap at the top
+  {
+    auto costmap = map.costmap->getCostmap();
+    std::lock_guard<costmap_2d::Costmap2D::mutex_t> lock(
+        *costmap->getMutex());
+    for (unsigned int yy = 0; yy != 90; ++yy)
+      costmap->setCost(50, yy, costmap_2d::LETHAL_OBSTACLE);
+  }
+  auto second = pipeline.makePlanAsync(start, goal);
+
+  const auto before = first.get();
+  const auto after = second.get();
+  ASSERT_EQ(before.outcome, 0u);
+  ASSERT_EQ(after.outcome, 0u);
+  EXPECT_NEAR(before.cost, 7, 0.1);
+  EXPECT_GT(after.cost, 10);
+}
+
+TEST(PipelineTest, CropRetry) {
+  // the retries on a larger region run only the planners reading the
+  // snapshot. the post-planning sees the full map
+  ros::NodeHandle nh("~");
+  setPlugins("retry", "pre_planning",
+             {{"retry_crop", "gpp_plugin::CropCostmap"}});
+  setPlugins("retry", "planning",
+             {{"retry_noop", "gpp_plugin::test::NoOpPlanning"},
+              {"retry_sized", "gpp_plugin::test::SizedPlanning"}});
+  setPlugins("retry", "post_planning",
+             {{"retry_post", "gpp_plugin::test::SizedPostPlanning"}});
+  nh.setParam("retry/planning/0/on_failure_break", false);
+  nh.setParam("retry_crop/margin", 1.);
+  nh.setParam("retry_sized/size", 55);
+
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("retry", map.costmap.get());
+
+  Path plan;
+  double cost;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(makePose(4, 5), makePose(6, 5), 0, plan, cost,
+                              message),
+            0);
+  auto stats = pipeline.getStats();
+  EXPECT_EQ(stats["planning/retry_noop"].calls, 1u);
+  EXPECT_EQ(stats["planning/retry_sized"].calls, 2u);
+  EXPECT_LT(nh.param("retry_sized/seen", 0), 100);
+  EXPECT_EQ(nh.param("retry_post/seen", 0), 100);
+}
+
+TEST(PipelineTest, CoarseToFine) {
+  // the first planner searches the coarse map, the second one refines its
+  // path on the full snapshot
+  ros::NodeHandle nh("~");
+  setPlugins("coarse", "planning",
+             {{"coarse_sized", "gpp_plugin::test::SizedPlanning"},
+              {"coarse_seed", "gpp_plugin::test::SeedPlanning"}});
+  nh.setParam("coarse/planning_mode", "coarse_to_fine");
+  nh.setParam("coarse/coarse_factor", 4);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("coarse", map.costmap.get());
+
+  Path plan;
+  double cost;
+  std::string message;
+  const auto start = makePose(1, 1);
+  const auto goal = makePose(6, 6);
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0, plan, cost, message), 0);
+  EXPECT_EQ(nh.param("coarse_sized/seen", 0), 25);
+  EXPECT_EQ(nh.param("coarse_sized/goal", -1), 0);
+  EXPECT_EQ(nh.param("coarse_seed/seed", 0), 2);
+  EXPECT_EQ(nh.param("coarse_seed/seen", 0), 100);
+  ASSERT_EQ(plan.size(), 2u);
+
+  // the coarse map follows the changes of the costmap
+  auto costmap = map.costmap->getCostmap();
+  unsigned int mx, my;
+  ASSERT_TRUE(costmap->worldToMap(6, 6, mx, my));
+  costmap->setCost(mx, my, 254);
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0, plan, cost, message), 0);
+  EXPECT_EQ(nh.param("coarse_sized/goal", -1), 254);
+}
+
+TEST(PipelineTest, SlowTrace) {
+  // the slow requests are dumped in the background into rotated files
+  setPlugins("slow", "planning",
+             {{"slow_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("slow/trace/capacity", 64);
+  nh.setParam("slow/trace/slow_request", 0.01);
+  nh.setParam("slow/trace/file", "/tmp/gpp_slow_trace.json");
+  nh.setParam("slow/trace/files", 2);
+  nh.setParam("slow_field/delay", 0.02);
+  const std::vector<std::string> files = {"/tmp/gpp_slow_trace_0.json",
+                                          "/tmp/gpp_slow_trace_1.json"};
+  for (const auto& file : files)
+    std::remove(file.c_str());
+
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("slow", map.costmap.get());
+
+  Path plan;
+  double cost;
+  std::string message;
+  // a request during a running dump doesn't trigger another one
+  for (const auto& file : files) {
+    bool found = false;
+    for (size_t ii = 0; ii != 100 && !found; ++ii) {
+      ASSERT_EQ(pipeline.makePlan(makePose(1, 1), makePose(2, 1), 0, plan,
+                                  cost, message),
+                0);
+      found = std::ifstream(file).peek() != std::ifstream::traits_type::eof();
+    }
+    EXPECT_TRUE(found) << file;
+  }
+}
+
+TEST(PipelineTest, LazySnapshot) {
+  // the snapshot is taken for the lazy planner before it is loaded
+  setPlugins("lazy", "planning",
+             {{"lazy_sized", "gpp_plugin::test::SizedPlanning"}},
+             {{"lazy", true}});
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("lazy", map.costmap.get());
+
+  Path plan;
+  double cost;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(makePose(1, 1), makePose(2, 1), 0, plan, cost,
+                              message),
+            0);
+  ros::NodeHandle nh("~");
+  EXPECT_EQ(nh.param("lazy_sized/seen", 0), 100);
+  const auto stats = pipeline.getStats()["planning/lazy_sized"];
+  EXPECT_EQ(stats.calls, 1u);
+  EXPECT_GT(stats.load_time, 0.);
+}
+
+TEST(PipelineTest, ReloadUnknownType) {
+  // a plugin, which cannot be created, aborts the reload
+  setPlugins("unknown", "planning",
+             {{"unknown_straight", "gpp_plugin::test::StraightPlanning"}});
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("unknown", map.costmap.get());
+
+  setPlugins("unknown", "planning",
+             {{"unknown_noop", "gpp_plugin::test::NoOpPlanning"},
+              {"unknown_bogus", "gpp_plugin::test::NoSuchPlanning"}});
+  EXPECT_FALSE(pipeline.reload());
+
+  // the old group still plans
+  Path plan;
+  double cost;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(makePose(1, 1.05), makePose(8, 1.05), 0.1, plan,
+                              cost, message),
+            0);
+  EXPECT_FALSE(plan.empty());
+  const auto stats = pipeline.getStats();
+  EXPECT_EQ(stats.count("planning/unknown_straight"), 1u);
+  EXPECT_EQ(stats.count("planning/unknown_noop"), 0u);
+}
+
+TEST(PipelineTest, Concurrent) {
+  // the workers serve the concurrent requests - and stream their prefixes
+  setPlugins("concurrent", "planning",
+             {{"concurrent_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("concurrent/batch_workers", 2);
+  nh.setParam("concurrent/concurrent", true);
+  nh.setParam("concurrent_field/delay", 0.2);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("concurrent", map.costmap.get());
+
+  std::mutex mutex;
+  std::vector<double> prefixes;
+  pipeline.setPrefixCallback([&](const Path& _prefix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    prefixes.emplace_back(_prefix.front().pose.position.x);
+  });
+
+  const auto begin = std::chrono::steady_clock::now();
+  std::vector<std::future<double>> futures;
+  for (size_t ii = 0; ii != 3; ++ii) {
+    futures.emplace_back(std::async(std::launch::async, [&pipeline, ii]() {
+      Path plan;
+      double cost;
+      std::string message;
+      const auto goal = makePose(8, 1.05);
+      if (pipeline.makePlan(makePose(1 + ii, 1.05), goal, 0.1, plan, cost,
+                            message) != 0 ||
+          plan.back().pose.position.x != goal.pose.position.x)
+        return -1.;
+      return cost;
+    }));
+  }
+  for (size_t ii = 0; ii != futures.size(); ++ii)
+    EXPECT_NEAR(futures[ii].get(), 7. - ii, 0.1) << ii;
+
+  // the requests overlap
+  EXPECT_LT(std::chrono::steady_clock::now() - begin,
+            std::chrono::milliseconds(500));
+  std::sort(prefixes.begin(), prefixes.end());
+  EXPECT_EQ(prefixes, std::vector<double>({1, 2, 3}));
+}
+
+/// @brief records the start of the streamed prefixes and the calls of the
+/// validator _name at the time of the prefix
+struct PrefixRecorder {
+  explicit PrefixRecorder(const std::string& _name) : nh("~" + _name) {}
+
+  void
+  operator()(const Path& _prefix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    starts.emplace_back(_prefix.front().pose.position.x);
+    calls.emplace_back(nh.param("calls", 0));
+  }
+
+  ros::NodeHandle nh;
+  std::mutex mutex;
+  std::vector<double> starts;
+  std::vector<int> calls;
+};
+
+TEST(PipelineTest, Batch) {
+  // the pre-planning alters the live map before the snapshot is taken. the
+  // worker's plugins live in its own namespace
+  setPlugins("batch", "pre_planning",
+             {{"batch_mark", "gpp_plugin::test::MarkPrePlanning"}});
+  setPlugins("batch", "planning",
+             {{"batch_sized", "gpp_plugin::test::SizedPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("batch/batch_workers", 1);
+  nh.setParam("batch_mark/cost", 100);
+  nh.setParam("batch_sized/size", 0);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("batch", map.costmap.get());
+  EXPECT_TRUE(nh.hasParam("batch/batch_worker_0/batch_sized/size"));
+
+  const auto results =
+      pipeline.makePlans({{makePose(1, 1.05), makePose(4, 1.05)},
+                          {makePose(1, 1.05), makePose(6, 1.05)}},
+                         0.1);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[0].outcome, 0u);
+  EXPECT_EQ(results[1].outcome, 0u);
+  EXPECT_EQ(pipeline.getStats()["planning/batch_sized"].calls, 2u);
+
+  // both goals were marked in the snapshot of every planner
+  size_t planners = 0;
+  for (const auto ns : {"batch_sized", "batch/batch_worker_0/batch_sized"}) {
+    const auto goal = nh.param(std::string(ns) + "/goal", -1);
+    if (goal == -1)
+      continue;
+    EXPECT_EQ(goal, 100) << ns;
+    ++planners;
+  }
+  EXPECT_NE(planners, 0u);
+}
+
+TEST(PipelineTest, PrefixValidation) {
+  // the prefix is forwarded after the read-only validation accepted the path
+  setPlugins("validated", "planning",
+             {{"validated_field", "gpp_plugin::test::FieldPlanning"}});
+  setPlugins("validated", "post_planning",
+             {{"validated_limit", "gpp_plugin::test::LimitPostPlanning"}},
+             {{"read_only", true}, {"affects_cost", false}});
+  ros::NodeHandle nh("~");
+  nh.setParam("validated/batch_workers", 1);
+  nh.setParam("validated_limit/max_cost", 5.);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("validated", map.costmap.get());
+  PrefixRecorder recorder("validated_limit");
+  pipeline.setPrefixCallback(std::ref(recorder));
+
+  Path plan;
+  double cost;
+  std::string message;
+  const auto start = makePose(1, 1.05);
+  ASSERT_EQ(pipeline.makePlan(start, makePose(4, 1.05), 0.1, plan, cost,
+                              message),
+            0);
+  EXPECT_EQ(recorder.starts, std::vector<double>({1}));
+  EXPECT_EQ(recorder.calls, std::vector<int>({1}));
+
+  // a rejected path forwards nothing
+  EXPECT_NE(pipeline.makePlan(start, makePose(8, 1.05), 0.1, plan, cost,
+                              message),
+            0);
+  EXPECT_EQ(recorder.starts.size(), 1u);
+
+  // the batch worker streams as well
+  const auto results =
+      pipeline.makePlans({{makePose(2, 1.05), makePose(4, 1.05)},
+                          {makePose(3, 1.05), makePose(4, 1.05)}},
+                         0.1);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[0].outcome, 0u);
+  EXPECT_EQ(results[1].outcome, 0u);
+  std::sort(recorder.starts.begin(), recorder.starts.end());
+  EXPECT_EQ(recorder.starts, std::vector<double>({1, 2, 3}));
+}
+
+TEST(PipelineTest, PrefixSpeculation) {
+  // a leg planned ahead is streamed once it serves a request - not before
+  setPlugins("ahead", "planning",
+             {{"ahead_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("ahead/batch_workers", 1);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("ahead", map.costmap.get());
+  PrefixRecorder recorder("ahead");
+  pipeline.setPrefixCallback(std::ref(recorder));
+
+  const auto start = makePose(1, 1.05);
+  const auto goal = makePose(4, 1.05);
+  pipeline.speculate({start, goal});
+  for (size_t ii = 0; ii != 100; ++ii) {
+    if (pipeline.getStats()["planning/ahead_field"].calls)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // the worker may still store the leg
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(recorder.starts.empty());
+
+  Path plan;
+  double cost;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+  EXPECT_EQ(pipeline.getStats()["planning/ahead_field"].calls, 1u);
+  EXPECT_EQ(recorder.starts, std::vector<double>({1}));
+}
+
+/// @brief waits until the planner _name of the _pipeline ran _calls times
+inline void
+waitForCalls(GlobalPlannerPipeline& _pipeline, const std::string& _name,
+             size_t _calls) {
+  for (size_t ii = 0; ii != 200; ++ii) {
+    if (_pipeline.getStats()["planning/" + _name].calls >= _calls)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // the worker may still store the leg
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+TEST(PipelineTest, Speculation) {
+  // a leg planned ahead serves a request close to it on a free map
+  setPlugins("legs", "planning",
+             {{"legs_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("legs/batch_workers", 1);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("legs", map.costmap.get());
+
+  Path plan;
+  double cost;
+  std::string message;
+  const auto start = makePose(1, 1.05);
+  const auto goal = makePose(8, 1.05);
+
+  // hit: the planner doesn't run again
+  pipeline.speculate({start, goal});
+  waitForCalls(pipeline, "legs_field", 1);
+  ASSERT_EQ(pipeline.makePlan(makePose(1.2, 1.05), goal, 0.1, plan, cost,
+                              message),
+            0);
+  EXPECT_EQ(pipeline.getStats()["planning/legs_field"].calls, 1u);
+  EXPECT_NEAR(plan.front().pose.position.x, 1, 1e-3);
+
+  // miss: the leg serves only one request
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+  EXPECT_EQ(pipeline.getStats()["planning/legs_field"].calls, 2u);
+
+  // miss: the start is too far from the leg
+  pipeline.speculate({start, goal});
+  waitForCalls(pipeline, "legs_field", 3);
+  ASSERT_EQ(pipeline.makePlan(makePose(3, 3), goal, 0.1, plan, cost, message),
+            0);
+  EXPECT_EQ(pipeline.getStats()["planning/legs_field"].calls, 4u);
+  EXPECT_NEAR(plan.front().pose.position.x, 3, 1e-3);
+
+  // stale: the map has changed since the leg (which is still kept) was
+  // planned
+  {
+    auto costmap = map.costmap->getCostmap();
+    std::lock_guard<costmap_2d::Costmap2D::mutex_t> lock(
+        *costmap->getMutex());
+    costmap->setCost(50, 10, costmap_2d::LETHAL_OBSTACLE);
+  }
+  pipeline.makePlan(start, goal, 0.1, plan, cost, message);
+  EXPECT_EQ(pipeline.getStats()["planning/legs_field"].calls, 5u);
+
+  // hit: the cost of the traveled part is dropped
+  const auto close = makePose(1.4, 1.05);
+  pipeline.speculate({start, close});
+  waitForCalls(pipeline, "legs_field", 6);
+  ASSERT_EQ(pipeline.makePlan(makePose(1.35, 1.05), close, 0.1, plan, cost,
+                              message),
+            0);
+  EXPECT_EQ(pipeline.getStats()["planning/legs_field"].calls, 6u);
+  ASSERT_EQ(plan.size(), 1u);
+  EXPECT_NEAR(cost, 0, 1e-9);
+}
+
+TEST(PipelineTest, SpeculationPrePlanning) {
+  // the legs planned ahead don't run the pre-planning on the live map
+  setPlugins("legs_pre", "pre_planning",
+             {{"legs_pre_mark", "gpp_plugin::test::MarkPrePlanning"}});
+  setPlugins("legs_pre", "planning",
+             {{"legs_pre_sized", "gpp_plugin::test::SizedPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("legs_pre/batch_workers", 1);
+  nh.setParam("legs_pre_mark/cost", 100);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("legs_pre", map.costmap.get());
+
+  const auto goal = makePose(4, 1.05);
+  pipeline.speculate({makePose(1, 1.05), goal});
+  waitForCalls(pipeline, "legs_pre_sized", 1);
+  EXPECT_EQ(pipeline.getStats()["pre_planning/legs_pre_mark"].calls, 0u);
+  EXPECT_EQ(nh.param("legs_pre/batch_worker_0/legs_pre_sized/goal", -1), 0);
+
+  unsigned int mx, my;
+  const auto costmap = map.costmap->getCostmap();
+  ASSERT_TRUE(costmap->worldToMap(4, 1.05, mx, my));
+  EXPECT_EQ(costmap->getCost(mx, my), 0);
+}
+
+TEST(PipelineTest, SpeculationCancel) {
+  // the cancel of a request doesn't abort the leg planned ahead
+  setPlugins("ahead_cancel", "planning",
+             {{"ahead_cancel_field", "gpp_plugin::test::FieldPlanning"}});
+  ros::NodeHandle nh("~");
+  nh.setParam("ahead_cancel/batch_workers", 1);
+  nh.setParam("ahead_cancel_field/delay", 0.2);
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("ahead_cancel", map.costmap.get());
+
+  const auto start = makePose(1, 1.05);
+  const auto goal = makePose(8, 1.05);
+  pipeline.speculate({start, goal});
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pipeline.cancel();
+  waitForCalls(pipeline, "ahead_cancel_field", 1);
+
+  Path plan;
+  double cost;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+  EXPECT_EQ(pipeline.getStats()["planning/ahead_cancel_field"].calls, 1u);
+}
+
+int
+main(int argc, char** argv) {
+  ros::init(argc, argv, "pipeline");
+  ros::NodeHandle nh;
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
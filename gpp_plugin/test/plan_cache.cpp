@@ -0,0 +1,126 @@
+#include "test_pipeline.hpp"
+
+#include <gpp_plugin/plan_cache.hpp>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+namespace {
+
+using Pose = PlanCache::Pose;
+using Path = PlanCache::Path;
+
+PlanCache::Parameter
+makeParameter(size_t _capacity) {
+  PlanCache::Parameter param;
+  param.capacity = _capacity;
+  param.memory = 1000000;
+  param.position_resolution = 0.1;
+  param.angle_resolution = 0.1;
+  return param;
+}
+
+}  // namespace
+
+TEST(PlanCacheTest, InvalidParameter) {
+  EXPECT_THROW(PlanCache{PlanCache::Parameter{}}, std::invalid_argument);
+}
+
+TEST(PlanCacheTest, Quantization) {
+  // small deviations map to the same key
+  PlanCache cache(makeParameter(1));
+  PlanCacheKeyHash hash;
+  const auto key = cache.makeKey(makePose(0, 0), makePose(1, 1), 0.1, 0);
+  const auto close = cache.makeKey(makePose(0.01, 0), makePose(1, 1), 0.1, 0);
+  EXPECT_EQ(key, close);
+  EXPECT_EQ(hash(key), hash(close));
+
+  // but large deviations or other revisions don't
+  EXPECT_FALSE(key == cache.makeKey(makePose(1, 0), makePose(1, 1), 0.1, 0));
+  EXPECT_FALSE(key == cache.makeKey(makePose(0, 0), makePose(1, 1), 0.1, 1));
+  EXPECT_FALSE(key == cache.makeKey(makePose(0, 0), makePose(1, 1), 1, 0));
+}
+
+TEST(PlanCacheTest, HitAndMiss) {
+  PlanCache cache(makeParameter(1));
+  const auto key = cache.makeKey(makePose(0, 0), makePose(1, 1), 0.1, 0);
+
+  Path plan;
+  double cost;
+  EXPECT_FALSE(cache.find(key, plan, cost));
+
+  cache.insert(key, Path(3, makePose(0, 0)), 42);
+  ASSERT_TRUE(cache.find(key, plan, cost));
+  EXPECT_EQ(plan.size(), 3);
+  EXPECT_EQ(cost, 42);
+
+  // the cost alone
+  cost = 0;
+  ASSERT_TRUE(cache.findCost(key, cost));
+  EXPECT_EQ(cost, 42);
+
+  const auto stats = cache.getStats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.size, 1);
+}
+
+TEST(PlanCacheTest, Lru) {
+  // the least recently used entry is dropped
+  PlanCache cache(makeParameter(2));
+  const auto a = cache.makeKey(makePose(0, 0), makePose(1, 1), 0.1, 0);
+  const auto b = cache.makeKey(makePose(0, 0), makePose(2, 2), 0.1, 0);
+  const auto c = cache.makeKey(makePose(0, 0), makePose(3, 3), 0.1, 0);
+
+  Path plan;
+  double cost;
+  cache.insert(a, plan, 1);
+  cache.insert(b, plan, 2);
+  ASSERT_TRUE(cache.find(a, plan, cost));
+  cache.insert(c, plan, 3);
+
+  EXPECT_TRUE(cache.find(a, plan, cost));
+  EXPECT_FALSE(cache.find(b, plan, cost));
+  EXPECT_TRUE(cache.find(c, plan, cost));
+  EXPECT_EQ(cache.getStats().size, 2);
+}
+
+TEST(PlanCacheTest, Memory) {
+  // the memory limit bounds the cache
+  auto param = makeParameter(10);
+  const Path path(100, makePose(0, 0));
+  param.memory = PlanCache::memory(path) * 2;
+  PlanCache cache(param);
+
+  for (size_t ii = 0; ii != 5; ++ii)
+    cache.insert(cache.makeKey(makePose(ii, 0), makePose(1, 1), 0.1, 0), path,
+                 ii);
+
+  const auto stats = cache.getStats();
+  EXPECT_EQ(stats.size, 2);
+  EXPECT_LE(stats.memory, param.memory);
+
+  // a path which is too large is never stored
+  cache.clear();
+  cache.insert(cache.makeKey(makePose(0, 0), makePose(1, 1), 0.1, 0),
+               Path(1000, makePose(0, 0)), 0);
+  EXPECT_EQ(cache.getStats().size, 0);
+}
+
+TEST(CostmapRevisionTest, Change) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  const auto revision = costmapRevision(map);
+  EXPECT_EQ(revision, costmapRevision(map));
+
+  map.setCost(3, 3, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_NE(revision, costmapRevision(map));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,73 @@
+#include <gpp_plugin/plugin_stats.hpp>
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST(LatencyHistogramTest, Index) {
+  // the index must be monotonic and the bounds must contain the value
+  size_t last = 0;
+  for (uint64_t us = 0; us != 100000; ++us) {
+    const auto index = LatencyHistogram::index(us);
+    ASSERT_GE(index, last);
+    ASSERT_LT(us, LatencyHistogram::upperBound(index));
+    if (index)
+      ASSERT_GE(us, LatencyHistogram::upperBound(index - 1));
+    last = index;
+  }
+}
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.percentile(0.5), 0);
+}
+
+TEST(LatencyHistogramTest, Percentile) {
+  // 99 fast samples and a slow one
+  LatencyHistogram histogram;
+  for (size_t ii = 0; ii != 99; ++ii)
+    histogram.record(milliseconds(1));
+  histogram.record(milliseconds(100));
+
+  ASSERT_EQ(histogram.count(), 100);
+  EXPECT_NEAR(histogram.percentile(0.5), 1e-3, 0.25e-3);
+  EXPECT_NEAR(histogram.percentile(0.99), 1e-3, 0.25e-3);
+  EXPECT_NEAR(histogram.percentile(1), 100e-3, 25e-3);
+}
+
+TEST(PluginStatsTest, Record) {
+  PluginStats stats;
+  stats.record(true, milliseconds(2));
+  stats.record(false, milliseconds(4));
+
+  EXPECT_EQ(stats.calls, 2);
+  EXPECT_EQ(stats.successes, 1);
+  EXPECT_EQ(stats.failures, 1);
+  EXPECT_NEAR(stats.mean(), 3e-3, 1e-9);
+  EXPECT_EQ(stats.latency.count(), 2);
+}
+
+TEST(PluginStatsTest, Merge) {
+  // merging equals recording everything into one instance
+  PluginStats a, b;
+  a.record(true, milliseconds(2), 3);
+  b.record(false, milliseconds(4), 1);
+  b.record(true, milliseconds(100));
+  a.merge(b);
+
+  EXPECT_EQ(a.calls, 3);
+  EXPECT_EQ(a.successes, 2);
+  EXPECT_EQ(a.failures, 1);
+  EXPECT_EQ(a.allocations, 4);
+  EXPECT_NEAR(a.total, 106e-3, 1e-9);
+  EXPECT_EQ(a.latency.count(), 3);
+  EXPECT_NEAR(a.latency.percentile(1), 100e-3, 25e-3);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+#include "test_pipeline.hpp"
+
+#include <gpp_plugin/reachability.hpp>
+#include <gtest/gtest.h>
+
+#include <costmap_2d/cost_values.h>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+namespace {
+
+using Pose = ReachabilityMap::Pose;
+using Update = ReachabilityMap::Update;
+using Verdict = ReachabilityMap::Verdict;
+
+// vertical wall at the cell column _x
+void
+setWall(costmap_2d::Costmap2D& _map, unsigned int _x, unsigned char _cost) {
+  for (unsigned int yy = 0; yy != _map.getSizeInCellsY(); ++yy)
+    _map.setCost(_x, yy, _cost);
+}
+
+constexpr unsigned char lethal = costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+
+}  // namespace
+
+TEST(ReachabilityTest, Empty) {
+  ReachabilityMap labels;
+  EXPECT_TRUE(labels.empty());
+
+  // without labels there is no free cell around the goal
+  EXPECT_EQ(labels.check(makePose(0, 0), makePose(1, 0), 0, 0),
+            Verdict::BLOCKED_GOAL);
+}
+
+TEST(ReachabilityTest, Wall) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  setWall(map, 5, costmap_2d::LETHAL_OBSTACLE);
+
+  ReachabilityMap labels;
+  ASSERT_EQ(labels.update(map, lethal, true), Update::FULL);
+  EXPECT_FALSE(labels.empty());
+
+  const auto start = makePose(0.15, 0.15);
+  EXPECT_EQ(labels.check(start, makePose(0.45, 0.85), 0, 0),
+            Verdict::REACHABLE);
+  EXPECT_EQ(labels.check(start, makePose(0.85, 0.15), 0, 0),
+            Verdict::DISCONNECTED);
+
+  // a goal within the wall is reachable only with a tolerance
+  EXPECT_EQ(labels.check(start, makePose(0.55, 0.15), 0, 0),
+            Verdict::BLOCKED_GOAL);
+  EXPECT_EQ(labels.check(start, makePose(0.55, 0.15), 0, 0.15),
+            Verdict::REACHABLE);
+
+  // a goal outside of the map is never reachable
+  EXPECT_EQ(labels.check(start, makePose(2, 2), 0, 0), Verdict::BLOCKED_GOAL);
+}
+
+TEST(ReachabilityTest, Start) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  setWall(map, 5, costmap_2d::LETHAL_OBSTACLE);
+
+  ReachabilityMap labels;
+  labels.update(map, lethal, true);
+
+  // a start within the wall is not rejected
+  const auto goal = makePose(0.85, 0.15);
+  EXPECT_EQ(labels.check(makePose(0.55, 0.15), goal, 0, 0),
+            Verdict::REACHABLE);
+
+  // the start tolerance may connect the start to both sides
+  EXPECT_EQ(labels.check(makePose(0.45, 0.15), goal, 0, 0),
+            Verdict::DISCONNECTED);
+  EXPECT_EQ(labels.check(makePose(0.45, 0.15), goal, 0.2, 0),
+            Verdict::REACHABLE);
+}
+
+TEST(ReachabilityTest, Incremental) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  setWall(map, 5, costmap_2d::LETHAL_OBSTACLE);
+
+  ReachabilityMap labels;
+  labels.update(map, lethal, true);
+  EXPECT_EQ(labels.update(map, lethal, true), Update::NONE);
+
+  // open a diagonal gap: the grid is 8-connected
+  const auto start = makePose(0.15, 0.15);
+  const auto goal = makePose(0.85, 0.15);
+  map.setCost(5, 5, costmap_2d::FREE_SPACE);
+  setWall(map, 4, costmap_2d::FREE_SPACE);
+  setWall(map, 6, costmap_2d::FREE_SPACE);
+  ASSERT_EQ(labels.update(map, lethal, true), Update::INCREMENTAL);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::REACHABLE);
+
+  // closing it floods the split component
+  map.setCost(5, 5, costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(labels.update(map, lethal, true), Update::INCREMENTAL);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::DISCONNECTED);
+
+  for (unsigned int yy = 0; yy != 10; yy += 2)
+    map.setCost(4, yy, costmap_2d::LETHAL_OBSTACLE);
+  map.setCost(5, 2, costmap_2d::FREE_SPACE);
+  map.setCost(5, 3, costmap_2d::FREE_SPACE);
+  ASSERT_EQ(labels.update(map, lethal, true), Update::INCREMENTAL);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::REACHABLE);
+}
+
+TEST(ReachabilityTest, Rows) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  ReachabilityMap labels;
+  labels.update(map, lethal, true);
+
+  // only the given rows are compared
+  setWall(map, 5, costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(labels.update(map, lethal, true, 0, 9), Update::INCREMENTAL);
+  const auto start = makePose(0.15, 0.15);
+  const auto goal = makePose(0.85, 0.15);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::REACHABLE);
+
+  ASSERT_EQ(labels.update(map, lethal, true, 9, 10), Update::INCREMENTAL);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::DISCONNECTED);
+  EXPECT_EQ(labels.update(map, lethal, true), Update::NONE);
+}
+
+TEST(ReachabilityTest, Random) {
+  // the incremental labels match a fresh labelling
+  costmap_2d::Costmap2D map(20, 20, 0.1, 0, 0);
+  ReachabilityMap labels;
+  labels.update(map, lethal, true);
+
+  unsigned int seed = 42;
+  const auto next = [&seed]() {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % 400;
+  };
+  for (size_t ii = 0; ii != 50; ++ii) {
+    for (size_t jj = 0; jj != 20; ++jj) {
+      const auto cell = next();
+      map.setCost(cell % 20, cell / 20,
+                  next() % 2 ? costmap_2d::LETHAL_OBSTACLE
+                             : costmap_2d::FREE_SPACE);
+    }
+    labels.update(map, lethal, true);
+
+    ReachabilityMap fresh;
+    fresh.update(map, lethal, true);
+    for (size_t jj = 0; jj != 20; ++jj) {
+      const auto s = next();
+      const auto g = next();
+      const auto start = makePose(s % 20 * 0.1 + 0.05, s / 20 * 0.1 + 0.05);
+      const auto goal = makePose(g % 20 * 0.1 + 0.05, g / 20 * 0.1 + 0.05);
+      ASSERT_EQ(labels.check(start, goal, 0, 0),
+                fresh.check(start, goal, 0, 0))
+          << ii;
+    }
+  }
+}
+
+TEST(ReachabilityTest, Unknown) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  setWall(map, 5, costmap_2d::NO_INFORMATION);
+
+  const auto start = makePose(0.15, 0.15);
+  const auto goal = makePose(0.85, 0.15);
+  ReachabilityMap labels;
+  labels.update(map, lethal, true);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::REACHABLE);
+
+  labels.update(map, lethal, false);
+  EXPECT_EQ(labels.check(start, goal, 0, 0), Verdict::DISCONNECTED);
+}
+
+TEST(ReachabilityTest, Geometry) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  ReachabilityMap labels;
+  labels.update(map, lethal, true);
+
+  // a moved map is labelled again. a start outside of the map is not
+  // rejected
+  map.resizeMap(10, 10, 0.1, 1, 0);
+  setWall(map, 5, costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(labels.update(map, lethal, true), Update::FULL);
+  EXPECT_EQ(labels.check(makePose(1.15, 0.15), makePose(1.85, 0.15), 0, 0),
+            Verdict::DISCONNECTED);
+  EXPECT_EQ(labels.check(makePose(0.15, 0.15), makePose(1.15, 0.15), 0, 0),
+            Verdict::REACHABLE);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,85 @@
+#include "test_pipeline.hpp"
+
+#include <gpp_plugin/reuse_path.hpp>
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+namespace {
+
+using Pose = ReusePath::Pose;
+using Path = ReusePath::Path;
+
+// straight line along the x-axis
+Path
+makePath(size_t _size, double _step) {
+  Path path;
+  for (size_t ii = 0; ii != _size; ++ii)
+    path.emplace_back(makePose(ii * _step, 0.05));
+  return path;
+}
+
+}  // namespace
+
+TEST(ReusePathTest, FindClosest) {
+  const auto path = makePath(10, 0.1);
+  EXPECT_EQ(ReusePath::findClosest(makePose(0, 0), path), 0);
+  EXPECT_EQ(ReusePath::findClosest(makePose(0.51, 0.2), path), 5);
+  EXPECT_EQ(ReusePath::findClosest(makePose(2, 0), path), 9);
+  EXPECT_EQ(ReusePath::findClosest(makePose(0, 0), Path{}), 0);
+}
+
+TEST(ReusePathTest, RemainingCost) {
+  const auto path = makePath(11, 0.1);
+  EXPECT_NEAR(ReusePath::remainingCost(path, 0, 2), 2, 1e-9);
+  EXPECT_NEAR(ReusePath::remainingCost(path, 5, 2), 1, 1e-9);
+  EXPECT_NEAR(ReusePath::remainingCost(path, 10, 2), 0, 1e-9);
+  // a path without length keeps its cost
+  EXPECT_EQ(ReusePath::remainingCost(Path(3), 1, 2), 2);
+}
+
+TEST(ReusePathTest, IsFree) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  const auto path = makePath(10, 0.1);
+  const auto lethal = costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+  EXPECT_TRUE(ReusePath::isFree(map, path.begin(), path.end(), lethal));
+
+  // block the path: the part before the obstacle is still free
+  map.setCost(5, 0, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(ReusePath::isFree(map, path.begin(), path.end(), lethal));
+  EXPECT_TRUE(ReusePath::isFree(map, path.begin(), path.begin() + 5, lethal));
+
+  // the cells between two poses are checked as well
+  const Path sparse{makePose(0, 0.05), makePose(0.9, 0.05)};
+  EXPECT_FALSE(ReusePath::isFree(map, sparse.begin(), sparse.end(), lethal));
+  map.setCost(5, 0, costmap_2d::FREE_SPACE);
+  EXPECT_TRUE(ReusePath::isFree(map, sparse.begin(), sparse.end(), lethal));
+
+  // poses outside of the map are not free
+  const auto outside = makePath(20, 0.1);
+  EXPECT_FALSE(
+      ReusePath::isFree(map, outside.begin() + 11, outside.end(), lethal));
+}
+
+TEST(ReusePathTest, Snapshot) {
+  // without a live map the plugin works on the snapshot
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  ReusePath reuse;
+  reuse.setSnapshot(map);
+
+  auto path = makePath(10, 0.1);
+  double cost = 0.9;
+  ASSERT_TRUE(reuse.reuse(makePose(0.3, 0.05), path.back(), path, cost));
+  EXPECT_EQ(path.size(), 7);
+  EXPECT_NEAR(cost, 0.6, 1e-9);
+
+  map.setCost(8, 0, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(reuse.reuse(makePose(0.3, 0.05), path.back(), path, cost));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
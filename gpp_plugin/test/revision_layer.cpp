@@ -0,0 +1,85 @@
+#include <gpp_plugin/plan_cache.hpp>
+#include <gpp_plugin/revision_layer.hpp>
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+
+TEST(RevisionLayerTest, CountsChanges) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  RevisionLayer layer;
+
+  // the first update copies the map
+  layer.updateCosts(map, 0, 0, 10, 10);
+  const auto first = layer.getRevision();
+
+  // an update without changes keeps the revision
+  layer.updateCosts(map, 0, 0, 10, 10);
+  EXPECT_EQ(layer.getRevision(), first);
+
+  // a change within the bounds is counted once
+  map.setCost(5, 5, costmap_2d::LETHAL_OBSTACLE);
+  layer.updateCosts(map, 4, 4, 6, 6);
+  EXPECT_EQ(layer.getRevision(), first + 1);
+  layer.updateCosts(map, 4, 4, 6, 6);
+  EXPECT_EQ(layer.getRevision(), first + 1);
+
+  // the bounds may exceed the map
+  map.setCost(0, 9, costmap_2d::LETHAL_OBSTACLE);
+  layer.updateCosts(map, -5, 5, 20, 20);
+  EXPECT_EQ(layer.getRevision(), first + 2);
+}
+
+TEST(RevisionLayerTest, ChangedRows) {
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  RevisionLayer layer;
+  unsigned int begin, end;
+
+  // before the first update everything changed
+  layer.getChangedRows(0, begin, end);
+  EXPECT_EQ(begin, 0u);
+  EXPECT_GE(end, 10u);
+
+  layer.updateCosts(map, 0, 0, 10, 10);
+  const auto first = layer.getRevision();
+  layer.getChangedRows(first, begin, end);
+  EXPECT_EQ(begin, end);
+
+  // the rows of both changes
+  map.setCost(1, 3, costmap_2d::LETHAL_OBSTACLE);
+  layer.updateCosts(map, 0, 0, 10, 10);
+  map.setCost(8, 6, costmap_2d::LETHAL_OBSTACLE);
+  layer.updateCosts(map, 0, 0, 10, 10);
+  layer.getChangedRows(first, begin, end);
+  EXPECT_EQ(begin, 3u);
+  EXPECT_EQ(end, 7u);
+  layer.getChangedRows(first + 1, begin, end);
+  EXPECT_EQ(begin, 6u);
+  EXPECT_EQ(end, 7u);
+}
+
+TEST(RevisionLayerTest, Resize) {
+  // a resize is a change
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  RevisionLayer layer;
+  layer.updateCosts(map, 0, 0, 10, 10);
+  const auto first = layer.getRevision();
+
+  map.resizeMap(20, 20, 0.1, 0, 0);
+  layer.updateCosts(map, 0, 0, 0, 0);
+  EXPECT_NE(layer.getRevision(), first);
+}
+
+TEST(RevisionLayerTest, Geometry) {
+  // the stamp is combined with the geometry of the map
+  costmap_2d::Costmap2D map(10, 10, 0.1, 0, 0);
+  costmap_2d::Costmap2D moved(10, 10, 0.1, 1, 0);
+  EXPECT_EQ(costmapRevision(map, 1), costmapRevision(map, 1));
+  EXPECT_NE(costmapRevision(map, 1), costmapRevision(map, 2));
+  EXPECT_NE(costmapRevision(map, 1), costmapRevision(moved, 1));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
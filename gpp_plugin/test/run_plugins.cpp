@@ -0,0 +1,733 @@
+#include <gpp_plugin/gpp_plugin.hpp>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace gpp_plugin;
+
+namespace {
+
+// dummy plugin with a fixed outcome and runtime
+struct FakePlugin {
+  bool result = true;
+  std::chrono::milliseconds duration{0};
+  std::atomic_bool cancelled{false};
+
+  bool
+  run() {
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (!cancelled && std::chrono::steady_clock::now() < end)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return result && !cancelled;
+  }
+};
+
+// found by adl
+bool
+_cancelPlugin(FakePlugin& _plugin) {
+  _plugin.cancelled = true;
+  return true;
+}
+
+// group which we can populate without the param-server
+struct FakeGroup : public PluginGroup<FakePlugin> {
+  FakeGroup() { default_value_ = true; }
+
+  FakePlugin&
+  add(bool _result, bool _on_success_break = false,
+      bool _on_failure_break = true) {
+    PluginParameter param;
+    param.name = "plugin" + std::to_string(plugins_.size());
+    param.on_success_break = _on_success_break;
+    param.on_failure_break = _on_failure_break;
+    PluginPtr plugin(new FakePlugin, [](FakePlugin* _p) { delete _p; });
+    plugin->result = _result;
+    plugins_.emplace_back(param, std::move(plugin));
+    resetLazy();
+    return *plugins_.back().second;
+  }
+
+  // adds a plugin, which is created by the loader
+  void
+  addLazy(bool _on_success_break = false) {
+    PluginParameter param;
+    param.name = "plugin" + std::to_string(plugins_.size());
+    param.on_success_break = _on_success_break;
+    param.lazy = true;
+    plugins_.emplace_back(param, nullptr);
+    resetLazy();
+  }
+
+  void
+  setDefaultValue(bool _value) {
+    default_value_ = _value;
+  }
+
+  void
+  setMaxDuration(double _value) {
+    max_duration_ = _value;
+  }
+
+  PluginParameter&
+  param(size_t _index) {
+    return plugins_.at(_index).first;
+  }
+};
+
+const auto run = [](FakePlugin& _plugin) { return _plugin.run(); };
+const auto race = [](FakePlugin& _plugin, size_t) { return _plugin.run(); };
+
+}  // namespace
+
+TEST(RunPluginsTest, Sequence) {
+  // all plugins must succeed
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(true);
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+
+  grp.add(false);
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+}
+
+TEST(RunPluginsTest, Selector) {
+  // the first successful plugin decides
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.add(false, true, false);
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+
+  grp.add(true, true, false);
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+}
+
+TEST(RunPluginsTest, Cancel) {
+  FakeGroup grp;
+  std::atomic_bool cancel{true};
+  grp.add(true);
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+}
+
+TEST(RunPluginsTest, Stats) {
+  // every call is counted
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(false).duration = std::chrono::milliseconds(5);
+  grp.add(true);
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+
+  const auto stats = grp.getStats();
+  ASSERT_EQ(stats.size(), 3);
+  EXPECT_EQ(stats[0].successes, 1);
+  EXPECT_EQ(stats[1].failures, 1);
+  EXPECT_GE(stats[1].total, 5e-3);
+  EXPECT_EQ(stats[2].calls, 0);
+}
+
+namespace {
+
+// counter which is driven by the test
+size_t fake_allocations = 0;
+
+size_t
+fakeCounter() {
+  return fake_allocations;
+}
+
+}  // namespace
+
+TEST(RunPluginsTest, Allocations) {
+  // the allocations are counted per call, if a counter is installed
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(true);
+  size_t ii = 0;
+  auto allocate = [&](FakePlugin&) {
+    fake_allocations += ++ii;
+    return true;
+  };
+
+  setAllocationCounter(&fakeCounter);
+  EXPECT_TRUE(_runPlugins(grp, allocate, cancel));
+  setAllocationCounter(nullptr);
+  EXPECT_TRUE(_runPlugins(grp, allocate, cancel));
+
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].allocations, 1);
+  EXPECT_EQ(stats[1].allocations, 2);
+}
+
+TEST(RunPluginsTest, Skip) {
+  // skipped plugins are neither called nor counted
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(false);
+  grp.param(1).affects_cost = false;
+  auto skip = [](const PluginParameter& _param) {
+    return !_param.affects_cost;
+  };
+
+  EXPECT_TRUE(_runPlugins(grp, run, cancel, nullptr, skip));
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 1);
+  EXPECT_EQ(stats[1].calls, 0);
+}
+
+TEST(RunPluginsTest, Lazy) {
+  // the lazy plugin is loaded once it is reached - and only once
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  size_t loaded = 0;
+  grp.setLoader([&](const PluginParameter&) {
+    ++loaded;
+    return FakeGroup::PluginPtr(new FakePlugin,
+                                [](FakePlugin* _p) { delete _p; });
+  });
+  auto& first = grp.add(true, true);
+  grp.addLazy();
+
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(loaded, 0);
+
+  first.result = false;
+  grp.param(0).on_failure_break = false;
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(loaded, 1);
+  EXPECT_EQ(grp.getStats()[1].successes, 2);
+}
+
+TEST(RunPluginsTest, LazyFailure) {
+  // a plugin, which cannot be loaded, fails
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  size_t loaded = 0;
+  grp.setLoader([&](const PluginParameter&) {
+    ++loaded;
+    return FakeGroup::PluginPtr();
+  });
+  grp.addLazy();
+
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(loaded, 1);
+}
+
+TEST(RunPluginsTest, LazyLoadTime) {
+  // the loading counts neither against the group budget nor as a call
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setLoader([&](const PluginParameter&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return FakeGroup::PluginPtr(new FakePlugin,
+                                [](FakePlugin* _p) { delete _p; });
+  });
+  grp.addLazy();
+  grp.add(true);
+  grp.setMaxDuration(0.05);
+
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 1);
+  EXPECT_LT(stats[0].mean(), 0.05);
+  EXPECT_GE(stats[0].load_time, 0.1);
+  EXPECT_EQ(stats[1].calls, 1);
+}
+
+TEST(PluginGroupTest, Replace) {
+  // the plugins with the same name and type are reused
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  auto& first = grp.add(true);
+  grp.add(true);
+  grp.param(1).type = "other";
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+
+  // swap the order, drop the second plugin and add a new one
+  FakeGroup::PluginMap plugins(2);
+  plugins[0].first.name = "plugin2";
+  plugins[0].second = FakeGroup::PluginPtr(new FakePlugin,
+                                          [](FakePlugin* _p) { delete _p; });
+  plugins[1].first.name = "plugin0";
+  const auto dropped = grp.replace(std::move(plugins));
+
+  ASSERT_EQ(dropped.size(), 1);
+  EXPECT_EQ(dropped[0].first.name, "plugin1");
+  ASSERT_EQ(grp.getPlugins().size(), 2);
+  EXPECT_EQ(grp.getPlugin(1), &first);
+
+  // the statistics moved along
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 0);
+  EXPECT_EQ(stats[1].calls, 1);
+}
+
+TEST(PluginGroupTest, ReplaceLazy) {
+  // a loaded lazy plugin is reused
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setLoader([](const PluginParameter&) {
+    return FakeGroup::PluginPtr(new FakePlugin,
+                                [](FakePlugin* _p) { delete _p; });
+  });
+  grp.addLazy();
+  const auto lazy = grp.getPlugin(0);
+  ASSERT_NE(lazy, nullptr);
+
+  FakeGroup::PluginMap plugins(1);
+  plugins[0].first = grp.param(0);
+  EXPECT_TRUE(grp.replace(std::move(plugins)).empty());
+  EXPECT_EQ(grp.getPlugin(0), lazy);
+}
+
+TEST(RunPluginsTest, PluginOverrun) {
+  // the plugin exceeds its budget and gets cancelled
+  FakeGroup grp;
+  Watchdog watchdog;
+  std::atomic_bool cancel{false};
+  auto& slow = grp.add(true);
+  slow.duration = std::chrono::seconds(10);
+  grp.param(0).max_duration = 0.01;
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(_runPlugins(grp, run, cancel, &watchdog));
+  EXPECT_TRUE(slow.cancelled);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  EXPECT_EQ(grp.getStats()[0].failures, 1);
+}
+
+TEST(RunPluginsTest, OverrunWithoutWatchdog) {
+  // without a watchdog the plugin fails after returning
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  auto& slow = grp.add(true);
+  slow.duration = std::chrono::milliseconds(20);
+  grp.param(0).max_duration = 0.005;
+
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+  EXPECT_FALSE(slow.cancelled);
+}
+
+TEST(RunPluginsTest, SkipOptional) {
+  // the optional plugin is known to be too slow for the group budget
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setMaxDuration(0.05);
+  grp.add(true, false, false);
+  grp.add(true);
+  grp.record(0, true, std::chrono::milliseconds(100));
+
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 1);
+  EXPECT_EQ(stats[1].calls, 1);
+}
+
+TEST(RunPluginsTest, SkipOptionalProbe) {
+  // the skipped plugin is probed periodically - and is run again, once its
+  // expectation has decayed
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setMaxDuration(0.05);
+  grp.add(true, false, false);
+  grp.add(true);
+  grp.record(0, true, std::chrono::milliseconds(100));
+
+  const auto interval = FakeGroup::probe_interval;
+  for (size_t ii = 0; ii != interval; ++ii)
+    EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(grp.getStats()[0].calls, 2);
+  EXPECT_LT(grp.getExpectedDuration(0), 0.1);
+
+  // the fast calls let the expectation decay below the budget
+  for (size_t ii = 0; ii != 20; ++ii)
+    grp.record(0, true, std::chrono::milliseconds(1));
+  EXPECT_LT(grp.getExpectedDuration(0), 0.05);
+  EXPECT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(grp.getStats()[0].calls, 23);
+}
+
+TEST(RunPluginsTest, OutOfTime) {
+  // the optional plugin consumes the entire budget of the group
+  FakeGroup grp;
+  Watchdog watchdog;
+  std::atomic_bool cancel{false};
+  grp.setMaxDuration(0.01);
+  auto& slow = grp.add(true, false, false);
+  slow.duration = std::chrono::seconds(10);
+  grp.add(true);
+
+  EXPECT_FALSE(_runPlugins(grp, run, cancel, &watchdog));
+  EXPECT_TRUE(slow.cancelled);
+  EXPECT_EQ(grp.getStats()[1].calls, 0);
+}
+
+TEST(RunPluginsTest, FanOut) {
+  // the read-only plugins meet each other: this works only concurrently
+  FakeGroup grp;
+  ThreadPool pool(1);
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(true);
+  for (size_t ii = 0; ii != 2; ++ii) {
+    grp.param(ii).read_only = true;
+    grp.param(ii).affects_cost = false;
+  }
+
+  std::atomic_int arrived{0};
+  auto meet = [&](FakePlugin&, const PluginParameter& _param) {
+    EXPECT_TRUE(_param.read_only);
+    ++arrived;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (arrived < 2 && std::chrono::steady_clock::now() < end)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return arrived == 2;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(_runPlugins(grp, meet, cancel, nullptr, _NoSkip{}, &pool));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(RunPluginsTest, FanOutOrder) {
+  // the results are evaluated in the order of the group. all plugins run
+  FakeGroup grp;
+  ThreadPool pool(2);
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(false);
+  grp.add(true, true).duration = std::chrono::milliseconds(10);
+  grp.add(true);
+  for (size_t ii = 0; ii != 3; ++ii) {
+    grp.param(ii).read_only = true;
+    grp.param(ii).affects_cost = false;
+  }
+
+  EXPECT_FALSE(_runPlugins(grp, run, cancel, nullptr, _NoSkip{}, &pool));
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].successes, 1);
+  EXPECT_EQ(stats[1].failures, 1);
+  EXPECT_EQ(stats[2].successes, 1);
+  EXPECT_EQ(stats[3].calls, 0);
+
+  // the optional failure is ignored and the success breaks
+  grp.param(1).on_failure_break = false;
+  EXPECT_TRUE(_runPlugins(grp, run, cancel, nullptr, _NoSkip{}, &pool));
+  EXPECT_EQ(grp.getStats()[3].calls, 0);
+}
+
+TEST(RunPluginsTest, FanOutCost) {
+  // read-only plugins writing the cost run sequentially on the calling thread
+  FakeGroup grp;
+  ThreadPool pool(1);
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(true);
+  grp.param(0).read_only = true;
+  grp.param(1).read_only = true;
+
+  const auto caller = std::this_thread::get_id();
+  double cost = 0;
+  auto write = [&](FakePlugin&) {
+    cost += 1;
+    return std::this_thread::get_id() == caller;
+  };
+  EXPECT_TRUE(_runPlugins(grp, write, cancel, nullptr, _NoSkip{}, &pool));
+  EXPECT_EQ(cost, 2);
+}
+
+TEST(RunPluginsTest, FanOutCancel) {
+  // the queued plugins don't start after a cancel
+  FakeGroup grp;
+  ThreadPool pool(1);
+  std::atomic_bool cancel{false};
+  for (size_t ii = 0; ii != 3; ++ii) {
+    grp.add(true);
+    grp.param(ii).read_only = true;
+    grp.param(ii).affects_cost = false;
+  }
+
+  // the calling thread cancels, the pool waits for it
+  const auto caller = std::this_thread::get_id();
+  std::atomic_int calls{0};
+  auto cancelling = [&](FakePlugin&) {
+    ++calls;
+    if (std::this_thread::get_id() == caller)
+      cancel = true;
+    while (!cancel)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return true;
+  };
+  EXPECT_FALSE(
+      _runPlugins(grp, cancelling, cancel, nullptr, _NoSkip{}, &pool));
+  EXPECT_LT(calls, 3);
+}
+
+TEST(RunPluginsTest, AdaptiveOrder) {
+  // the failing alternative is moved behind the successful one
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  auto& failing = grp.add(false, true, false);
+  auto& working = grp.add(true, true, false);
+  failing.duration = working.duration = std::chrono::milliseconds(1);
+  grp.setOrdering({true, {}, 0});
+
+  for (size_t ii = 0; ii != 10; ++ii)
+    ASSERT_TRUE(_runPlugins(grp, run, cancel));
+
+  // the working plugin was tried first after the first run
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 1);
+  EXPECT_EQ(stats[1].calls, 10);
+  EXPECT_EQ(grp.getIndex(0), 1);
+}
+
+TEST(RunPluginsTest, AdaptiveOrderExploration) {
+  // every fifth run tries the trailing plugin first
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  auto& failing = grp.add(false, true, false);
+  auto& working = grp.add(true, true, false);
+  failing.duration = working.duration = std::chrono::milliseconds(1);
+  grp.setOrdering({true, {}, 5});
+
+  for (size_t ii = 0; ii != 10; ++ii)
+    ASSERT_TRUE(_runPlugins(grp, run, cancel));
+
+  // the first run and the runs five and ten
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 3);
+  EXPECT_EQ(stats[1].calls, 10);
+}
+
+TEST(RunPluginsTest, AdaptiveOrderReplace) {
+  // a new instance doesn't inherit the outcomes of its namesake
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.add(false, true, false);
+  grp.add(true, true, false);
+  grp.setOrdering({true, {}, 0});
+  for (size_t ii = 0; ii != 5; ++ii)
+    ASSERT_TRUE(_runPlugins(grp, run, cancel));
+  ASSERT_EQ(grp.getIndex(0), 1);
+
+  FakeGroup::PluginMap plugins(2);
+  plugins[0].first = grp.param(0);
+  plugins[0].second = FakeGroup::PluginPtr(new FakePlugin,
+                                          [](FakePlugin* _p) { delete _p; });
+  plugins[1].first = grp.param(1);
+  EXPECT_EQ(grp.replace(std::move(plugins)).size(), 1);
+
+  // the new instance has no calls and is tried first
+  ASSERT_TRUE(_runPlugins(grp, run, cancel));
+  const auto stats = grp.getStats();
+  EXPECT_EQ(stats[0].calls, 1);
+  EXPECT_EQ(stats[1].calls, 5);
+}
+
+TEST(RunPluginsTest, AdaptiveOrderTryFirst) {
+  // the try_first plugin leads, no matter how bad it is
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.add(false, true, false);
+  grp.add(true, true, false);
+  grp.param(0).try_first = true;
+  grp.setOrdering({true, {}});
+
+  for (size_t ii = 0; ii != 5; ++ii)
+    ASSERT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(grp.getStats()[0].calls, 5);
+}
+
+TEST(RunPluginsTest, AdaptiveOrderContext) {
+  // every context has its own order
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  auto& first = grp.add(true, true, false);
+  auto& second = grp.add(true, true, false);
+  grp.setOrdering({true, {10.}});
+
+  // the first plugin fails in the far context
+  first.result = false;
+  grp.setContext(20);
+  for (size_t ii = 0; ii != 5; ++ii)
+    ASSERT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(grp.getIndex(0), 1);
+
+  // the near context is untouched
+  first.result = true;
+  second.result = false;
+  grp.setContext(5);
+  ASSERT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(grp.getIndex(0), 0);
+}
+
+TEST(RunPluginsTest, AdaptiveOrderFixed) {
+  // plugins, which aren't alternatives, keep their positions
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.add(false, false, false);
+  grp.add(false, true, false);
+  grp.add(true, true, false);
+  grp.setOrdering({true, {}});
+
+  for (size_t ii = 0; ii != 5; ++ii)
+    ASSERT_TRUE(_runPlugins(grp, run, cancel));
+  EXPECT_EQ(grp.getIndex(0), 0);
+  EXPECT_EQ(grp.getStats()[0].calls, 5);
+}
+
+TEST(RunPluginsTest, Trace) {
+  // every call is traced with its outcome
+  FakeGroup grp;
+  std::atomic_bool cancel{false};
+  grp.add(true);
+  grp.add(false);
+  TraceRing ring(8);
+  setTraceRing(&ring);
+  EXPECT_FALSE(_runPlugins(grp, run, cancel));
+  setTraceRing(nullptr);
+
+  const auto events = ring.getEvents();
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_STREQ(events[0].name, "plugin0");
+  EXPECT_EQ(events[0].flags, TraceEvent::outcome | TraceEvent::success);
+  // the failing plugin broke the group
+  EXPECT_STREQ(events[1].name, "plugin1");
+  EXPECT_EQ(events[1].flags, TraceEvent::outcome | TraceEvent::decisive);
+}
+
+TEST(RacePluginsTest, Selector) {
+  // the first plugin fails slowly, the second one succeeds fast.
+  FakeGroup grp;
+  ThreadPool pool(3);
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.add(false, true, false).duration = std::chrono::milliseconds(50);
+  grp.add(true, true, false);
+  auto& last = grp.add(true, true, false);
+  last.duration = std::chrono::seconds(10);
+
+  RaceState state;
+  size_t winner;
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(_racePlugins(grp, race, cancel, pool, state, winner));
+  const auto end = std::chrono::steady_clock::now();
+
+  // the second plugin wins and the last one gets cancelled
+  EXPECT_EQ(winner, 1);
+  EXPECT_TRUE(last.cancelled);
+  EXPECT_LT(end - start, std::chrono::seconds(5));
+}
+
+TEST(RacePluginsTest, Priority) {
+  // a slower plugin with a higher priority wins over a fast one
+  FakeGroup grp;
+  ThreadPool pool(2);
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.add(true, true, false).duration = std::chrono::milliseconds(20);
+  grp.add(true, true, false);
+
+  RaceState state;
+  size_t winner;
+  ASSERT_TRUE(_racePlugins(grp, race, cancel, pool, state, winner));
+  EXPECT_EQ(winner, 0);
+}
+
+TEST(RacePluginsTest, Failure) {
+  // nobody succeeds: we return the default value
+  FakeGroup grp;
+  ThreadPool pool(2);
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.add(false, true, false);
+  grp.add(false, true, false);
+
+  RaceState state;
+  size_t winner;
+  EXPECT_FALSE(_racePlugins(grp, race, cancel, pool, state, winner));
+  EXPECT_EQ(winner, 2);
+}
+
+TEST(RacePluginsTest, Cancel) {
+  FakeGroup grp;
+  ThreadPool pool(1);
+  std::atomic_bool cancel{true};
+  grp.add(true).duration = std::chrono::seconds(10);
+
+  RaceState state;
+  size_t winner;
+  EXPECT_FALSE(_racePlugins(grp, race, cancel, pool, state, winner));
+}
+
+TEST(RacePluginsTest, Lazy) {
+  // the lazy plugins are loaded before the race
+  FakeGroup grp;
+  ThreadPool pool(2);
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  grp.setLoader([](const PluginParameter&) {
+    return FakeGroup::PluginPtr(new FakePlugin,
+                                [](FakePlugin* _p) { delete _p; });
+  });
+  grp.add(false, true, false);
+  grp.addLazy(true);
+
+  RaceState state;
+  size_t winner;
+  EXPECT_TRUE(_racePlugins(grp, race, cancel, pool, state, winner));
+  EXPECT_EQ(winner, 1);
+}
+
+TEST(RacePluginsTest, OutOfTime) {
+  // the group's budget expires before the result is decided
+  FakeGroup grp;
+  ThreadPool pool(2);
+  std::atomic_bool cancel{false};
+  grp.setMaxDuration(0.01);
+  auto& slow = grp.add(true, true, false);
+  slow.duration = std::chrono::seconds(10);
+
+  RaceState state;
+  size_t winner;
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(_racePlugins(grp, race, cancel, pool, state, winner));
+  EXPECT_TRUE(slow.cancelled);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(RacePluginsTest, PluginOverrun) {
+  // the overrunning plugin is cancelled, the next one wins
+  FakeGroup grp;
+  ThreadPool pool(2);
+  std::atomic_bool cancel{false};
+  grp.setDefaultValue(false);
+  auto& slow = grp.add(true, true, false);
+  slow.duration = std::chrono::seconds(10);
+  grp.param(0).max_duration = 0.01;
+  grp.add(true, true, false);
+
+  RaceState state;
+  size_t winner;
+  EXPECT_TRUE(_racePlugins(grp, race, cancel, pool, state, winner));
+  EXPECT_TRUE(slow.cancelled);
+  EXPECT_EQ(winner, 1);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
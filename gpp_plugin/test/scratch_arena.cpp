@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_interface/scratch_interface.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace gpp_interface;
+
+TEST(ScratchArenaTest, Alignment) {
+  ScratchArena arena(128);
+  for (size_t alignment : {1, 2, 8, 16, 64}) {
+    // misalign the offset first
+    arena.allocate(1, 1);
+    const auto ptr = reinterpret_cast<uintptr_t>(arena.allocate(3, alignment));
+    EXPECT_EQ(ptr % alignment, 0);
+  }
+}
+
+TEST(ScratchArenaTest, Reset) {
+  // the memory is reused after the reset
+  ScratchArena arena(1024);
+  const auto first = arena.allocate<double>(10);
+  EXPECT_EQ(arena.used(), 10 * sizeof(double));
+  arena.reset(1024);
+  EXPECT_EQ(arena.used(), 0);
+  EXPECT_EQ(arena.allocate<double>(10), first);
+  EXPECT_EQ(arena.capacity(), 1024);
+}
+
+TEST(ScratchArenaTest, Merge) {
+  // a request exceeding the first block leaves one block after the reset
+  ScratchArena arena(64);
+  for (size_t ii = 0; ii != 10; ++ii)
+    arena.allocate(64);
+  const auto capacity = arena.capacity();
+  arena.reset(capacity);
+  ASSERT_EQ(arena.capacity(), capacity);
+
+  // the same request doesn't grow the arena anymore
+  for (size_t ii = 0; ii != 10; ++ii)
+    arena.allocate(64);
+  EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST(ScratchArenaTest, Keep) {
+  // the arena drops the memory exceeding the limit
+  ScratchArena arena(64);
+  arena.allocate(1000);
+  arena.reset(500);
+  EXPECT_EQ(arena.capacity(), 0);
+
+  // but works afterwards
+  EXPECT_NE(arena.allocate(10), nullptr);
+}
+
+TEST(ScratchAllocatorTest, Vector) {
+  ScratchArena arena;
+  ScratchAllocator<int> alloc(arena);
+  std::vector<int, ScratchAllocator<int>> values(alloc);
+  values.reserve(100);
+  for (int ii = 0; ii != 100; ++ii)
+    values.push_back(ii);
+
+  EXPECT_EQ(values.back(), 99);
+  EXPECT_EQ(arena.used(), 100 * sizeof(int));
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,431 @@
+// replays the planning requests and the costmaps recorded in a rosbag against
+// the GlobalPlannerPipeline. fails if the throughput, the p99 latency or the
+// peak memory regress against the baseline. run it with
+// rostest gpp_plugin soak.launch bag:=<bag> baseline:=<yaml>
+
+#include <gpp_plugin/gpp_plugin.hpp>
+#include <gpp_plugin/plugin_stats.hpp>
+#include <gtest/gtest.h>
+
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/PoseWithCovarianceStamped.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <mbf_msgs/GetPathActionGoal.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <tf2_ros/buffer.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using gpp_plugin::GlobalPlannerPipeline;
+using Pose = geometry_msgs::PoseStamped;
+using Path = std::vector<Pose>;
+using Clock = std::chrono::steady_clock;
+
+/// @brief a recorded costmap, converted back to costs
+struct Grid {
+  std::string frame;
+  unsigned int size_x = 0;
+  unsigned int size_y = 0;
+  double resolution = 0;
+  double origin_x = 0;
+  double origin_y = 0;
+  std::vector<unsigned char> costs;
+};
+
+struct Query {
+  Pose start;
+  Pose goal;
+  double tolerance = 0;
+};
+
+/// @brief a recorded message: either a costmap or a planning request
+struct Event {
+  double time = 0;  ///< seconds since the first message
+  int grid = -1;    ///< index of the costmap; -1 for a request
+  Query query;
+};
+
+struct Recording {
+  std::vector<Grid> grids;
+  std::vector<Event> events;
+  size_t queries = 0;
+};
+
+/// @brief the topics to read from the bag
+struct Topics {
+  std::string requests;
+  std::string costmap;
+  std::string robot_pose;
+};
+
+/// @brief inverse of the cost translation of the costmap_2d publisher
+unsigned char
+toCost(int8_t _value) noexcept {
+  if (_value < 0)
+    return costmap_2d::NO_INFORMATION;
+  if (_value == 0)
+    return costmap_2d::FREE_SPACE;
+  if (_value >= 100)
+    return costmap_2d::LETHAL_OBSTACLE;
+  if (_value == 99)
+    return costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+  return static_cast<unsigned char>(1 + (251 * (_value - 1)) / 97);
+}
+
+Grid
+toGrid(const nav_msgs::OccupancyGrid& _msg) {
+  Grid grid;
+  grid.frame = _msg.header.frame_id;
+  grid.size_x = _msg.info.width;
+  grid.size_y = _msg.info.height;
+  grid.resolution = _msg.info.resolution;
+  grid.origin_x = _msg.info.origin.position.x;
+  grid.origin_y = _msg.info.origin.position.y;
+  grid.costs.resize(_msg.data.size());
+  std::transform(_msg.data.begin(), _msg.data.end(), grid.costs.begin(),
+                 toCost);
+  return grid;
+}
+
+/// @brief reads the costmaps and the planning requests in the order of the bag
+Recording
+readBag(const std::string& _file, const Topics& _topics) {
+  rosbag::Bag bag(_file, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(std::vector<std::string>{
+                             _topics.requests, _topics.costmap,
+                             _topics.robot_pose}));
+
+  Recording recording;
+  ros::Time begin;
+  Pose robot_pose;
+  bool has_robot_pose = false;
+  for (const auto& msg : view) {
+    if (begin.isZero())
+      begin = msg.getTime();
+
+    Event event;
+    event.time = (msg.getTime() - begin).toSec();
+    if (msg.getTopic() == _topics.costmap) {
+      const auto grid = msg.instantiate<nav_msgs::OccupancyGrid>();
+      if (!grid)
+        continue;
+      event.grid = static_cast<int>(recording.grids.size());
+      recording.grids.emplace_back(toGrid(*grid));
+    }
+    else if (msg.getTopic() == _topics.robot_pose) {
+      // amcl publishes the pose with its covariance
+      const auto amcl =
+          msg.instantiate<geometry_msgs::PoseWithCovarianceStamped>();
+      const auto pose = msg.instantiate<Pose>();
+      if (amcl) {
+        robot_pose.header = amcl->header;
+        robot_pose.pose = amcl->pose.pose;
+      }
+      else if (pose)
+        robot_pose = *pose;
+      has_robot_pose = has_robot_pose || amcl || pose;
+      continue;
+    }
+    else {
+      // the requests of move_base_flex may define the start. the simple goals
+      // (e.x. from rviz) start at the robot
+      const auto request = msg.instantiate<mbf_msgs::GetPathActionGoal>();
+      const auto goal = msg.instantiate<Pose>();
+      if (request) {
+        const auto& get_path = request->goal;
+        if (!get_path.use_start_pose && !has_robot_pose)
+          continue;
+        event.query.start =
+            get_path.use_start_pose ? get_path.start_pose : robot_pose;
+        event.query.goal = get_path.target_pose;
+        event.query.tolerance = get_path.tolerance;
+      }
+      else if (goal && has_robot_pose) {
+        event.query.start = robot_pose;
+        event.query.goal = *goal;
+      }
+      else
+        continue;
+      ++recording.queries;
+    }
+    recording.events.emplace_back(std::move(event));
+  }
+  return recording;
+}
+
+/**
+ * @brief copies the _grid into the _map (resizes the _map if required)
+ *
+ * The copy holds the map's mutex, as the costmap's update thread does. The
+ * pipeline takes its snapshot and the revision under the same mutex, so a
+ * request sees either the old or the new grid (the mutex is recursive:
+ * resizeMap locks it again).
+ */
+void
+applyGrid(const Grid& _grid, costmap_2d::Costmap2D& _map) {
+  using mutex_t = costmap_2d::Costmap2D::mutex_t;
+  boost::unique_lock<mutex_t> lock(*_map.getMutex());
+  if (_map.getSizeInCellsX() != _grid.size_x ||
+      _map.getSizeInCellsY() != _grid.size_y ||
+      _map.getResolution() != _grid.resolution ||
+      _map.getOriginX() != _grid.origin_x ||
+      _map.getOriginY() != _grid.origin_y)
+    _map.resizeMap(_grid.size_x, _grid.size_y, _grid.resolution,
+                   _grid.origin_x, _grid.origin_y);
+  std::copy(_grid.costs.begin(), _grid.costs.end(), _map.getCharMap());
+}
+
+/// @brief bounded FIFO between the replay and the clients
+struct QueryQueue {
+  explicit QueryQueue(size_t _capacity) : capacity_(_capacity) {}
+
+  /// @brief blocks while the queue is full
+  void
+  push(const Query& _query) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return queue_.size() < capacity_; });
+    queue_.push_back(&_query);
+    cv_.notify_all();
+  }
+
+  /// @brief returns nullptr once the queue is closed and empty
+  const Query*
+  pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+    if (queue_.empty())
+      return nullptr;
+
+    const auto query = queue_.front();
+    queue_.pop_front();
+    cv_.notify_all();
+    return query;
+  }
+
+  void
+  close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+private:
+  const size_t capacity_;
+  std::deque<const Query*> queue_;
+  bool closed_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+struct ReplayParameter {
+  double rate = 1;         ///< speed-up of the bag time; zero for no delays
+  size_t concurrency = 1;  ///< number of concurrent clients
+  double duration = 0;     ///< minimum duration in seconds (loops the bag)
+};
+
+struct Result {
+  size_t requests = 0;
+  size_t successes = 0;
+  double seconds = 0;
+  gpp_plugin::LatencyHistogram latency;
+};
+
+Clock::duration
+toDuration(double _seconds) {
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(_seconds));
+}
+
+void
+runClient(GlobalPlannerPipeline& _pipeline, QueryQueue& _queue,
+          Result& _result) {
+  Path plan;
+  double cost;
+  std::string message;
+  while (const auto query = _queue.pop()) {
+    const auto begin = Clock::now();
+    const auto outcome = _pipeline.makePlan(
+        query->start, query->goal, query->tolerance, plan, cost, message);
+    _result.latency.record(Clock::now() - begin);
+    ++_result.requests;
+    _result.successes += outcome == 0;
+  }
+}
+
+/// @brief replays the _recording. the costmaps are applied in the order of
+/// the bag, while the clients plan - as the costmap update thread would
+Result
+replay(GlobalPlannerPipeline& _pipeline, costmap_2d::Costmap2D& _map,
+       const Recording& _recording, const ReplayParameter& _param) {
+  // if the pipeline cannot keep up, the replay falls behind the bag time
+  QueryQueue queue(_param.concurrency);
+  std::vector<Result> results(_param.concurrency);
+  std::vector<std::thread> clients;
+  for (auto& result : results)
+    clients.emplace_back(
+        [&_pipeline, &queue, &result] { runClient(_pipeline, queue, result); });
+
+  const auto begin = Clock::now();
+  const auto end = begin + toDuration(_param.duration);
+  do {
+    const auto pass = Clock::now();
+    for (const auto& event : _recording.events) {
+      if (_param.rate > 0)
+        std::this_thread::sleep_until(pass +
+                                      toDuration(event.time / _param.rate));
+
+      if (event.grid >= 0)
+        applyGrid(_recording.grids[event.grid], _map);
+      else
+        queue.push(event.query);
+    }
+  } while (Clock::now() < end);
+
+  queue.close();
+  for (auto& client : clients)
+    client.join();
+
+  Result total;
+  total.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+  for (const auto& result : results) {
+    total.requests += result.requests;
+    total.successes += result.successes;
+    total.latency.merge(result.latency);
+  }
+  return total;
+}
+
+/// @brief peak resident memory of the process in MB
+double
+peakRss() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // linux reports kilobytes
+  return usage.ru_maxrss / 1024.;
+}
+
+void
+printRow(const char* _metric, double _value, ros::NodeHandle& _nh,
+         const std::string& _key) {
+  double baseline;
+  if (_nh.getParam("baseline/" + _key, baseline))
+    std::printf("%-20s %12.3f %12.3f\n", _metric, _value, baseline);
+  else
+    std::printf("%-20s %12.3f %12s\n", _metric, _value, "-");
+}
+
+}  // namespace
+
+TEST(SoakTest, Replay) {
+  ros::NodeHandle nh("~");
+  Topics topics;
+  topics.requests =
+      nh.param("topics/requests", std::string("/move_base_flex/get_path/goal"));
+  topics.costmap = nh.param(
+      "topics/costmap", std::string("/move_base_flex/global_costmap/costmap"));
+  topics.robot_pose = nh.param("topics/robot_pose", std::string("/amcl_pose"));
+
+  const auto recording = readBag(nh.param("bag", std::string()), topics);
+  ASSERT_FALSE(recording.grids.empty()) << "no costmap in the bag";
+  ASSERT_NE(recording.queries, 0u) << "no planning request in the bag";
+
+  ReplayParameter param;
+  param.rate = std::max(nh.param("replay/rate", 1.), 0.);
+  param.concurrency =
+      static_cast<size_t>(std::max(nh.param("replay/concurrency", 1), 1));
+  param.duration = nh.param("replay/duration", 0.);
+
+  // the costmap without any layers: we fill it ourselves
+  const auto& first = recording.grids.front();
+  const auto frame = first.frame.empty() ? std::string("map") : first.frame;
+  nh.setParam("costmap/global_frame", frame);
+  nh.setParam("costmap/robot_base_frame", "base_link");
+  XmlRpc::XmlRpcValue no_plugins;
+  no_plugins.setSize(0);
+  nh.setParam("costmap/plugins", no_plugins);
+  nh.setParam("costmap/rolling_window", false);
+
+  // fake localization: the costmap waits for the robot's pose
+  tf2_ros::Buffer tf;
+  geometry_msgs::TransformStamped identity;
+  identity.header.frame_id = frame;
+  identity.child_frame_id = "base_link";
+  identity.transform.rotation.w = 1;
+  tf.setTransform(identity, "soak_test", true);
+
+  costmap_2d::Costmap2DROS costmap("costmap", tf);
+  costmap.pause();
+  applyGrid(first, *costmap.getCostmap());
+
+  // concurrent requests require workers (see the concurrent parameter)
+  if (param.concurrency > 1 && !nh.hasParam("pipeline/batch_workers")) {
+    nh.setParam("pipeline/batch_workers",
+                static_cast<int>(param.concurrency) - 1);
+    nh.setParam("pipeline/concurrent", true);
+  }
+
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("pipeline", &costmap);
+
+  const auto result = replay(pipeline, *costmap.getCostmap(), recording, param);
+  const auto throughput = result.requests / result.seconds;
+  const auto p99 = result.latency.percentile(0.99) * 1e3;
+  const auto rss = peakRss();
+
+  std::printf("%-20s %12s %12s\n", "metric", "measured", "baseline");
+  printRow("throughput [1/s]", throughput, nh, "throughput");
+  printRow("p99 [ms]", p99, nh, "p99_ms");
+  printRow("peak rss [MB]", rss, nh, "peak_rss_mb");
+  std::printf("%zu requests, %zu successful\n", result.requests,
+              result.successes);
+
+  // store the measurement as the new baseline
+  const auto file = nh.param("baseline_file", std::string());
+  if (!file.empty()) {
+    std::ofstream os(file);
+    os << "throughput: " << throughput << "\np99_ms: " << p99
+       << "\npeak_rss_mb: " << rss << "\n";
+    EXPECT_TRUE(os.good()) << "cannot write " << file;
+  }
+
+  // the latency histogram has a resolution of 25%: the p99 tolerance should
+  // not be tighter
+  double baseline;
+  if (nh.getParam("baseline/throughput", baseline)) {
+    EXPECT_GE(throughput,
+              baseline * (1 - nh.param("tolerance/throughput", 0.1)))
+        << "the throughput regressed";
+  }
+  if (nh.getParam("baseline/p99_ms", baseline)) {
+    EXPECT_LE(p99, baseline * (1 + nh.param("tolerance/p99", 0.3)))
+        << "the p99 latency regressed";
+  }
+  if (nh.getParam("baseline/peak_rss_mb", baseline)) {
+    EXPECT_LE(rss, baseline * (1 + nh.param("tolerance/peak_rss", 0.1)))
+        << "the peak memory regressed";
+  }
+}
+
+int
+main(int argc, char** argv) {
+  ros::init(argc, argv, "soak_test");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
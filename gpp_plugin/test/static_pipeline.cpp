@@ -0,0 +1,186 @@
+#include <gpp_plugin/static_pipeline.hpp>
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+
+namespace {
+
+using Pose = geometry_msgs::PoseStamped;
+using Path = std::vector<Pose>;
+using Map = costmap_2d::Costmap2DROS;
+
+// counts the calls of every fake plugin
+struct Counter {
+  size_t calls = 0;
+};
+
+// planner with the CostmapPlanner interface. appends one pose to the plan and
+// fails with the _Outcome
+template <bool _Result, uint32_t _Outcome = 50>
+struct FakeCostmapPlanner : public mbf_costmap_core::CostmapPlanner,
+                            public Counter {
+  uint32_t
+  makePlan(const Pose& _start, const Pose&, double, Path& _plan, double& _cost,
+           std::string&) override {
+    ++calls;
+    _plan.push_back(_start);
+    _cost = 1;
+    return _Result ? 0 : _Outcome;
+  }
+
+  bool
+  cancel() override {
+    return cancelled = true;
+  }
+
+  void
+  initialize(std::string, Map*) override {}
+
+  bool cancelled = false;
+};
+
+// planner with the BaseGlobalPlanner interface. implements only the overload
+// without the cost
+struct FakeGlobalPlanner : public nav_core::BaseGlobalPlanner, public Counter {
+  bool
+  makePlan(const Pose& _start, const Pose& _goal, Path& _plan) override {
+    ++calls;
+    _plan = {_start, _goal};
+    return true;
+  }
+
+  void
+  initialize(std::string, Map*) override {}
+};
+
+// doubles the cost
+struct FakePostPlanning : public gpp_interface::PostPlanningInterface,
+                          public Counter {
+  bool
+  postProcess(Path& _path, double& _cost) override {
+    ++calls;
+    _cost *= 2;
+    return !_path.empty();
+  }
+
+  void
+  initialize(const std::string&, Map*) override {}
+};
+
+// shifts the path along the x-axis
+struct FakeCompactPostPlanning
+    : public gpp_interface::CompactPostPlanningInterface,
+      public Counter {
+  bool
+  postProcess(Path& _path, double&) override {
+    ++calls;
+    for (auto& x : _path.x)
+      x += 1;
+    return true;
+  }
+
+  void
+  initialize(const std::string&, Map*) override {}
+};
+
+}  // namespace
+
+TEST(StaticGroupTest, Default) {
+  // the default value is returned, if no break condition triggers
+  StaticGroup<> empty;
+  auto func = [](auto&) { return false; };
+  std::atomic_bool cancel{false};
+  EXPECT_TRUE(_runStaticPlugins(empty, func, cancel));
+
+  empty.default_value = false;
+  EXPECT_FALSE(_runStaticPlugins(empty, func, cancel));
+}
+
+TEST(StaticGroupTest, Break) {
+  StaticGroup<Counter, Counter, Counter> grp;
+  std::array<bool, 3> results{true, false, true};
+  size_t ii = 0;
+  auto func = [&](Counter& _c) {
+    ++_c.calls;
+    return results[ii++];
+  };
+  std::atomic_bool cancel{false};
+
+  // the second plugin fails and breaks the execution
+  grp.params[1].on_failure_break = true;
+  EXPECT_FALSE(_runStaticPlugins(grp, func, cancel));
+  EXPECT_EQ(std::get<2>(grp.plugins).calls, 0);
+
+  // the failure is ignored
+  ii = 0;
+  grp.params[1].on_failure_break = false;
+  EXPECT_TRUE(_runStaticPlugins(grp, func, cancel));
+  EXPECT_EQ(std::get<2>(grp.plugins).calls, 1);
+
+  // the first plugin succeeds and breaks the execution
+  ii = 0;
+  grp.params[0].on_success_break = true;
+  EXPECT_TRUE(_runStaticPlugins(grp, func, cancel));
+  EXPECT_EQ(std::get<0>(grp.plugins).calls, 3);
+  EXPECT_EQ(std::get<1>(grp.plugins).calls, 2);
+
+  // nothing runs after a cancel
+  cancel = true;
+  EXPECT_FALSE(_runStaticPlugins(grp, func, cancel));
+  EXPECT_EQ(std::get<0>(grp.plugins).calls, 3);
+}
+
+TEST(StaticPipelineTest, MakePlan) {
+  using Pipeline = StaticPipeline<
+      StaticGroup<>,
+      StaticGroup<FakeCostmapPlanner<false>, FakeGlobalPlanner>,
+      StaticGroup<FakeCompactPostPlanning, FakePostPlanning>>;
+  Pipeline pipeline;
+
+  // the failing planner falls back to the BaseGlobalPlanner
+  pipeline.getPlanning().params[0].on_failure_break = false;
+  pipeline.getPlanning().params[1].on_success_break = true;
+
+  Pose start, goal;
+  start.header.frame_id = goal.header.frame_id = "map";
+  goal.pose.position.x = 2;
+  goal.pose.orientation.w = start.pose.orientation.w = 1;
+  Path plan;
+  double cost = 0;
+  std::string message;
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+
+  // the plan is converted back from the compact representation
+  ASSERT_EQ(plan.size(), 2);
+  EXPECT_EQ(plan.front().pose.position.x, 1);
+  EXPECT_EQ(plan.back().pose.position.x, 3);
+  EXPECT_EQ(plan.back().header.frame_id, "map");
+  EXPECT_EQ(std::get<1>(pipeline.getPlanning().plugins).calls, 1);
+  EXPECT_EQ(std::get<1>(pipeline.getPostPlanning().plugins).calls, 1);
+}
+
+TEST(StaticPipelineTest, Failure) {
+  // the planner fails with NO_PATH_FOUND
+  using Pipeline =
+      StaticPipeline<StaticGroup<>, StaticGroup<FakeCostmapPlanner<false, 56>>,
+                     StaticGroup<FakePostPlanning>>;
+  Pipeline pipeline;
+  pipeline.getPlanning().params[0].on_failure_break = true;
+
+  Pose start, goal;
+  Path plan;
+  double cost;
+  std::string message;
+  EXPECT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 56);
+  EXPECT_EQ(std::get<0>(pipeline.getPostPlanning().plugins).calls, 0);
+
+  // the cancel request is forwarded to the planner
+  EXPECT_TRUE(pipeline.cancel());
+  EXPECT_TRUE(std::get<0>(pipeline.getPlanning().plugins).cancelled);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// helpers for the tests running the GlobalPlannerPipeline with the plugins of
+// test_plugins.cpp. the TestCostmap and the parameters require a running
+// master (see the rostest launch files) - makePose does not.
+
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <ros/ros.h>
+#include <tf2_ros/buffer.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gpp_plugin {
+namespace test {
+
+/// @brief costmap without any layers: the tests fill it themselves
+struct TestCostmap {
+  /**
+   * @param _name the namespace of the costmap (under the private namespace)
+   * @param _size the size of the square map in meters
+   * @param _resolution the resolution of the map
+   */
+  explicit TestCostmap(const std::string& _name = "costmap", int _size = 10,
+                       double _resolution = 0.1) {
+    ros::NodeHandle nh("~");
+    nh.setParam(_name + "/global_frame", "map");
+    nh.setParam(_name + "/robot_base_frame", "base_link");
+    XmlRpc::XmlRpcValue no_plugins;
+    no_plugins.setSize(0);
+    nh.setParam(_name + "/plugins", no_plugins);
+    nh.setParam(_name + "/rolling_window", false);
+    nh.setParam(_name + "/width", _size);
+    nh.setParam(_name + "/height", _size);
+    nh.setParam(_name + "/resolution", _resolution);
+
+    // fake localization: the costmap waits for the robot's pose
+    geometry_msgs::TransformStamped identity;
+    identity.header.frame_id = "map";
+    identity.child_frame_id = "base_link";
+    identity.transform.rotation.w = 1;
+    tf.setTransform(identity, "test", true);
+
+    costmap.reset(new costmap_2d::Costmap2DROS(_name, tf));
+    costmap->pause();
+  }
+
+  tf2_ros::Buffer tf;
+  std::unique_ptr<costmap_2d::Costmap2DROS> costmap;
+};
+
+/// @brief a plugin of a group: its name and type - and optionally its flags
+using TestPlugin = std::pair<std::string, std::string>;
+
+/**
+ * @brief defines the plugin array _group of the pipeline _name
+ *
+ * @param _flags the tags, which every plugin of the group receives (e.x.
+ * on_success_break)
+ */
+inline void
+setPlugins(const std::string& _name, const std::string& _group,
+           const std::vector<TestPlugin>& _plugins,
+           const std::vector<std::pair<std::string, bool>>& _flags = {}) {
+  XmlRpc::XmlRpcValue array;
+  array.setSize(_plugins.size());
+  for (size_t ii = 0; ii != _plugins.size(); ++ii) {
+    array[ii]["name"] = _plugins[ii].first;
+    array[ii]["type"] = _plugins[ii].second;
+    for (const auto& flag : _flags)
+      array[ii][flag.first] = flag.second;
+  }
+  ros::NodeHandle("~" + _name).setParam(_group, array);
+}
+
+/// @brief returns _size plugins of the _type (named <_prefix><index>)
+inline std::vector<TestPlugin>
+makePlugins(const std::string& _prefix, const std::string& _type,
+            size_t _size) {
+  std::vector<TestPlugin> plugins;
+  for (size_t ii = 0; ii != _size; ++ii)
+    plugins.emplace_back(_prefix + std::to_string(ii), _type);
+  return plugins;
+}
+
+/// @brief returns a pose in the map frame
+inline geometry_msgs::PoseStamped
+makePose(double _x, double _y) {
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = _x;
+  pose.pose.position.y = _y;
+  pose.pose.orientation.w = 1;
+  return pose;
+}
+
+}  // namespace test
+}  // namespace gpp_plugin
@@ -0,0 +1,419 @@
+// plugins for the tests of the GlobalPlannerPipeline. see test_plugins.xml
+
+#include <gpp_interface/costmap_snapshot_interface.hpp>
+#include <gpp_interface/distance_field_interface.hpp>
+#include <gpp_interface/outcome_interface.hpp>
+#include <gpp_interface/path_seed_interface.hpp>
+#include <gpp_interface/path_stream_interface.hpp>
+#include <gpp_interface/post_planning_interface.hpp>
+#include <gpp_interface/pre_planning_interface.hpp>
+
+#include <mbf_costmap_core/costmap_planner.h>
+#include <pluginlib/class_list_macros.hpp>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gpp_plugin {
+namespace test {
+
+using Pose = geometry_msgs::PoseStamped;
+using Path = std::vector<Pose>;
+using Map = costmap_2d::Costmap2DROS;
+
+// the no-op plugins: they don't touch the map and succeed always
+
+struct NoOpPrePlanning : public gpp_interface::PrePlanningInterface {
+  bool
+  preProcess(Pose&, Pose&, Map&, double) override {
+    return true;
+  }
+
+  void
+  initialize(const std::string&) override {}
+};
+
+// writes the parameter 'cost' into the goal's cell of the live map
+struct MarkPrePlanning : public gpp_interface::PrePlanningInterface {
+  bool
+  preProcess(Pose&, Pose& _goal, Map& _map, double) override {
+    auto costmap = _map.getCostmap();
+    using mutex_t = costmap_2d::Costmap2D::mutex_t;
+    boost::unique_lock<mutex_t> lock(*costmap->getMutex());
+    unsigned int mx, my;
+    const auto& g = _goal.pose.position;
+    if (!costmap->worldToMap(g.x, g.y, mx, my))
+      return false;
+    costmap->setCost(mx, my, cost_);
+    return true;
+  }
+
+  void
+  initialize(const std::string& _name) override {
+    ros::NodeHandle nh("~" + _name);
+    cost_ = static_cast<unsigned char>(nh.param("cost", 0));
+  }
+
+private:
+  unsigned char cost_ = 0;
+};
+
+// fails, if the parameter 'outcome' is set (read on every call) and reports
+// it as its outcome with the message 'rejected'
+struct OutcomePrePlanning : public gpp_interface::PrePlanningInterface,
+                            public gpp_interface::OutcomeInterface {
+  bool
+  preProcess(Pose&, Pose&, Map&, double) override {
+    outcome_ = nh_.param("outcome", 0);
+    return outcome_ == 0;
+  }
+
+  void
+  initialize(const std::string& _name) override {
+    nh_ = ros::NodeHandle("~" + _name);
+  }
+
+  uint32_t
+  getOutcome(std::string& _message) override {
+    _message = "rejected";
+    return outcome_;
+  }
+
+private:
+  ros::NodeHandle nh_;
+  int outcome_ = 0;
+};
+
+struct NoOpPlanning : public mbf_costmap_core::CostmapPlanner {
+  uint32_t
+  makePlan(const Pose&, const Pose&, double, Path&, double&,
+           std::string&) override {
+    return 0;
+  }
+
+  bool
+  cancel() override {
+    return false;
+  }
+
+  void
+  initialize(std::string, Map*) override {}
+};
+
+// plans a straight line from the start to the goal. the poses are one cell
+// apart, the cost is the length of the line
+struct StraightPlanning : public mbf_costmap_core::CostmapPlanner {
+  uint32_t
+  makePlan(const Pose& _start, const Pose& _goal, double, Path& _plan,
+           double& _cost, std::string&) override {
+    const auto& s = _start.pose.position;
+    const auto& g = _goal.pose.position;
+    _cost = std::hypot(g.x - s.x, g.y - s.y);
+    const auto resolution = map_->getCostmap()->getResolution();
+    const size_t steps = std::max(1., std::ceil(_cost / resolution));
+    _plan.resize(steps + 1, _goal);
+    for (size_t ii = 0; ii != steps; ++ii) {
+      _plan[ii] = _start;
+      _plan[ii].pose.position.x += (g.x - s.x) * ii / steps;
+      _plan[ii].pose.position.y += (g.y - s.y) * ii / steps;
+    }
+    return 0;
+  }
+
+  bool
+  cancel() override {
+    return false;
+  }
+
+  void
+  initialize(std::string, Map* _map) override {
+    map_ = _map;
+  }
+
+private:
+  Map* map_ = nullptr;
+};
+
+// publishes the tolerance of the request as the parameter 'tolerance' and
+// returns the parameter 'outcome' (read on every call) with the message
+// 'planned'. the plan consists of the start and the goal
+struct OutcomePlanning : public mbf_costmap_core::CostmapPlanner {
+  uint32_t
+  makePlan(const Pose& _start, const Pose& _goal, double _tolerance,
+           Path& _plan, double& _cost, std::string& _message) override {
+    nh_.setParam("tolerance", _tolerance);
+    _message = "planned";
+    _cost = 0;
+    _plan = {_start, _goal};
+    return static_cast<uint32_t>(nh_.param("outcome", 0));
+  }
+
+  bool
+  cancel() override {
+    return false;
+  }
+
+  void
+  initialize(std::string _name, Map*) override {
+    nh_ = ros::NodeHandle("~" + _name);
+  }
+
+private:
+  ros::NodeHandle nh_;
+};
+
+// waits for the parameter 'delay' (in seconds), then returns the distance
+// field's value at the start as cost. the plan consists of the start and the
+// goal, the start is streamed as prefix. reads the snapshot and can be
+// cancelled while waiting
+struct FieldPlanning : public mbf_costmap_core::CostmapPlanner,
+                       public gpp_interface::CostmapSnapshotInterface,
+                       public gpp_interface::DistanceFieldInterface,
+                       public gpp_interface::PathStreamInterface {
+  uint32_t
+  makePlan(const Pose& _start, const Pose& _goal, double, Path& _plan,
+           double& _cost, std::string& _message) override {
+    cancelled_ = false;
+    const auto end = std::chrono::steady_clock::now() + delay_;
+    while (std::chrono::steady_clock::now() < end) {
+      if (cancelled_) {
+        _message = "cancelled";
+        return 51;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // the field is requested after the delay: the map of the next request
+    // may differ meanwhile
+    unsigned int mx, my;
+    const auto& s = _start.pose.position;
+    if (!snapshot_ || !snapshot_->worldToMap(s.x, s.y, mx, my))
+      return 50;
+    const auto field = provider_->getDistanceField(_goal);
+    _cost = field->getDistance(mx, my);
+    _plan = {_start, _goal};
+    if (sink_)
+      sink_->onPrefix({_start});
+    return 0;
+  }
+
+  bool
+  cancel() override {
+    cancelled_ = true;
+    return true;
+  }
+
+  void
+  initialize(std::string _name, Map*) override {
+    ros::NodeHandle nh("~" + _name);
+    delay_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(nh.param("delay", 0.)));
+  }
+
+  void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) override {
+    snapshot_ = &_snapshot;
+  }
+
+  void
+  setDistanceFieldProvider(
+      gpp_interface::DistanceFieldProvider& _provider) override {
+    provider_ = &_provider;
+  }
+
+  void
+  setPrefixSink(gpp_interface::PathPrefixSink* _sink) override {
+    sink_ = _sink;
+  }
+
+private:
+  std::chrono::steady_clock::duration delay_{};
+  std::atomic_bool cancelled_{false};
+  const costmap_2d::Costmap2D* snapshot_ = nullptr;
+  gpp_interface::DistanceFieldProvider* provider_ = nullptr;
+  gpp_interface::PathPrefixSink* sink_ = nullptr;
+};
+
+// reads the snapshot and fails, if its width is below the parameter 'size'
+// (in cells). publishes the width of the last snapshot as the parameter
+// 'seen' and its cost at the goal as 'goal'. the plan consists of the start
+// and the goal
+struct SizedPlanning : public mbf_costmap_core::CostmapPlanner,
+                       public gpp_interface::CostmapSnapshotInterface {
+  uint32_t
+  makePlan(const Pose& _start, const Pose& _goal, double, Path& _plan,
+           double& _cost, std::string&) override {
+    if (!snapshot_)
+      return 50;
+    const auto seen = static_cast<int>(snapshot_->getSizeInCellsX());
+    nh_.setParam("seen", seen);
+    unsigned int mx, my;
+    const auto& g = _goal.pose.position;
+    if (snapshot_->worldToMap(g.x, g.y, mx, my))
+      nh_.setParam("goal", static_cast<int>(snapshot_->getCost(mx, my)));
+    if (seen < size_)
+      return 50;
+    _cost = 0;
+    _plan = {_start, _goal};
+    return 0;
+  }
+
+  bool
+  cancel() override {
+    return false;
+  }
+
+  void
+  initialize(std::string _name, Map*) override {
+    nh_ = ros::NodeHandle("~" + _name);
+    size_ = nh_.param("size", 0);
+  }
+
+  void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) override {
+    snapshot_ = &_snapshot;
+  }
+
+private:
+  ros::NodeHandle nh_;
+  int size_ = 0;
+  const costmap_2d::Costmap2D* snapshot_ = nullptr;
+};
+
+// refines the path of the preceding planner: returns the seed as its plan
+// (fails without one). publishes the size of the seed as the parameter 'seed'
+// and the width of its snapshot as 'seen'
+struct SeedPlanning : public mbf_costmap_core::CostmapPlanner,
+                      public gpp_interface::CostmapSnapshotInterface,
+                      public gpp_interface::PathSeedInterface {
+  uint32_t
+  makePlan(const Pose&, const Pose&, double, Path& _plan, double& _cost,
+           std::string&) override {
+    nh_.setParam("seed", static_cast<int>(seed_->size()));
+    if (snapshot_)
+      nh_.setParam("seen", static_cast<int>(snapshot_->getSizeInCellsX()));
+    if (seed_->empty())
+      return 50;
+    _plan = *seed_;
+    _cost = seed_cost_;
+    return 0;
+  }
+
+  bool
+  cancel() override {
+    return false;
+  }
+
+  void
+  initialize(std::string _name, Map*) override {
+    nh_ = ros::NodeHandle("~" + _name);
+  }
+
+  void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) override {
+    snapshot_ = &_snapshot;
+  }
+
+  void
+  setSeed(const Path& _seed, double _cost) override {
+    seed_ = &_seed;
+    seed_cost_ = _cost;
+  }
+
+private:
+  ros::NodeHandle nh_;
+  const costmap_2d::Costmap2D* snapshot_ = nullptr;
+  const Path* seed_ = nullptr;
+  double seed_cost_ = 0;
+};
+
+// reads the snapshot and publishes its width as the parameter 'seen'
+struct SizedPostPlanning : public gpp_interface::PostPlanningInterface,
+                           public gpp_interface::CostmapSnapshotInterface {
+  bool
+  postProcess(Path&, double&) override {
+    if (!snapshot_)
+      return false;
+    nh_.setParam("seen", static_cast<int>(snapshot_->getSizeInCellsX()));
+    return true;
+  }
+
+  void
+  initialize(const std::string& _name, Map*) override {
+    nh_ = ros::NodeHandle("~" + _name);
+  }
+
+  void
+  setSnapshot(const costmap_2d::Costmap2D& _snapshot) override {
+    snapshot_ = &_snapshot;
+  }
+
+private:
+  ros::NodeHandle nh_;
+  const costmap_2d::Costmap2D* snapshot_ = nullptr;
+};
+
+// validation: rejects paths with a cost above the parameter 'max_cost'.
+// publishes the number of its calls as the parameter 'calls'
+struct LimitPostPlanning : public gpp_interface::PostPlanningInterface {
+  bool
+  postProcess(Path&, double& _cost) override {
+    nh_.setParam("calls", ++calls_);
+    return _cost <= max_cost_;
+  }
+
+  void
+  initialize(const std::string& _name, Map*) override {
+    nh_ = ros::NodeHandle("~" + _name);
+    max_cost_ = nh_.param("max_cost", 0.);
+  }
+
+private:
+  ros::NodeHandle nh_;
+  double max_cost_ = 0;
+  std::atomic_int calls_{0};
+};
+
+struct NoOpPostPlanning : public gpp_interface::PostPlanningInterface {
+  bool
+  postProcess(Path&, double&) override {
+    return true;
+  }
+
+  void
+  initialize(const std::string&, Map*) override {}
+};
+
+}  // namespace test
+}  // namespace gpp_plugin
+
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::NoOpPrePlanning,
+                       gpp_interface::PrePlanningInterface);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::MarkPrePlanning,
+                       gpp_interface::PrePlanningInterface);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::OutcomePrePlanning,
+                       gpp_interface::PrePlanningInterface);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::NoOpPlanning,
+                       mbf_costmap_core::CostmapPlanner);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::StraightPlanning,
+                       mbf_costmap_core::CostmapPlanner);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::OutcomePlanning,
+                       mbf_costmap_core::CostmapPlanner);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::FieldPlanning,
+                       mbf_costmap_core::CostmapPlanner);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::SizedPlanning,
+                       mbf_costmap_core::CostmapPlanner);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::SeedPlanning,
+                       mbf_costmap_core::CostmapPlanner);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::SizedPostPlanning,
+                       gpp_interface::PostPlanningInterface);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::LimitPostPlanning,
+                       gpp_interface::PostPlanningInterface);
+PLUGINLIB_EXPORT_CLASS(gpp_plugin::test::NoOpPostPlanning,
+                       gpp_interface::PostPlanningInterface);
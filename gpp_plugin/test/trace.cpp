@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Dima Dorezyuk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gpp_plugin/trace.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gpp_plugin;
+
+namespace {
+
+const auto now = TraceRing::Clock::now;
+
+}  // namespace
+
+TEST(TraceRingTest, Capacity) {
+  // rounded up to the next power of two
+  EXPECT_EQ(TraceRing(0).capacity(), 1);
+  EXPECT_EQ(TraceRing(5).capacity(), 8);
+  EXPECT_EQ(TraceRing(8).capacity(), 8);
+}
+
+TEST(TraceRingTest, Record) {
+  TraceRing ring(4);
+  EXPECT_TRUE(ring.getEvents().empty());
+
+  setTraceRequest(42);
+  const auto begin = now();
+  ring.record("planning", "planner", begin, begin + std::chrono::seconds(1),
+              TraceEvent::outcome | TraceEvent::success);
+  setTraceRequest(0);
+
+  const auto events = ring.getEvents();
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_STREQ(events[0].category, "planning");
+  EXPECT_STREQ(events[0].name, "planner");
+  EXPECT_EQ(events[0].duration, 1000000000);
+  EXPECT_EQ(events[0].request, 42);
+  EXPECT_EQ(events[0].flags, TraceEvent::outcome | TraceEvent::success);
+}
+
+TEST(TraceRingTest, Overwrite) {
+  // the ring keeps the newest events
+  TraceRing ring(4);
+  const auto begin = now();
+  for (int ii = 0; ii != 10; ++ii)
+    ring.record("test", std::to_string(ii).c_str(), begin, begin);
+
+  const auto events = ring.getEvents();
+  ASSERT_EQ(events.size(), 4);
+  EXPECT_STREQ(events.front().name, "6");
+  EXPECT_STREQ(events.back().name, "9");
+}
+
+TEST(TraceRingTest, Truncate) {
+  TraceRing ring(1);
+  const std::string name(100, 'a');
+  ring.record(name.c_str(), name.c_str(), now(), now());
+
+  const auto events = ring.getEvents();
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(std::string(events[0].name).size(), TraceEvent::name_size - 1);
+  EXPECT_EQ(std::string(events[0].category).size(),
+            TraceEvent::category_size - 1);
+}
+
+TEST(TraceRingTest, Concurrent) {
+  // every thread writes its own events
+  TraceRing ring(1024);
+  std::vector<std::thread> threads;
+  for (size_t ii = 0; ii != 4; ++ii)
+    threads.emplace_back([&]() {
+      for (size_t jj = 0; jj != 100; ++jj)
+        ring.record("test", "span", now(), now());
+    });
+
+  // reading while writing is fine
+  ring.getEvents();
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(ring.getEvents().size(), 400);
+}
+
+TEST(TraceRingTest, Dump) {
+  TraceRing ring(4);
+  const auto begin = now();
+  ring.record("planning", "my \"planner\"", begin,
+              begin + std::chrono::milliseconds(2), TraceEvent::outcome);
+
+  std::ostringstream os;
+  ring.dump(os);
+  const auto json = os.str();
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"my \\\"planner\\\"\""), std::string::npos);
+  EXPECT_NE(json.find("\"dur\":2000.000"), std::string::npos);
+  EXPECT_NE(json.find("\"success\":false"), std::string::npos);
+}
+
+TEST(TraceSpanTest, Disabled) {
+  // without a ring nothing is recorded
+  setTraceRing(nullptr);
+  TraceSpan span("test", "span");
+  span.finish();
+  EXPECT_EQ(span.getSeconds(), 0);
+}
+
+TEST(TraceSpanTest, Enabled) {
+  TraceRing ring(4);
+  setTraceRing(&ring);
+  {
+    TraceSpan span("test", "span");
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    span.finish();
+    EXPECT_GT(span.getSeconds(), 0);
+  }
+  setTraceRing(nullptr);
+
+  // the destructor does not record again
+  EXPECT_EQ(ring.getEvents().size(), 1);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,52 @@
+#include <gpp_plugin/watchdog.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace gpp_plugin;
+
+TEST(WatchdogTest, Fires) {
+  Watchdog watchdog;
+  std::atomic_bool fired{false};
+  watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(5),
+               [&]() { fired = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(watchdog.disarm());
+  EXPECT_TRUE(fired);
+}
+
+TEST(WatchdogTest, Disarm) {
+  // disarming before the deadline suppresses the callback
+  Watchdog watchdog;
+  std::atomic_bool fired{false};
+  watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(20),
+               [&]() { fired = true; });
+  EXPECT_FALSE(watchdog.disarm());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(fired);
+}
+
+TEST(WatchdogTest, Rearm) {
+  // the new deadline replaces the old one
+  Watchdog watchdog;
+  std::atomic_int first{0}, second{0};
+  watchdog.arm(Watchdog::Clock::now() + std::chrono::seconds(10),
+               [&]() { ++first; });
+  watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(5),
+               [&]() { ++second; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(watchdog.disarm());
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(second, 1);
+}
+
+int
+main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
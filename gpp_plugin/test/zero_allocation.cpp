@@ -0,0 +1,93 @@
+#include "allocation_counter.hpp"
+#include "test_pipeline.hpp"
+
+#include <gpp_interface/scratch_interface.hpp>
+#include <gpp_plugin/gpp_plugin.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace gpp_plugin;
+using namespace gpp_plugin::test;
+
+TEST(ZeroAllocationTest, MakePlan) {
+  // the GlobalPlannerPipeline with no-op plugins must not allocate any memory
+  setPlugins("noop", "pre_planning",
+             makePlugins("pre_", "gpp_plugin::test::NoOpPrePlanning", 8));
+  setPlugins("noop", "planning",
+             makePlugins("planning_", "gpp_plugin::test::NoOpPlanning", 8));
+  setPlugins("noop", "post_planning",
+             makePlugins("post_", "gpp_plugin::test::NoOpPostPlanning", 8));
+
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("noop", map.costmap.get());
+  ASSERT_EQ(pipeline.getStats().size(), 24u);
+
+  const auto start = makePose(1, 1);
+  const auto goal = makePose(8, 8);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  double cost;
+  std::string message;
+
+  // warm-up: the statistics and the buffers are allocated with the first call
+  ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+
+  const size_t before = allocations();
+  for (size_t ii = 0; ii != 100; ++ii)
+    ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+  EXPECT_EQ(allocations() - before, 0u);
+
+  // every plugin ran
+  for (const auto& entry : pipeline.getStats())
+    EXPECT_EQ(entry.second.calls, 101u) << entry.first;
+}
+
+TEST(ZeroAllocationTest, Race) {
+  // the racing planners are posted to the pool without allocating
+  ros::NodeHandle("~race").setParam("planning_mode", "race");
+  setPlugins("race", "planning",
+             makePlugins("race_", "gpp_plugin::test::NoOpPlanning", 4));
+
+  TestCostmap map;
+  GlobalPlannerPipeline pipeline;
+  pipeline.initialize("race", map.costmap.get());
+
+  const auto start = makePose(1, 1);
+  const auto goal = makePose(8, 8);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  double cost;
+  std::string message;
+
+  // warm-up: the queue of the pool reaches its capacity
+  for (size_t ii = 0; ii != 10; ++ii)
+    ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+
+  const size_t before = allocations();
+  for (size_t ii = 0; ii != 100; ++ii)
+    ASSERT_EQ(pipeline.makePlan(start, goal, 0.1, plan, cost, message), 0);
+  EXPECT_EQ(allocations() - before, 0u);
+}
+
+TEST(ZeroAllocationTest, ScratchArena) {
+  // the arena doesn't allocate, once it has seen the largest request
+  gpp_interface::ScratchArena arena(256);
+  for (size_t ii = 0; ii != 10; ++ii)
+    arena.allocate<double>(100);
+  arena.reset(1000000);
+
+  const size_t before = allocations();
+  for (size_t ii = 0; ii != 100; ++ii) {
+    for (size_t jj = 0; jj != 10; ++jj)
+      arena.allocate<double>(100);
+    arena.reset(1000000);
+  }
+  EXPECT_EQ(allocations() - before, 0u);
+}
+
+int
+main(int argc, char** argv) {
+  ros::init(argc, argv, "zero_allocation");
+  ros::NodeHandle nh;
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}